@@ -1,11 +1,12 @@
 TEMPLATE = app
 TARGET = Mario
 
-# C++11
-CONFIG += c++11
+# C++11, with std::thread support
+CONFIG += c++11 thread
 
 # Input
 HEADERS += source/Animation.hpp \
+           source/AtlasPacker.hpp \
            source/Background.hpp \
            source/Beetle.hpp \
            source/BitmapFont.hpp \
@@ -55,6 +56,7 @@ HEADERS += source/Animation.hpp \
            source/Math.hpp \
            source/Mushroom.hpp \
            source/Music.hpp \
+           source/ObjectPool.hpp \
            source/NoiseSource.hpp \
            source/Paratroopa.hpp \
            source/Particle.hpp \
@@ -64,20 +66,30 @@ HEADERS += source/Animation.hpp \
            source/Player.hpp \
            source/Random.hpp \
            source/Rendering.hpp \
+           source/RenderSnapshot.hpp \
+           source/RenderThread.hpp \
+           source/Replay.hpp \
            source/ReserveItem.hpp \
+           source/ResourceId.hpp \
            source/ResourceManager.hpp \
+           source/ResourcePack.hpp \
            source/Settings.hpp \
            source/Shell.hpp \
            source/Singleton.hpp \
+           source/SoftwareRenderer.hpp \
            source/Sound.hpp \
            source/Spiny.hpp \
            source/Sprite.hpp \
+           source/SpriteBatch.hpp \
            source/Star.hpp \
            source/StringSwitch.hpp \
            source/Text.hpp \
+           source/TextMeshCache.hpp \
            source/TextParticle.hpp \
+           source/ThreadPool.hpp \
            source/Texture.hpp \
            source/Tile.hpp \
+           source/TileMap.hpp \
            source/TransitionState.hpp \
            source/Types.hpp \
            source/Vector2.hpp \
@@ -88,6 +100,7 @@ HEADERS += source/Animation.hpp \
            source/LevelGenerators/SmbLevelLoader.hpp \
            source/LevelGenerators/TestLevelGenerator.hpp
 SOURCES += source/Animation.cpp \
+           source/AtlasPacker.cpp \
            source/Background.cpp \
            source/Beetle.cpp \
            source/BitmapFont.cpp \
@@ -136,6 +149,7 @@ SOURCES += source/Animation.cpp \
            source/Math.cpp \
            source/Mushroom.cpp \
            source/Music.cpp \
+           source/ObjectPool.cpp \
            source/Paratroopa.cpp \
            source/Particle.cpp \
            source/Pipe.cpp \
@@ -143,19 +157,28 @@ SOURCES += source/Animation.cpp \
            source/Player.cpp \
            source/Random.cpp \
            source/Rendering.cpp \
+           source/RenderSnapshot.cpp \
+           source/RenderThread.cpp \
+           source/Replay.cpp \
            source/ReserveItem.cpp \
            source/ResourceManager.cpp \
+           source/ResourcePack.cpp \
            source/Settings.cpp \
            source/Shell.cpp \
+           source/SoftwareRenderer.cpp \
            source/Sound.cpp \
            source/Spiny.cpp \
            source/Sprite.cpp \
+           source/SpriteBatch.cpp \
            source/Star.cpp \
            source/StringSwitch.cpp \
            source/Text.cpp \
+           source/TextMeshCache.cpp \
            source/TextParticle.cpp \
+           source/ThreadPool.cpp \
            source/Texture.cpp \
            source/Tile.cpp \
+           source/TileMap.cpp \
            source/TransitionState.cpp \
            source/World.cpp \
            source/LevelGenerators/HillyLevelGenerator.cpp \
@@ -166,4 +189,4 @@ SOURCES += source/Animation.cpp \
 # RapidXML
 INCLUDEPATH += /usr/include/rapidxml
 
-LIBS += -lSDL2 -lIL -lILU -lSDL2_mixer
+LIBS += -lSDL2 -lIL -lILU -lpng -lSDL2_mixer
@@ -0,0 +1,10 @@
+# Headless fixed-step simulator. Shares everything with Mario.pro except the
+# program entry point.
+include(Mario.pro)
+
+TARGET = MarioHeadless
+
+SOURCES -= source/Main.cpp
+HEADERS += source/HeadlessAllocations.hpp
+SOURCES += source/HeadlessAllocations.cpp \
+           source/HeadlessMain.cpp
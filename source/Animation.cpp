@@ -1,7 +1,5 @@
 #include <algorithm>
 
-#include <GL/gl.h>
-
 #include "Animation.hpp"
 #include "Globals.hpp"
 
@@ -29,25 +27,26 @@ void Animation::addFrame(
 	int duration
 )
 {
-	// Duplicate frames that have a duration > 1
-	for( int i = 0; i < duration; ++i )
-	{
-		Frame f;
-		f.left = left;
-		f.right = right;
-		f.bottom = bottom;
-		f.top = top;
-		f.xOffset = xOffset;
-		f.yOffset = yOffset;
-		f.width = width;
-		f.height = height;
-		frames.push_back(f);
-	}
+	Frame f;
+	f.left = left;
+	f.right = right;
+	f.bottom = bottom;
+	f.top = top;
+	f.page = 0;
+	f.xOffset = xOffset;
+	f.yOffset = yOffset;
+	f.width = width;
+	f.height = height;
+	addFrame( f, duration );
 }
 
 void Animation::addFrame( const Frame& frame, int duration )
 {
-	addFrame( frame.left, frame.right, frame.bottom, frame.top, frame.xOffset, frame.yOffset, frame.width, frame.height, duration );
+	// Duplicate frames that have a duration > 1
+	for( int i = 0; i < duration; ++i )
+	{
+		frames.push_back(frame);
+	}
 }
 
 void Animation::getFrame(
@@ -104,7 +103,7 @@ bool Animation::getVerticalOrientation() const
 	return verticalOrientation;
 }
 
-void Animation::renderFrame( const Frame& frame, bool mirrorX, bool mirrorY ) const
+void Animation::renderFrame( const Frame& frame, bool mirrorX, bool mirrorY, const Color& color ) const
 {
 	double left = frame.left;
 	double right = frame.right;
@@ -122,21 +121,17 @@ void Animation::renderFrame( const Frame& frame, bool mirrorX, bool mirrorY ) co
 	}
 
 	// Render a quad
-	glBegin(GL_QUADS);
-		glTexCoord2d(left, bottom);
-		glVertex2d(0.0, 0.0);
-		glTexCoord2d(right, bottom);
-		glVertex2d(frame.width * UNIT_SIZE, 0.0);
-		glTexCoord2d(right, top);
-		glVertex2d(frame.width * UNIT_SIZE, frame.height * UNIT_SIZE);
-		glTexCoord2d(left, top);
-		glVertex2d(0.0, frame.height * UNIT_SIZE);
-	glEnd();
+	SPRITE_BATCH.drawQuad(RESOURCE_MANAGER.getTextureAtlas(frame.page), 0.0, 0.0, frame.width * UNIT_SIZE, frame.height * UNIT_SIZE, left, bottom, right, top, color);
 }
 
-void Animation::renderFrame( int frameNumber, bool mirrorX, bool mirrorY ) const
+void Animation::renderFrame( int frameNumber, bool mirrorX, bool mirrorY, const Color& color ) const
 {
 	// Get the frame and render it
 	const Frame& frame = getFrame(frameNumber);
-	renderFrame(frame, mirrorX, mirrorY);
+	renderFrame(frame, mirrorX, mirrorY, color);
+}
+
+void Animation::setFrameBySequence( int sequence, const Frame& frame )
+{
+	frames[sequence] = frame;
 }
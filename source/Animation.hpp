@@ -3,6 +3,8 @@
 
 #include <vector>
 
+#include "Color.hpp"
+
 /**
  * A renderable graphic made up of one or more Frames.
  */
@@ -19,6 +21,7 @@ public:
 		double right;
 		double bottom;
 		double top;
+		int page; /**< The page of the texture atlas that the frame is on. */
 
 		// Rendering parameters:
 		double xOffset;
@@ -38,7 +41,7 @@ public:
 	Animation( bool horizontalOrientation, bool verticalOrientation );
 
 	/**
-	 * Add a new frame to the animation.
+	 * Add a new frame to the animation, on the first page of the texture atlas.
 	 *
 	 * @param left the left texture coordinate.
 	 * @param right the right texture coordinate.
@@ -134,18 +137,24 @@ public:
 	 * @param frame the Frame of the animation to render.
 	 * @param mirrorX whether mirroring should be performed in the x direction.
 	 * @param mirrorY whether mirroring should be performed in the y direction.
+	 * @param color the color to tint the frame with.
 	 * @note this assumes that the current projection has positive y facing up,
-	 * and that one unit = one pixel.
+	 * and that one unit = one pixel. The frame is added to the SpriteBatch.
 	 */
-	void renderFrame( const Frame& frame, bool mirrorX = false, bool mirrorY = false ) const;
+	void renderFrame( const Frame& frame, bool mirrorX = false, bool mirrorY = false, const Color& color = Color(255, 255, 255, 255) ) const;
 
 	/**
 	 * Render a frame of the animation.
 	 *
 	 * @see getFrame() for frameNumber parameter documentation.
-	 * @see renderFrame() for mirrorX and mirrorY parameter documentation.
+	 * @see renderFrame() for mirrorX, mirrorY, and color parameter documentation.
+	 */
+	void renderFrame( int frameNumber = 0, bool mirrorX = false, bool mirrorY = false, const Color& color = Color(255, 255, 255, 255) ) const;
+
+	/**
+	 * Replace a frame by its absolute sequence in the Animation.
 	 */
-	void renderFrame( int frameNumber = 0, bool mirrorX = false, bool mirrorY = false ) const;
+	void setFrameBySequence( int sequence, const Frame& frame );
 
 private:
 	std::vector<Frame> frames;
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <climits>
+
+#include "AtlasPacker.hpp"
+
+AtlasPacker::AtlasPacker( int pageSize ) :
+	pageSize(pageSize)
+{
+}
+
+bool AtlasPacker::findPosition( const Page& page, int width, int height, int& x, int& y )
+{
+	int bestShortSide = INT_MAX;
+	int bestLongSide = INT_MAX;
+	for( auto& free : page.freeRectangles )
+	{
+		if( free.width < width || free.height < height )
+		{
+			continue;
+		}
+
+		int leftoverX = free.width - width;
+		int leftoverY = free.height - height;
+		int shortSide = std::min(leftoverX, leftoverY);
+		int longSide = std::max(leftoverX, leftoverY);
+		if( shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide) )
+		{
+			bestShortSide = shortSide;
+			bestLongSide = longSide;
+			x = free.x;
+			y = free.y;
+		}
+	}
+
+	return bestShortSide != INT_MAX;
+}
+
+int AtlasPacker::getPageCount() const
+{
+	return static_cast<int>(pages.size());
+}
+
+int AtlasPacker::getPageSize() const
+{
+	return pageSize;
+}
+
+int AtlasPacker::getUsedHeight( int page ) const
+{
+	return pages[page].usedHeight;
+}
+
+double AtlasPacker::getUtilization() const
+{
+	if( pages.empty() )
+	{
+		return 0.0;
+	}
+
+	long long usedArea = 0;
+	for( auto& page : pages )
+	{
+		usedArea += page.usedArea;
+	}
+	return (double)usedArea / ((double)pageSize * pageSize * pages.size());
+}
+
+bool AtlasPacker::insert( int width, int height, int& page, int& x, int& y )
+{
+	if( width <= 0 || height <= 0 || width > pageSize || height > pageSize )
+	{
+		return false;
+	}
+
+	// Fill the earlier pages first, so that the last page is the only one with much free space
+	for( page = 0; page < (int)pages.size(); ++page )
+	{
+		if( findPosition(pages[page], width, height, x, y) )
+		{
+			place(pages[page], Rectangle{x, y, width, height});
+			return true;
+		}
+	}
+
+	Page newPage;
+	newPage.freeRectangles.push_back(Rectangle{0, 0, pageSize, pageSize});
+	newPage.usedArea = 0;
+	newPage.usedHeight = 0;
+	pages.push_back(newPage);
+
+	findPosition(pages[page], width, height, x, y);
+	place(pages[page], Rectangle{x, y, width, height});
+	return true;
+}
+
+void AtlasPacker::place( Page& page, const Rectangle& used )
+{
+	page.usedArea += (long long)used.width * used.height;
+	page.usedHeight = std::max(page.usedHeight, used.y + used.height);
+
+	// Replace every free rectangle that overlaps the used one with the parts of it on each side
+	std::vector<Rectangle> freeRectangles;
+	std::vector<Rectangle> splitRectangles;
+	for( auto& free : page.freeRectangles )
+	{
+		if( used.x >= free.x + free.width || used.x + used.width <= free.x ||
+			used.y >= free.y + free.height || used.y + used.height <= free.y )
+		{
+			freeRectangles.push_back(free);
+			continue;
+		}
+
+		if( used.x > free.x )
+		{
+			splitRectangles.push_back(Rectangle{free.x, free.y, used.x - free.x, free.height});
+		}
+		if( used.x + used.width < free.x + free.width )
+		{
+			splitRectangles.push_back(Rectangle{used.x + used.width, free.y, free.x + free.width - used.x - used.width, free.height});
+		}
+		if( used.y > free.y )
+		{
+			splitRectangles.push_back(Rectangle{free.x, free.y, free.width, used.y - free.y});
+		}
+		if( used.y + used.height < free.y + free.height )
+		{
+			splitRectangles.push_back(Rectangle{free.x, used.y + used.height, free.width, free.y + free.height - used.y - used.height});
+		}
+	}
+
+	// Only keep the new rectangles that aren't inside another free rectangle.
+	// The old ones can't be inside a new one, since they weren't inside the
+	// rectangle it was split from.
+	auto contains = []( const Rectangle& outer, const Rectangle& inner )
+	{
+		return inner.x >= outer.x && inner.y >= outer.y &&
+			inner.x + inner.width <= outer.x + outer.width &&
+			inner.y + inner.height <= outer.y + outer.height;
+	};
+	int oldCount = freeRectangles.size();
+	for( int i = 0; i < (int)splitRectangles.size(); ++i )
+	{
+		const Rectangle& split = splitRectangles[i];
+		bool redundant = false;
+		for( int j = 0; j < oldCount && !redundant; ++j )
+		{
+			redundant = contains(freeRectangles[j], split);
+		}
+		for( int j = 0; j < (int)splitRectangles.size() && !redundant; ++j )
+		{
+			// Of two identical rectangles, only the first is kept
+			redundant = j != i && contains(splitRectangles[j], split) &&
+				(j < i || !contains(split, splitRectangles[j]));
+		}
+		if( !redundant )
+		{
+			freeRectangles.push_back(split);
+		}
+	}
+
+	page.freeRectangles.swap(freeRectangles);
+}
@@ -0,0 +1,91 @@
+#ifndef ATLASPACKER_HPP
+#define ATLASPACKER_HPP
+
+#include <vector>
+
+/**
+ * Places rectangles on square texture atlas pages without overlapping them,
+ * using the maximal rectangles algorithm. Each page keeps a list of the
+ * largest free rectangles left on it, and a new rectangle goes in the free
+ * rectangle that it fits most tightly. A new page is started whenever a
+ * rectangle doesn't fit on any of the pages so far.
+ *
+ * Rectangles are packed best when they are inserted from tallest to
+ * shortest.
+ */
+class AtlasPacker
+{
+public:
+	/**
+	 * Create a packer with no pages.
+	 *
+	 * @param pageSize the width and height of every page.
+	 */
+	AtlasPacker( int pageSize );
+
+	/**
+	 * Get the number of pages that rectangles were placed on.
+	 */
+	int getPageCount() const;
+
+	/**
+	 * Get the width and height of every page.
+	 */
+	int getPageSize() const;
+
+	/**
+	 * Get the number of rows of a page, from the top, that have rectangles
+	 * in them.
+	 */
+	int getUsedHeight( int page ) const;
+
+	/**
+	 * Get the fraction of the area of all pages that rectangles cover.
+	 */
+	double getUtilization() const;
+
+	/**
+	 * Place a rectangle, on the first page that it fits on.
+	 *
+	 * @param page set to the page the rectangle was placed on.
+	 * @param x set to the x coordinate of the rectangle, from the left.
+	 * @param y set to the y coordinate of the rectangle, from the top.
+	 * @return false if the rectangle is empty or bigger than a page.
+	 */
+	bool insert( int width, int height, int& page, int& x, int& y );
+
+private:
+	struct Rectangle
+	{
+		int x;
+		int y;
+		int width;
+		int height;
+	};
+
+	struct Page
+	{
+		std::vector<Rectangle> freeRectangles; /**< The largest rectangles of free space, which can overlap each other. */
+		long long usedArea;
+		int usedHeight;
+	};
+
+	std::vector<Page> pages;
+	int pageSize;
+
+	/**
+	 * Find the free rectangle of a page that fits a rectangle best, which is
+	 * the one with the least space left along its shorter side.
+	 *
+	 * @return false if the rectangle doesn't fit on the page.
+	 */
+	static bool findPosition( const Page& page, int width, int height, int& x, int& y );
+
+	/**
+	 * Mark a rectangle of a page as used, and split the free rectangles that
+	 * overlap it into the free space left around it.
+	 */
+	static void place( Page& page, const Rectangle& used );
+};
+
+#endif // ATLASPACKER_HPP
@@ -1,10 +1,34 @@
+#include <cmath>
+
 #include "Animation.hpp"
 #include "Background.hpp"
+#include "Globals.hpp"
+#include "RenderSnapshot.hpp"
+
+/**
+ * Get how far the background is scrolled along one axis, in pixels.
+ */
+static int getScroll( double viewPosition, double parallax )
+{
+	return static_cast<int>(std::floor(std::floor(viewPosition * UNIT_SIZE) * parallax));
+}
 
-Background::Background( const Texture& texture, Animation* animation, BackgroundTiling tiling ) :
-	texture(texture),
+/**
+ * Get how far the background is scrolled along one axis, in pixels from
+ * the start of the repetition at the edge of the view.
+ */
+static int getScrollOffset( double viewPosition, double parallax, int frameSize )
+{
+	int offset = getScroll(viewPosition, parallax) % frameSize;
+	return offset < 0 ? offset + frameSize : offset;
+}
+
+Background::Background( const std::vector<const Texture*>& textures, Animation* animation, BackgroundTiling tiling, double parallaxX, double parallaxY ) :
+	textures(textures),
 	backgroundAnimation(animation),
-	tiling(tiling)
+	tiling(tiling),
+	parallaxX(parallaxX),
+	parallaxY(parallaxY)
 {
 }
 
@@ -18,12 +42,82 @@ const Animation& Background::getAnimation() const
 	return *backgroundAnimation;
 }
 
-const Texture& Background::getTexture() const
+const Texture* Background::getTexture( int frameNumber ) const
 {
-	return texture;
+	return textures[frameNumber % textures.size()];
 }
 
 BackgroundTiling Background::getTiling() const
 {
 	return tiling;
 }
+
+void Background::render( int frameNumber, double viewLeft, double viewBottom, double viewWidth, double viewHeight, RenderSnapshot* snapshot ) const
+{
+	const Animation::Frame& frame = backgroundAnimation->getFrame(frameNumber);
+	int frameWidth = (int)(frame.width * UNIT_SIZE);
+	int frameHeight = (int)(frame.height * UNIT_SIZE);
+	if( frameWidth <= 0 || frameHeight <= 0 )
+	{
+		return;
+	}
+
+	int offsetX = getScrollOffset(viewLeft, parallaxX, frameWidth);
+	int offsetY = getScrollOffset(viewBottom, parallaxY, frameHeight);
+
+	// Cover the view along tiled axes, and one repetition along the others.
+	// The texture repeats, so coordinates past its edges wrap around.
+	double x = -offsetX / (double)UNIT_SIZE;
+	double width = frame.width;
+	double left = 0.0;
+	double right = 1.0;
+	if( tiling != BACKGROUND_VERTICAL )
+	{
+		x = 0.0;
+		width = viewWidth;
+		left = offsetX / (double)frameWidth;
+		right = left + viewWidth * UNIT_SIZE / frameWidth;
+	}
+
+	// Texture rows start at the top of the image
+	double y = -offsetY / (double)UNIT_SIZE;
+	double height = frame.height;
+	double bottom = 1.0;
+	double top = 0.0;
+	if( tiling != BACKGROUND_HORIZONTAL )
+	{
+		y = 0.0;
+		height = viewHeight;
+		bottom = 1.0 - offsetY / (double)frameHeight;
+		top = bottom - viewHeight * UNIT_SIZE / frameHeight;
+	}
+
+	SpriteBatch& batch = SPRITE_BATCH;
+	batch.pushTransform();
+	batch.translate(0.0, 0.0, -10.0);
+	if( snapshot != nullptr )
+	{
+		snapshot->beginScroll(getScroll(viewLeft, parallaxX), getScroll(viewBottom, parallaxY),
+			tiling != BACKGROUND_VERTICAL ? frameWidth : 0, tiling != BACKGROUND_HORIZONTAL ? frameHeight : 0);
+	}
+	batch.drawQuad(getTexture(frameNumber), x, y, width, height, left, bottom, right, top);
+	if( snapshot != nullptr )
+	{
+		snapshot->endScroll();
+	}
+
+	if( SETTINGS.debugMode )
+	{
+		// Outline each repetition in view
+		double outlineRight = (tiling != BACKGROUND_VERTICAL) ? viewWidth : x + frame.width;
+		double outlineTop = (tiling != BACKGROUND_HORIZONTAL) ? viewHeight : y + frame.height;
+		for( double outlineX = -offsetX / (double)UNIT_SIZE; outlineX < outlineRight; outlineX += frame.width )
+		{
+			for( double outlineY = -offsetY / (double)UNIT_SIZE; outlineY < outlineTop; outlineY += frame.height )
+			{
+				batch.drawOutline(outlineX, outlineY, frame.width, frame.height, Color(0, 0, 0, 0x7f));
+			}
+		}
+	}
+	batch.popTransform();
+}
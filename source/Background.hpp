@@ -1,7 +1,10 @@
 #ifndef BACKGROUND_HPP
 #define BACKGROUND_HPP
 
+#include <vector>
+
 class Animation;
+class RenderSnapshot;
 class Texture;
 
 /**
@@ -16,6 +19,10 @@ enum BackgroundTiling
 
 /**
  * A background image resource for a level.
+ *
+ * Each frame of the background has a texture of its own, so that it can be
+ * tiled across the view with a single quad by wrapping the texture
+ * coordinates.
  */
 class Background
 {
@@ -23,11 +30,13 @@ public:
 	/**
 	 * Create a new background image.
 	 *
-	 * @param texture the Texture to use.
-	 * @param animation the Animation to use.
+	 * @param textures the Texture of each frame of the animation.
+	 * @param animation the Animation to use. Its texture coordinates cover the whole frame texture.
 	 * @param tiling the BackgroundTiling mode to use when rendering.
+	 * @param parallaxX how far the background scrolls horizontally for each unit that the view scrolls.
+	 * @param parallaxY how far the background scrolls vertically for each unit that the view scrolls.
 	 */
-	Background( const Texture& texture, Animation* animation, BackgroundTiling tiling );
+	Background( const std::vector<const Texture*>& textures, Animation* animation, BackgroundTiling tiling, double parallaxX, double parallaxY );
 
 	~Background();
 
@@ -37,19 +46,36 @@ public:
 	const Animation& getAnimation() const;
 
 	/**
-	 * Get the Texture used by the background.
+	 * Get the Texture used by a frame of the background.
+	 *
+	 * @param frameNumber the frame number, which wraps around like Animation::getFrame().
 	 */
-	const Texture& getTexture() const;
+	const Texture* getTexture( int frameNumber ) const;
 
 	/**
 	 * Get the tiling mode used when rendering.
 	 */
 	BackgroundTiling getTiling() const;
 
+	/**
+	 * Render the background behind everything in the view, with the
+	 * SpriteBatch.
+	 *
+	 * @param frameNumber the frame of the animation to render.
+	 * @param viewLeft the left edge of the view in the level, in units.
+	 * @param viewBottom the bottom edge of the view in the level, in units.
+	 * @param viewWidth the width of the view, in units.
+	 * @param viewHeight the height of the view, in units.
+	 * @param snapshot the snapshot being recorded, if any, so that the scrolling can be interpolated.
+	 */
+	void render( int frameNumber, double viewLeft, double viewBottom, double viewWidth, double viewHeight, RenderSnapshot* snapshot = nullptr ) const;
+
 private:
-	const Texture& texture;
+	std::vector<const Texture*> textures;
 	Animation* backgroundAnimation;
 	BackgroundTiling tiling;
+	double parallaxX;
+	double parallaxY;
 };
 
 #endif // BACKGROUND_HPP
@@ -5,12 +5,14 @@
 
 Beetle::Beetle()
 {
+	static const ResourceId BEETLE_ANIMATION = ResourceManager::getResourceId("beetle");
+
 	setDefaultXVelocity(-1.0 * MOVEMENT_SPEED);
 	setWidth(WIDTH);
 	setHeight(HEIGHT);
 	setFireproof(true);
 
-	setAnimation("beetle");
+	setAnimation(BEETLE_ANIMATION);
 }
 
 void Beetle::onBump()
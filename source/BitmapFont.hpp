@@ -4,11 +4,16 @@
 #include <string>
 #include <vector>
 
-#include "Image.hpp"
+#include "TextMeshCache.hpp"
 #include "Vector2.hpp"
 
+class Image;
+class Texture;
+
 /**
- * A bitmap font that can render text.
+ * A bitmap font that can render text. Each character is drawn as one
+ * textured quad, and laid out strings are cached so that text which is
+ * drawn every frame isn't rebuilt.
  */
 class BitmapFont
 {
@@ -16,11 +21,13 @@ public:
 	/**
 	 * Create a new bitmap font using an image.
 	 *
-	 * @param imageFileName the name of the image file.
+	 * @param image the image of the characters, which is copied.
 	 * @param charWidth the width of each character.
 	 * @param charHeight the height of each character.
 	 */
-	BitmapFont( const std::string& imageFileName, int charWidth, int charHeight );
+	BitmapFont( const Image& image, int charWidth, int charHeight );
+
+	~BitmapFont();
 
 	/**
 	 * Add a single character to the bitmap font.
@@ -72,9 +79,10 @@ public:
 
 private:
 	std::vector< Vector2<int> > charData;
-	Image image;
 	int charWidth;
 	int charHeight;
+	mutable TextMeshCache textMeshes; /**< Laid out strings. */
+	Texture* texture; /**< The image of the font, for drawing the characters with. */
 };
 
 #endif // BITMAPFONT_HPP
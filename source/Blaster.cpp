@@ -3,6 +3,7 @@
 #include "Particle.hpp"
 #include "Player.hpp"
 #include "Random.hpp"
+#include "ResourceManager.hpp"
 #include "World.hpp"
 
 Blaster::Blaster() :
@@ -10,22 +11,28 @@ Blaster::Blaster() :
 	lastBlastFrame(0)
 {
 	setLayer(1);
+	setUpdateEnabled(true);
 }
 
 void Blaster::onInit()
 {
+	static const ResourceId BLASTER_ANIMATION = ResourceManager::getResourceId("blaster");
+	static const ResourceId BLASTER_SHORT_ANIMATION = ResourceManager::getResourceId("blaster_short");
+
 	if( getHeight() == 2 )
 	{
-		setAnimation("blaster");
+		setAnimation(BLASTER_ANIMATION);
 	}
 	else if( getHeight() == 1 )
 	{
-		setAnimation("blaster_short");
+		setAnimation(BLASTER_SHORT_ANIMATION);
 	}
 }
 
-void Blaster::onRender()
+void Blaster::onUpdate()
 {
+	static const ResourceId BLAST_SOUND = ResourceManager::getResourceId("blast");
+
 	// Blast bullets a minimum of every three seconds, with some randomness
 	if( getWorld().getFrameNumber() - lastBlastFrame > 180 && getWorld().getRandom().nextInt() % 60 == 0 )
 	{
@@ -52,7 +59,7 @@ void Blaster::onRender()
 		p->setTop( getTop() );
 		getWorld().addSprite(p);
 
-		playSound("blast");
+		playSound(BLAST_SOUND);
 
 		lastBlastFrame = getWorld().getFrameNumber();
 	}
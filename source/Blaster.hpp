@@ -15,7 +15,7 @@ private:
 	int lastBlastFrame;
 
 	void onInit();
-	void onRender();
+	void onUpdate();
 };
 
 #endif // BLASTER_HPP
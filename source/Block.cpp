@@ -48,12 +48,14 @@ Block::CoinParticle::CoinParticle( Player* player ) :
 	Particle( GET_ANIMATION("coin_particle"), COIN_PARTICLE_DURATION ),
 	player(player)
 {
+	static const ResourceId COIN_PARTICLE_ANIMATION = ResourceManager::getResourceId("coin_particle");
+
 	disableGravity();
 	disableCollisions();
 	setYAcceleration(COIN_PARTICLE_GRAVITY);
 	setYVelocity(COIN_PARTICLE_SPEED);
 	setMaximumYSpeed(COIN_PARTICLE_SPEED);
-	setAnimation("coin_particle");
+	setAnimation(COIN_PARTICLE_ANIMATION);
 }
 
 void Block::CoinParticle::onDestroy()
@@ -153,6 +155,11 @@ Block::~Block()
 
 void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 {
+	static const ResourceId BRICK_BREAK_SOUND = ResourceManager::getResourceId("brick_break");
+	static const ResourceId BUMP_SOUND = ResourceManager::getResourceId("bump");
+	static const ResourceId KICK_SOUND = ResourceManager::getResourceId("kick");
+	static const ResourceId SPROUT_SOUND = ResourceManager::getResourceId("sprout");
+
 	// Blocks can only be bumped when alive
 	if( dead )
 	{
@@ -160,7 +167,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 	}
 
 	// Bump sprites that are above
-	const std::set<Sprite*>* sprites = getWorld().getSprites(getXInt(), getYInt() + getHeightInt());
+	const std::vector<Sprite*>* sprites = getWorld().getSprites(getXInt(), getYInt() + getHeightInt());
 	if( sprites != nullptr )
 	{
 		for( auto sprite : *sprites )
@@ -179,7 +186,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 				{
 					bumper->scorePoints(MULTIPLE_KILL_POINT_SEQUENCE[0]);
 				}
-				playSound("kick");
+				playSound(KICK_SOUND);
 				continue;
 			}
 
@@ -227,7 +234,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 			bumper->setYVelocity( -0.5 * std::fabs(bumper->getYVelocity()) );
 		}
 
-		playSound("bump");
+		playSound(BUMP_SOUND);
 	}
 	else if( contents != nullptr )
 	{
@@ -238,7 +245,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 		dead = true;
 		setAnimation(deadAnimation);
 		bumpProgress = getWorld().getFrameNumber();
-		playSound("sprout");
+		playSound(SPROUT_SOUND);
 
 		if( fromPlayer )
 		{
@@ -279,7 +286,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 		dead = true;
 		setAnimation(deadAnimation);
 		bumpProgress = getWorld().getFrameNumber();
-		playSound("sprout");
+		playSound(SPROUT_SOUND);
 
 		if( fromPlayer )
 		{
@@ -290,7 +297,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 	{
 		//playAnimation(bumpAnimation, mainAnimation);
 		bumpProgress = getWorld().getFrameNumber();
-		playSound("bump");
+		playSound(BUMP_SOUND);
 	}
 	else
 	{
@@ -328,7 +335,7 @@ void Block::bump( bool strongBump, bool fromPlayer, Player* bumper )
 		getWorld().addSprite(getX(), getY(), p);
 
 		// Self-destruct
-		playSound("brick_break");
+		playSound(BRICK_BREAK_SOUND);
 		getWorld().destroyTile(this);
 	}
 }
@@ -354,6 +361,9 @@ void Block::init()
 	deadAnimation = getAnimation("block_dead");
 
 	setAnimation(mainAnimation);
+
+	// Blocks get bumped and change their animation when they are hit
+	setRenderCacheEnabled(false);
 }
 
 void Block::onCollision(Sprite& sprite, Edge edge)
@@ -1,15 +1,21 @@
 #include "Bullet.hpp"
 #include "Particle.hpp"
+#include "ResourceManager.hpp"
 #include "World.hpp"
 
+DEFINE_POOLED_ALLOCATION(Bullet)
+
 Bullet::Bullet()
 {
+	static const ResourceId BULLET_ANIMATION = ResourceManager::getResourceId("bullet");
+
 	setGravityEnabled(false);
 	setTileCollisionsEnabled(false);
 	setKickable(false);
 	setStompable(true);
-	setAnimation("bullet");
+	setAnimation(BULLET_ANIMATION);
 	setBounceOffEnemiesEnabled(false);
 	setHeight(BULLET_HEIGHT);
 	setFireproof(true);
+	setActivityPolicy(ACTIVITY_DESPAWN);
 }
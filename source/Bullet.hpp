@@ -2,6 +2,7 @@
 #define BULLET_HPP
 
 #include "Enemy.hpp"
+#include "ObjectPool.hpp"
 
 /**
  * A Bullet launched from a Blaster.
@@ -13,6 +14,8 @@ public:
 	static constexpr double BULLET_HEIGHT = 0.8; /**< The height of a bullet. */
 
 	Bullet();
+
+	DECLARE_POOLED_ALLOCATION()
 };
 
 #endif // BULLET_HPP
@@ -3,10 +3,14 @@
 #include "Particle.hpp"
 #include "World.hpp"
 
+DEFINE_POOLED_ALLOCATION(Coin)
+
 Coin::Coin() :
 	Item( POINT_VALUE )
 {
-	setAnimation("coin");
+	static const ResourceId COIN_ANIMATION = ResourceManager::getResourceId("coin");
+
+	setAnimation(COIN_ANIMATION);
 	disableGravity();
 	setWidth(COIN_WIDTH);
 	setHeight(COIN_HEIGHT);
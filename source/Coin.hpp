@@ -2,6 +2,7 @@
 #define COIN_HPP
 
 #include "Item.hpp"
+#include "ObjectPool.hpp"
 
 /**
  * A collectible coin.
@@ -24,6 +25,8 @@ public:
 	 */
 	Coin();
 
+	DECLARE_POOLED_ALLOCATION()
+
 	/**
 	 * Create sparkle effects around the coin.
 	 */
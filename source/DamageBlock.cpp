@@ -1,17 +1,21 @@
 #include "DamageBlock.hpp"
 #include "Player.hpp"
+#include "ResourceManager.hpp"
 
 DamageBlock::DamageBlock( bool fatal ) :
 	Tile(fatal ? TILE_NONE : TILE_SOLID),
 	fatal(fatal)
 {
+	static const ResourceId DAMAGE_BLOCK_ANIMATION = ResourceManager::getResourceId("damage_block");
+	static const ResourceId DAMAGE_BLOCK_FATAL_ANIMATION = ResourceManager::getResourceId("damage_block_fatal");
+
 	if( fatal )
 	{
-		setAnimation("damage_block_fatal");
+		setAnimation(DAMAGE_BLOCK_FATAL_ANIMATION);
 	}
 	else
 	{
-		setAnimation("damage_block");
+		setAnimation(DAMAGE_BLOCK_ANIMATION);
 	}
 }
 
@@ -2,6 +2,8 @@
 #include "Globals.hpp"
 #include "World.hpp"
 
+static unsigned int nextRenderId = 1; /**< The render ID given to the next Entity. 0 is kept for the level geometry. */
+
 Entity::Entity() :
 	layer(0),
 	activeAnimation(nullptr),
@@ -15,6 +17,8 @@ Entity::Entity() :
 	redMask(1.0f),
 	greenMask(1.0f),
 	blueMask(1.0f),
+	renderId(nextRenderId++),
+	renderStamp(-1),
 	world(nullptr)
 {
 	resourceManager = DEFAULT_RESOURCE_GROUP;
@@ -86,6 +90,11 @@ const Animation* Entity::getAnimation( const std::string& name ) const
 	return resourceManager->getAnimation(name);
 }
 
+const Animation* Entity::getAnimation( ResourceId id ) const
+{
+	return resourceManager->getAnimation(id);
+}
+
 double Entity::getAge() const
 {
 	if( world == nullptr )
@@ -165,6 +174,16 @@ void Entity::playAnimation( const std::string& name, const std::string& nextAnim
 	playAnimation(getAnimation(name), getAnimation(nextAnimation));
 }
 
+void Entity::playAnimation( ResourceId id )
+{
+	playAnimation(getAnimation(id));
+}
+
+void Entity::playAnimation( ResourceId id, ResourceId nextAnimation )
+{
+	playAnimation(getAnimation(id), getAnimation(nextAnimation));
+}
+
 void Entity::playMusic( const std::string& name, bool loop ) const
 {
 	resourceManager->playMusic(name, loop);
@@ -175,6 +194,11 @@ void Entity::playSound( const std::string& name, int channel ) const
 	resourceManager->playSound(name, channel);
 }
 
+void Entity::playSound( ResourceId id, int channel ) const
+{
+	resourceManager->playSound(id, channel);
+}
+
 void Entity::setAlpha( float alpha )
 {
 	this->alpha = alpha;
@@ -201,6 +225,11 @@ void Entity::setAnimation( const std::string& name )
 	setAnimation( getAnimation(name) );
 }
 
+void Entity::setAnimation( ResourceId id )
+{
+	setAnimation( getAnimation(id) );
+}
+
 void Entity::setAnimationPaused( bool paused, int pauseFrame )
 {
 	animationPaused = paused;
@@ -5,6 +5,7 @@
 
 #include "Animation.hpp"
 #include "Enums.hpp"
+#include "ResourceId.hpp"
 #include "Vector2.hpp"
 
 class ResourceManager;
@@ -148,16 +149,21 @@ protected:
 	int layer;
 
 	const Animation* getAnimation( const std::string& name ) const;
+	const Animation* getAnimation( ResourceId id ) const;
 	World& getWorld();
 	virtual void onPlayAnimationEnd() {}
 	virtual void onRender() {}
 	void playAnimation( const Animation* animation, const Animation* nextAnimation = nullptr );
 	void playAnimation( const std::string& name );
 	void playAnimation( const std::string& name, const std::string& nextAnimation );
+	void playAnimation( ResourceId id );
+	void playAnimation( ResourceId id, ResourceId nextAnimation );
 	void playMusic( const std::string& name, bool loop = true ) const;
 	void playSound( const std::string& name, int channel = -1 ) const;
+	void playSound( ResourceId id, int channel = -1 ) const;
 	void setAnimation( const Animation* animation );
 	void setAnimation( const std::string& name );
+	void setAnimation( ResourceId id );
 
 	/**
 	 * Pause (or unpause) the current animation.
@@ -186,6 +192,8 @@ private:
 	float blueMask;
 	Vector2<double> offset; /**< Offset used for rendering. */
 
+	unsigned int renderId; /**< Identifies the Entity in render snapshots. Every Entity gets a new one. */
+	int renderStamp; /**< The World render pass that the Entity was last queued for. */
 	const ResourceManager* resourceManager;
 
 	World* world;
@@ -9,29 +9,37 @@
 #include "Tile.hpp"
 #include "World.hpp"
 
+DEFINE_POOLED_ALLOCATION(Fireball)
+
 Fireball::Fireball(Player* player, double xVelocity) :
 	player(player)
 {
+	static const ResourceId FIREBALL_ANIMATION = ResourceManager::getResourceId("fireball");
+
 	setWidth(FIREBALL_SIZE);
 	setHeight(FIREBALL_SIZE);
-	setAnimation("fireball");
+	setAnimation(FIREBALL_ANIMATION);
 	setXVelocity(xVelocity);
+	setActivityPolicy(ACTIVITY_DESPAWN);
 }
 
 void Fireball::onCollision(Sprite& sprite, Edge edge)
 {
+	static const ResourceId BUMP_SOUND = ResourceManager::getResourceId("bump");
+	static const ResourceId KICK_SOUND = ResourceManager::getResourceId("kick");
+
 	Enemy* enemy = dynamic_cast<Enemy*>(&sprite);
 	if( enemy  != nullptr )
 	{
 		if( !enemy->isFireproof() )
 		{
 			enemy->hit();
-			playSound("kick");
+			playSound(KICK_SOUND);
 			player->scorePoints(MULTIPLE_KILL_POINT_SEQUENCE[0], sprite.getX() + sprite.getWidth(), sprite.getY());
 		}
 		else
 		{
-			playSound("bump");
+			playSound(BUMP_SOUND);
 		}
 		kill();
 	}
@@ -39,12 +47,14 @@ void Fireball::onCollision(Sprite& sprite, Edge edge)
 
 void Fireball::onCollision(Tile& tile, Edge edge)
 {
+	static const ResourceId BUMP_SOUND = ResourceManager::getResourceId("bump");
+
 	// Destroy fireballs when they hit damage blocks
 	DamageBlock* block = dynamic_cast<DamageBlock*>(&tile);
 	if( block != nullptr )
 	{
 		kill();
-		playSound("bump");
+		playSound(BUMP_SOUND);
 		return;
 	}
 
@@ -59,7 +69,7 @@ void Fireball::onCollision(Tile& tile, Edge edge)
 	else if( (edge == EDGE_LEFT || edge == EDGE_RIGHT) && tile.getCollisionBehavior() == TILE_SOLID )
 	{
 		kill();
-		playSound("bump");
+		playSound(BUMP_SOUND);
 	}
 }
 
@@ -1,6 +1,7 @@
 #ifndef FIREBALL_HPP
 #define FIREBALL_HPP
 
+#include "ObjectPool.hpp"
 #include "Sprite.hpp"
 
 class Player;
@@ -24,6 +25,8 @@ public:
 	 */
 	Fireball(Player* player, double xVelocity);
 
+	DECLARE_POOLED_ALLOCATION()
+
 private:
 	Player* player;
 
@@ -1,6 +1,9 @@
 #include "Flower.hpp"
+#include "ResourceManager.hpp"
 
 Flower::Flower()
 {
-	setAnimation("flower");
+	static const ResourceId FLOWER_ANIMATION = ResourceManager::getResourceId("flower");
+
+	setAnimation(FLOWER_ANIMATION);
 }
@@ -1,14 +1,35 @@
+#include <algorithm>
+#include <thread>
+
 #include <SDL2/SDL.h>
 
 #include "FpsManager.hpp"
+#include "Globals.hpp"
+
+static const int FRAME_TIME_WINDOW = 600; /**< The number of recent frames kept for the frame time statistics. */
+static const std::chrono::microseconds SPIN_DURATION(2000); /**< How long before the end of a frame to stop sleeping and spin instead, since sleeps can overshoot. */
+
+/**
+ * Convert a duration to milliseconds.
+ */
+static double toMilliseconds( std::chrono::steady_clock::duration duration )
+{
+	return std::chrono::duration<double, std::milli>(duration).count();
+}
 
 FpsManager::FpsManager(float fps) :
 	currentFps(0),
 	desiredFps(fps),
+	droppedFrames(0),
 	fpsTicks(SDL_GetTicks()),
 	frameCount(0),
+	frameEndTime(Clock::now()),
+	framePeriod(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / fps))),
+	nextFrameTime(frameEndTime + framePeriod),
+	recordedFrames(0),
 	ticks(SDL_GetTicks())
 {
+	frameTimes.reserve(FRAME_TIME_WINDOW);
 }
 
 float FpsManager::getDesiredFrameRate() const
@@ -16,14 +37,82 @@ float FpsManager::getDesiredFrameRate() const
 	return desiredFps;
 }
 
+int FpsManager::getDroppedFrameCount() const
+{
+	return droppedFrames;
+}
+
 float FpsManager::getFrameRate() const
 {
 	return currentFps;
 }
 
-bool FpsManager::update()
+FpsManager::FrameTimeStats FpsManager::getFrameTimeStats() const
+{
+	FrameTimeStats stats = { 0.0, 0.0, 0.0, 0.0 };
+	if( frameTimes.empty() )
+	{
+		return stats;
+	}
+
+	std::vector<float> sorted(frameTimes);
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&sorted]( double p ) -> double
+	{
+		int index = static_cast<int>(p * sorted.size() + 0.5) - 1;
+		return sorted[std::min(std::max(index, 0), (int)sorted.size() - 1)];
+	};
+	stats.p50 = percentile(0.50);
+	stats.p95 = percentile(0.95);
+	stats.p99 = percentile(0.99);
+	stats.max = sorted.back();
+	return stats;
+}
+
+bool FpsManager::openFrameTimeLog( const std::string& fileName )
+{
+	frameTimeLog.open(fileName.c_str());
+	if( !frameTimeLog )
+	{
+		return false;
+	}
+
+	frameTimeLog << "frame,frame_ms,work_ms,dropped\n";
+	return true;
+}
+
+bool FpsManager::pace()
+{
+	Clock::time_point now = Clock::now();
+	bool frameSkip = true;
+	if( now < nextFrameTime )
+	{
+		// Sleep for most of the remaining time, then spin to the end of the frame
+		Clock::duration sleepTime = nextFrameTime - now - SPIN_DURATION;
+		if( sleepTime > Clock::duration::zero() )
+		{
+			std::this_thread::sleep_for(sleepTime);
+		}
+		while( Clock::now() < nextFrameTime )
+		{
+			std::this_thread::yield();
+		}
+		frameSkip = false;
+	}
+
+	// Keep to the schedule so that the average rate is exact, unless a whole
+	// frame behind, since catching up would run several frames back to back
+	nextFrameTime += framePeriod;
+	if( nextFrameTime < now )
+	{
+		nextFrameTime = now + framePeriod;
+	}
+
+	return frameSkip;
+}
+
+bool FpsManager::paceTicks()
 {
-	//Manage framerate
 	bool frameSkip = true;
 	Uint32 tickDifference = SDL_GetTicks() - ticks;
 	if( (float)tickDifference < (1000.0f / desiredFps) )
@@ -34,6 +123,46 @@ bool FpsManager::update()
 	}
 	ticks = SDL_GetTicks();
 
+	return frameSkip;
+}
+
+void FpsManager::recordFrameTime( Clock::duration frameTime, Clock::duration workTime )
+{
+	double milliseconds = toMilliseconds(frameTime);
+	if( (int)frameTimes.size() < FRAME_TIME_WINDOW )
+	{
+		frameTimes.push_back(static_cast<float>(milliseconds));
+	}
+	else
+	{
+		frameTimes[recordedFrames % FRAME_TIME_WINDOW] = static_cast<float>(milliseconds);
+	}
+
+	// A frame that took more than one and a half periods missed at least one
+	int dropped = 0;
+	double period = toMilliseconds(framePeriod);
+	if( milliseconds > 1.5 * period )
+	{
+		dropped = static_cast<int>(milliseconds / period + 0.5) - 1;
+		droppedFrames += dropped;
+	}
+
+	if( frameTimeLog.is_open() )
+	{
+		frameTimeLog << recordedFrames << ',' << milliseconds << ',' << toMilliseconds(workTime) << ',' << dropped << '\n';
+	}
+	recordedFrames++;
+}
+
+bool FpsManager::update()
+{
+	//Manage framerate
+	Clock::time_point workEndTime = Clock::now();
+	bool frameSkip = SETTINGS.precisePacing ? pace() : paceTicks();
+	Clock::time_point now = Clock::now();
+	recordFrameTime(now - frameEndTime, workEndTime - frameEndTime);
+	frameEndTime = now;
+
 	frameCount++;
 
 	//Calculate fps
@@ -1,12 +1,32 @@
 #ifndef FPSMANAGER_HPP
 #define FPSMANAGER_HPP
 
+#include <chrono>
+#include <fstream>
+#include <string>
+#include <vector>
+
 /**
 * FPS (frames per second) manager.
+*
+* Besides pacing the game, it keeps the duration of recent frames so that
+* stutter can be measured, and can write the duration of every frame to a
+* CSV file.
 */
 class FpsManager
 {
 public:
+	/**
+	 * Frame time statistics over the recent frames, in milliseconds.
+	 */
+	struct FrameTimeStats
+	{
+		double p50; /**< The median frame time. */
+		double p95; /**< The frame time that 95% of the frames were within. */
+		double p99; /**< The frame time that 99% of the frames were within. */
+		double max; /**< The longest frame time. */
+	};
+
 	/**
 	* Constructor.
 	*
@@ -19,6 +39,12 @@ public:
 	 */
 	float getDesiredFrameRate() const;
 
+	/**
+	 * Get the number of frames that were dropped so far. A frame is dropped
+	 * for every frame period that a frame overran by.
+	 */
+	int getDroppedFrameCount() const;
+
 	/**
 	* Get the current frame rate in frames per second.
 	*
@@ -26,6 +52,18 @@ public:
 	*/
 	float getFrameRate() const;
 
+	/**
+	 * Get statistics about the duration of the recent frames.
+	 */
+	FrameTimeStats getFrameTimeStats() const;
+
+	/**
+	 * Start writing the duration of every frame to a CSV file.
+	 *
+	 * @return if the file could be opened.
+	 */
+	bool openFrameTimeLog( const std::string& fileName );
+
 	/**
 	* Manage frames per second. This will sleep the calling thread
 	* automatically if there is time until the next frame.
@@ -35,11 +73,43 @@ public:
 	bool update();
 
 private:
+	typedef std::chrono::steady_clock Clock;
+
 	float currentFps;
 	float desiredFps;
+	int droppedFrames;
 	unsigned fpsTicks;
 	unsigned frameCount;
+	Clock::time_point frameEndTime; /**< When the last frame ended. */
+	Clock::duration framePeriod; /**< The duration of a frame at the desired frame rate. */
+	std::ofstream frameTimeLog;
+	std::vector<float> frameTimes; /**< The duration of the recent frames, in milliseconds, as a ring buffer. */
+	Clock::time_point nextFrameTime; /**< When the next frame should end, when pacing with the high resolution clock. */
+	unsigned long long recordedFrames; /**< The number of frames recorded in the statistics so far. */
 	unsigned ticks;
+
+	/**
+	 * Sleep until it is time to end the frame, using the high resolution
+	 * clock.
+	 *
+	 * @return if the frame was late.
+	 */
+	bool pace();
+
+	/**
+	 * Sleep until it is time to end the frame, using SDL ticks.
+	 *
+	 * @return if the frame was late.
+	 */
+	bool paceTicks();
+
+	/**
+	 * Add the duration of a frame to the statistics.
+	 *
+	 * @param frameTime the time since the last frame ended.
+	 * @param workTime the part of the frame spent before waiting.
+	 */
+	void recordFrameTime( Clock::duration frameTime, Clock::duration workTime );
 };
 
 #endif // FPSMANAGER_HPP
@@ -1,11 +1,21 @@
 #include "Episode.hpp"
 #include "GameSession.hpp"
 #include "Player.hpp"
+#include "Replay.hpp"
 #include "World.hpp"
 
+GameSession::GameSession() :
+	episode(nullptr),
+	player(nullptr),
+	replay(nullptr),
+	world(nullptr)
+{
+}
+
 GameSession::~GameSession()
 {
 	delete episode;
 	delete player;
+	delete replay;
 	delete world;
 }
@@ -3,6 +3,7 @@
 
 class Episode;
 class Player;
+class Replay;
 class World;
 
 /**
@@ -12,8 +13,10 @@ struct GameSession
 {
 	Episode* episode;
 	Player* player;
+	Replay* replay; /**< The replay being recorded for the current level, if any. */
 	World* world;
 
+	GameSession();
 	~GameSession();
 };
 
@@ -1,5 +1,6 @@
 #include "Globals.hpp"
 
+void* glContext = nullptr;
 void* window = nullptr;
 
 void createGlobals()
@@ -9,12 +10,14 @@ void createGlobals()
 	Singleton<Settings>::createInstance();
 	Singleton<ResourceManager>::createInstance();
 	Singleton<InputManager>::createInstance();
+	Singleton<SpriteBatch>::createInstance();
 	//Singleton<GameSession>::createInstance();
 }
 
 void destroyGlobals()
 {
 	//Singleton<GameSession>::destroyInstance();
+	Singleton<SpriteBatch>::destroyInstance();
 	Singleton<InputManager>::destroyInstance();
 	Singleton<FpsManager>::destroyInstance();
 	Singleton<Settings>::destroyInstance();
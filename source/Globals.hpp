@@ -13,6 +13,7 @@
 #include "ResourceManager.hpp"
 #include "Settings.hpp"
 #include "Singleton.hpp"
+#include "SpriteBatch.hpp"
 
 //=====================================================================
 // Global Macros
@@ -22,7 +23,7 @@
 #define RESOURCE_MANAGER (Singleton<ResourceManager>::getInstance())
 #define GET_RESOURCE_GROUP(name) (Singleton<ResourceManager>::getInstance().getResourceGroup(name))
 #define DEFAULT_RESOURCE_GROUP_NAME "default"
-#define DEFAULT_RESOURCE_GROUP (GET_RESOURCE_GROUP(DEFAULT_RESOURCE_GROUP_NAME))
+#define DEFAULT_RESOURCE_GROUP (Singleton<ResourceManager>::getInstance().getDefaultResourceGroup())
 
 // Note: do not use these macros within entity classes unless the resources should not be overridden
 #define GET_ANIMATION(name) (DEFAULT_RESOURCE_GROUP->getAnimation(name))
@@ -42,11 +43,13 @@
 #define GAME_SESSION (Singleton<GameSession>::getInstance())
 #define INPUT_MANAGER (Singleton<InputManager>::getInstance())
 #define SETTINGS (Singleton<Settings>::getInstance())
+#define SPRITE_BATCH (Singleton<SpriteBatch>::getInstance())
 
 //=====================================================================
 // Global Variables
 //=====================================================================
 ///@todo we need a singleton for rendering stuff. Move this once we have one
+extern void* glContext; /**< Handle to the SDL2 OpenGL context. */
 extern void* window; /**< Handle to the SDL2 window. */
 
 //=====================================================================
@@ -5,11 +5,13 @@
 
 Goomba::Goomba()
 {
+	static const ResourceId GOOMBA_ANIMATION = ResourceManager::getResourceId("goomba");
+
 	setDefaultXVelocity(-1.0 * MOVEMENT_SPEED);
 	setWidth(WIDTH);
 	setHeight(HEIGHT);
 
-	setAnimation("goomba");
+	setAnimation(GOOMBA_ANIMATION);
 }
 
 void Goomba::onStomp()
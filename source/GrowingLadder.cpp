@@ -1,13 +1,16 @@
 #include "GrowingLadder.hpp"
 #include "Ladder.hpp"
+#include "ResourceManager.hpp"
 #include "Tile.hpp"
 #include "World.hpp"
 
 GrowingLadder::GrowingLadder()
 {
+	static const ResourceId GROWING_LADDER_ANIMATION = ResourceManager::getResourceId("growing_ladder");
+
 	setGravityEnabled(false);
 	setSpriteCollisionsEnabled(false);
-	setAnimation("growing_ladder");
+	setAnimation(GROWING_LADDER_ANIMATION);
 	setYVelocity(GROWING_LADDER_SPEED);
 }
 
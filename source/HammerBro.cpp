@@ -1,7 +1,9 @@
 #include "Block.hpp"
 #include "HammerBro.hpp"
+#include "ObjectPool.hpp"
 #include "Player.hpp"
 #include "Random.hpp"
+#include "ResourceManager.hpp"
 #include "World.hpp"
 
 /**
@@ -12,12 +14,16 @@ class Hammer : public Sprite
 public:
 	Hammer()
 	{
+		static const ResourceId HAMMER_ANIMATION = ResourceManager::getResourceId("hammer");
+
 		setTileCollisionsEnabled(false);
-		setAnimation("hammer");
+		setAnimation(HAMMER_ANIMATION);
 		setGravityEnabled(false);
 		setYAcceleration(HammerBro::GRAVITY);
 	}
 
+	DECLARE_POOLED_ALLOCATION()
+
 private:
 	void onCollision( Sprite& sprite, Edge edge )
 	{
@@ -29,10 +35,14 @@ private:
 	}
 };
 
+DEFINE_POOLED_ALLOCATION(Hammer)
+
 HammerBro::HammerBro() :
 	jumpTimer(JUMP_WAIT_TIME),
 	moveTimer(MOVE_DURATION)
 {
+	static const ResourceId HAMMER_BRO_ANIMATION = ResourceManager::getResourceId("hammer_bro");
+
 	setWidth(WIDTH);
 	setHeight(HEIGHT);
 
@@ -43,11 +53,14 @@ HammerBro::HammerBro() :
 
 	setXVelocity(-1 * MOVEMENT_SPEED);
 
-	setAnimation("hammer_bro");
+	setAnimation(HAMMER_BRO_ANIMATION);
 }
 
 void HammerBro::onPreUpdate()
 {
+	static const ResourceId HAMMER_BRO_ANIMATION = ResourceManager::getResourceId("hammer_bro");
+	static const ResourceId HAMMER_BRO_THROW_ANIMATION = ResourceManager::getResourceId("hammer_bro_throw");
+
 	// Handle movement
 	if( moveTimer > 0 )
 	{
@@ -106,7 +119,7 @@ void HammerBro::onPreUpdate()
 		Hammer* hammer = nullptr;
 		if( getWorld().getRandom().nextInt() % 60 == 0 )
 		{
-			playAnimation("hammer_bro_throw", "hammer_bro");
+			playAnimation(HAMMER_BRO_THROW_ANIMATION, HAMMER_BRO_ANIMATION);
 			hammer = new Hammer;
 			hammer->setCenterX(getCenterX());
 			hammer->setBottom(getTop());
@@ -0,0 +1,71 @@
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "HeadlessAllocations.hpp"
+#include "World.hpp"
+
+static std::atomic<long long> collisionHeapAllocations(0); /**< The number of heap allocations made while testing collisions. */
+
+long long getCollisionHeapAllocationCount()
+{
+	return collisionHeapAllocations;
+}
+
+void* operator new( std::size_t size )
+{
+	if( World::isResolvingCollisions() )
+	{
+		collisionHeapAllocations++;
+	}
+
+	void* memory = std::malloc(size == 0 ? 1 : size);
+	if( memory == nullptr )
+	{
+		throw std::bad_alloc();
+	}
+	return memory;
+}
+
+// The other forms are replaced too, so that every allocation is counted and freed the same way
+void* operator new[]( std::size_t size )
+{
+	return operator new(size);
+}
+
+void* operator new( std::size_t size, const std::nothrow_t& ) noexcept
+{
+	try
+	{
+		return operator new(size);
+	}
+	catch( std::bad_alloc& )
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[]( std::size_t size, const std::nothrow_t& ) noexcept
+{
+	return operator new(size, std::nothrow);
+}
+
+void operator delete( void* memory ) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[]( void* memory ) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete( void* memory, const std::nothrow_t& ) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[]( void* memory, const std::nothrow_t& ) noexcept
+{
+	std::free(memory);
+}
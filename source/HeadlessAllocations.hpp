@@ -0,0 +1,15 @@
+/**
+ * @file
+ * @brief defines the heap allocation hook of the headless simulator.
+ */
+#ifndef HEADLESSALLOCATIONS_HPP
+#define HEADLESSALLOCATIONS_HPP
+
+/**
+ * Get the number of heap allocations made while a World was testing a sprite
+ * for collisions. The global operator new is only replaced in the headless
+ * simulator, so the game itself pays nothing for counting them.
+ */
+long long getCollisionHeapAllocationCount();
+
+#endif // HEADLESSALLOCATIONS_HPP
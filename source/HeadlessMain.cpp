@@ -0,0 +1,555 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <IL/il.h>
+
+#include "Camera.hpp"
+#include "Coin.hpp"
+#include "Episode.hpp"
+#include "Exception.hpp"
+#include "Globals.hpp"
+#include "HeadlessAllocations.hpp"
+#include "InfinityState.hpp"
+#include "IniFile.hpp"
+#include "Level.hpp"
+#include "ObjectPool.hpp"
+#include "Player.hpp"
+#include "Random.hpp"
+#include "Replay.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Text.hpp"
+#include "World.hpp"
+
+// Level Generators
+#include "LevelGenerators/HillyLevelGenerator.hpp"
+#include "LevelGenerators/SimpleLevelGenerator.hpp"
+#include "LevelGenerators/TestLevelGenerator.hpp"
+
+#define VIEW_WIDTH (SETTINGS.getRenderedScreenWidth() / (double)UNIT_SIZE)
+#define VIEW_HEIGHT (SETTINGS.getRenderedScreenHeight() / (double)UNIT_SIZE)
+
+static const int THUMBNAIL_UNIT_SIZE = 4; /**< The size of a level unit in thumbnails, in pixels. */
+static const int WARMUP_FRAMES = 600; /**< Frames simulated before the collision buffers are considered warmed up. */
+
+/**
+ * Options for a headless simulation run.
+ */
+struct HeadlessOptions
+{
+	int frames;            /**< The number of fixed steps to simulate. */
+	int seed;              /**< The seed used to generate the level. */
+	std::string generator; /**< The name of the level generator to use. */
+	std::string replay;    /**< The replay file to play back, if any. */
+	std::string hashes;    /**< The file to write the per-frame state hashes to, if any. */
+	int threads;           /**< The number of update threads, or -1 to use the setting. */
+	std::string broadphase; /**< The sprite broadphase to use: grid, sweep, or both to compare them. */
+	int crowd;             /**< The number of extra coins scattered over the start of the level. */
+	std::string screenshot; /**< The file to save a software rendered picture of the final view to, if any. */
+	int thumbnails;        /**< The number of generated levels to save overview pictures of, instead of simulating. */
+	std::string bake;      /**< The resource pack file to bake the resources into, instead of simulating, if any. */
+};
+
+//=====================================================================
+// Initialization routines
+//=====================================================================
+
+// Prints usage information for the headless simulator
+static void printUsage( const char* program )
+{
+	std::cout << "Usage: " << program << " [--frames N] [--seed N] [--generator test|simple|hilly] [--replay FILE] [--hashes FILE] [--threads N]\n" <<
+		"       [--broadphase grid|sweep|both] [--crowd N] [--screenshot FILE] [--thumbnails N] [--bake FILE]\n";
+}
+
+// Parses command line arguments. Returns false if the program should exit.
+static bool parseArguments( int argc, char** argv, HeadlessOptions& options )
+{
+	for( int i = 1; i < argc; ++i )
+	{
+		bool hasValue = (i + 1 < argc);
+		if( std::strcmp(argv[i], "--frames") == 0 && hasValue )
+		{
+			options.frames = std::atoi(argv[++i]);
+		}
+		else if( std::strcmp(argv[i], "--seed") == 0 && hasValue )
+		{
+			options.seed = std::atoi(argv[++i]);
+		}
+		else if( std::strcmp(argv[i], "--generator") == 0 && hasValue )
+		{
+			options.generator = argv[++i];
+		}
+		else if( std::strcmp(argv[i], "--replay") == 0 && hasValue )
+		{
+			options.replay = argv[++i];
+		}
+		else if( std::strcmp(argv[i], "--hashes") == 0 && hasValue )
+		{
+			options.hashes = argv[++i];
+		}
+		else if( std::strcmp(argv[i], "--threads") == 0 && hasValue )
+		{
+			options.threads = std::atoi(argv[++i]);
+		}
+		else if( std::strcmp(argv[i], "--broadphase") == 0 && hasValue )
+		{
+			options.broadphase = argv[++i];
+		}
+		else if( std::strcmp(argv[i], "--crowd") == 0 && hasValue )
+		{
+			options.crowd = std::atoi(argv[++i]);
+		}
+		else if( std::strcmp(argv[i], "--screenshot") == 0 && hasValue )
+		{
+			options.screenshot = argv[++i];
+		}
+		else if( std::strcmp(argv[i], "--thumbnails") == 0 && hasValue )
+		{
+			options.thumbnails = std::atoi(argv[++i]);
+		}
+		else if( std::strcmp(argv[i], "--bake") == 0 && hasValue )
+		{
+			options.bake = argv[++i];
+		}
+		else
+		{
+			printUsage(argv[0]);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Loads the settings that affect the simulation from the INI file
+static void loadSettings()
+{
+	SETTINGS.headless = true;
+	SETTINGS.sound = false;
+	SETTINGS.music = false;
+	SETTINGS.debugMode = false;
+
+	// The screen size determines how much of the level is spawned around the player
+	IniFile file;
+	file.load(SETTINGS_FILE_NAME);
+	std::string value;
+	if( file.getValue("screenWidth", value) )
+	{
+		SETTINGS.screenWidth = std::atoi(value.c_str());
+	}
+	if( file.getValue("screenHeight", value) )
+	{
+		SETTINGS.screenHeight = std::atoi(value.c_str());
+	}
+	if( file.getValue("updateThreads", value) )
+	{
+		SETTINGS.updateThreads = std::atoi(value.c_str());
+	}
+	if( file.getValue("tileMaps", value) )
+	{
+		SETTINGS.tileMaps = std::atoi(value.c_str()) != 0;
+	}
+	file.getValue("resourcePack", SETTINGS.resourcePack);
+	SETTINGS.calculateScale();
+
+	// The player needs a controller, even though no input is ever received
+	INPUT_MANAGER.addController(new InputManager::Controller());
+}
+
+//=====================================================================
+// Main procedures
+//=====================================================================
+
+// Creates the level generator with the given name
+static LevelGenerator* createGenerator( const std::string& name )
+{
+	if( name == "test" )
+	{
+		return new TestLevelGenerator;
+	}
+	else if( name == "simple" )
+	{
+		return new SimpleLevelGenerator;
+	}
+	else if( name == "hilly" )
+	{
+		return new HillyLevelGenerator;
+	}
+
+	throw Exception("Unknown level generator: ") << name;
+}
+
+// Renders a view of the world with the software renderer and saves it to a file
+static void saveWorldImage( World* world, double viewX, double viewY, double viewWidth, double viewHeight, int unitSize, const std::string& fileName )
+{
+	SoftwareRenderer renderer(std::ceil(viewWidth * unitSize), std::ceil(viewHeight * unitSize));
+	renderer.setView(0.0, 0.0, viewWidth, viewHeight);
+
+	SpriteBatch& batch = SPRITE_BATCH;
+	batch.setSoftwareRenderer(&renderer);
+	batch.loadIdentity();
+	world->render(viewX, viewY, viewWidth, viewHeight);
+	batch.finishFrame();
+	batch.setSoftwareRenderer(nullptr);
+
+	renderer.save(fileName);
+}
+
+// Generates levels and saves a picture of each whole level
+static void renderThumbnails( const HeadlessOptions& options )
+{
+	Singleton<GameSession>::createInstance();
+	GAME_SESSION.episode = new Episode();
+	GAME_SESSION.world = new World();
+	World* world = GAME_SESSION.world;
+	LevelGenerator* generator = createGenerator(options.generator);
+
+	auto startTime = std::chrono::steady_clock::now();
+	for( int i = 0; i < options.thumbnails; ++i )
+	{
+		int seed = options.seed + i;
+		Level* level = generator->generateLevel(seed);
+		Random random;
+		random.seed(seed);
+		level->setRandomTheme(random);
+		GAME_SESSION.episode->addLevel(i + 1, level);
+		world->setLevel(i + 1);
+
+		std::ostringstream fileName;
+		fileName << "thumbnail_" << options.generator << '_' << seed << ".png";
+		saveWorldImage(world, world->getWidth() / 2.0, world->getHeight() / 2.0, world->getWidth(), world->getHeight(), THUMBNAIL_UNIT_SIZE, fileName.str());
+	}
+	auto endTime = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(endTime - startTime).count();
+	LOG << "Rendered " << options.thumbnails << " level thumbnails in " << seconds << " seconds (" <<
+		(seconds > 0.0 ? options.thumbnails / seconds * 60.0 : 0.0) << " levels/minute).\n";
+
+	delete generator;
+	Singleton<GameSession>::destroyInstance();
+}
+
+// (Re)starts the level for the player, as MainState does
+static void startLevel( World* world, Player* player, int crowd = 0 )
+{
+	world->setLevel(1);
+	player->setLayer(1);
+	player->setCenterX(1.0);
+	player->setY(9.0);
+	player->reset();
+	world->addSprite(player);
+	world->setPlayer(player);
+
+	// Scatter coins like a multi-coin block does, to stress sprite collisions
+	Random& random = world->getRandom();
+	for( int i = 0; i < crowd; ++i )
+	{
+		Coin* coin = new Coin;
+		coin->setGravityEnabled(true);
+		coin->setCollisionsEnabled(true);
+		coin->setWidth(0.75);
+		coin->setXVelocity((random.nextReal() * 2.0 - 1.0) * 4.0);
+		coin->setCenterX(3.0 + random.nextReal() * VIEW_WIDTH);
+		coin->setBottom(world->getHeight() - 2.0 - random.nextReal() * 4.0);
+		world->addSprite(coin);
+	}
+}
+
+// Plays back a recorded replay, checking that every frame reproduces the recorded state
+static void playReplay( const HeadlessOptions& options )
+{
+	Replay replay;
+	if( !replay.load(options.replay) )
+	{
+		throw Exception("Failed to load replay: ") << options.replay;
+	}
+
+	// Sprites are spawned and scheduled by their distance from the view, so
+	// the view has to be the size it was when recording
+	if( replay.getViewWidth() > 0 && replay.getViewHeight() > 0 )
+	{
+		SETTINGS.screenWidth = replay.getViewWidth();
+		SETTINGS.screenHeight = replay.getViewHeight();
+		SETTINGS.scale = 1;
+	}
+
+	std::ofstream hashFile;
+	if( !options.hashes.empty() )
+	{
+		hashFile.open(options.hashes.c_str());
+	}
+
+	Singleton<GameSession>::createInstance();
+	GAME_SESSION.episode = new Episode();
+	GAME_SESSION.world = new World();
+	GAME_SESSION.player = new Player(0);
+	World* world = GAME_SESSION.world;
+	Player* player = GAME_SESSION.player;
+	InputManager::Controller* controller = INPUT_MANAGER.getController(0);
+
+	// Recreate the level and the attempt as they were recorded
+	GAME_SESSION.episode->addLevel(1, InfinityState::generateLevel(replay.getLevelSeed()));
+	world->getRandom().seed(replay.getWorldSeed());
+	startLevel(world, player);
+	player->setState(static_cast<Player::State>(replay.getPlayerState()));
+	controller->addListener(*player);
+
+	int mismatchFrame = -1;
+	auto startTime = std::chrono::steady_clock::now();
+	for( int frame = 0; frame < replay.getFrameCount(); ++frame )
+	{
+		replay.playFrame(frame, *controller);
+
+		if( world->getTime() == 0 )
+		{
+			player->takeDamage(true);
+		}
+
+		// The World isn't updated on paused frames, but the buttons still change
+		if( !replay.isFramePaused(frame) )
+		{
+			world->update(GAME_DELTA);
+		}
+
+		unsigned int hash = world->getStateHash();
+		if( hashFile.is_open() )
+		{
+			hashFile << frame << ' ' << std::hex << hash << std::dec << '\n';
+		}
+		if( mismatchFrame == -1 && hash != replay.getHash(frame) )
+		{
+			mismatchFrame = frame;
+		}
+
+		const Vector2<double>& cameraPosition = player->getCamera().getPosition();
+		world->spawnSprites(cameraPosition.x, cameraPosition.y, VIEW_WIDTH, VIEW_HEIGHT);
+	}
+	auto endTime = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(endTime - startTime).count();
+	LOG << "Replayed " << replay.getFrameCount() << " frames in " << seconds << " seconds.\n";
+	if( mismatchFrame == -1 )
+	{
+		LOG << "All frame hashes matched the recording.\n";
+	}
+	else
+	{
+		LOG << "Frame hashes diverged from the recording at frame " << mismatchFrame << ".\n";
+	}
+
+	if( !options.screenshot.empty() )
+	{
+		const Vector2<double>& cameraPosition = player->getCamera().getPosition();
+		saveWorldImage(world, cameraPosition.x, cameraPosition.y, VIEW_WIDTH, VIEW_HEIGHT, UNIT_SIZE, options.screenshot);
+	}
+
+	controller->removeListener(*player);
+	world->removeSprite(player);
+	Singleton<GameSession>::destroyInstance();
+}
+
+// Runs the fixed-step simulation loop and reports its throughput
+static void simulate( const HeadlessOptions& options, SpriteBroadphase broadphase )
+{
+	Singleton<GameSession>::createInstance();
+	GAME_SESSION.episode = new Episode();
+	GAME_SESSION.world = new World();
+	GAME_SESSION.player = new Player(0);
+	World* world = GAME_SESSION.world;
+	Player* player = GAME_SESSION.player;
+	world->setSpriteBroadphase(broadphase);
+
+	// Generate the level
+	LevelGenerator* generator = createGenerator(options.generator);
+	Level* level = generator->generateLevel(options.seed);
+	delete generator;
+	Random random;
+	random.seed(options.seed);
+	level->setRandomTheme(random);
+	GAME_SESSION.episode->addLevel(1, level);
+
+	std::ofstream hashFile;
+	if( !options.hashes.empty() )
+	{
+		hashFile.open(options.hashes.c_str());
+	}
+
+	// Seed the world too, so that runs with the same options are identical
+	world->getRandom().seed(options.seed);
+	startLevel(world, player, options.crowd);
+
+	int restarts = 0;
+	int warmupCollisionAllocations = 0;
+	long long startHeapAllocations = getCollisionHeapAllocationCount();
+	long long warmupHeapAllocations = startHeapAllocations;
+	auto startTime = std::chrono::steady_clock::now();
+	for( int frame = 0; frame < options.frames; ++frame )
+	{
+		if( frame == WARMUP_FRAMES )
+		{
+			warmupCollisionAllocations = world->getCollisionAllocationCount();
+			warmupHeapAllocations = getCollisionHeapAllocationCount();
+		}
+
+		if( world->getTime() == 0 )
+		{
+			player->takeDamage(true);
+		}
+
+		if( player->isDead() || world->getStatus().statusType == WORLD_LEVEL_ENDED )
+		{
+			world->removeSprite(player);
+			startLevel(world, player, options.crowd);
+			++restarts;
+		}
+
+		world->update(GAME_DELTA);
+		if( hashFile.is_open() )
+		{
+			hashFile << frame << ' ' << std::hex << world->getStateHash() << std::dec << '\n';
+		}
+
+		// Nothing is rendered, so sprites must be spawned explicitly
+		const Vector2<double>& cameraPosition = player->getCamera().getPosition();
+		world->spawnSprites(cameraPosition.x, cameraPosition.y, VIEW_WIDTH, VIEW_HEIGHT);
+	}
+	auto endTime = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(endTime - startTime).count();
+	LOG << "Simulated " << options.frames << " frames in " << seconds << " seconds (" <<
+		(seconds > 0.0 ? options.frames / seconds : 0.0) << " frames/sec, " << restarts << " level restarts).\n";
+	if( options.frames > WARMUP_FRAMES )
+	{
+		LOG << "Collision buffers allocated " << world->getCollisionAllocationCount() << " times, " <<
+			(world->getCollisionAllocationCount() - warmupCollisionAllocations) << " after the first " << WARMUP_FRAMES << " frames.\n";
+
+		// Once the buffers are warmed up, resolving collisions must not touch the heap at all
+		long long steadyHeapAllocations = getCollisionHeapAllocationCount() - warmupHeapAllocations;
+		LOG << "Collisions made " << (getCollisionHeapAllocationCount() - startHeapAllocations) << " heap allocations, " <<
+			steadyHeapAllocations << " after the first " << WARMUP_FRAMES << " frames.\n";
+		if( steadyHeapAllocations != 0 )
+		{
+			throw Exception() << "Collisions made " << steadyHeapAllocations << " heap allocations after warming up.";
+		}
+	}
+	LOG << "Tested " << world->getSpritePairTestCount() << " sprite pairs (" <<
+		(options.frames > 0 ? world->getSpritePairTestCount() / (double)options.frames : 0.0) << " per frame) using the " <<
+		(broadphase == BROADPHASE_GRID ? "grid" : "sweep") << " broadphase.\n";
+	for( auto pool : ObjectPool::getPools() )
+	{
+		LOG << "Pool " << pool->getName() << ": " << pool->getLiveCount() << " live, " <<
+			pool->getHighWaterMark() << " peak, " << pool->getCapacity() << " capacity.\n";
+	}
+	LOG << "All pools: " << ObjectPool::getTotalLiveCount() << " live, " << ObjectPool::getTotalHighWaterMark() << " peak.\n";
+
+	if( !options.screenshot.empty() )
+	{
+		const Vector2<double>& cameraPosition = player->getCamera().getPosition();
+		saveWorldImage(world, cameraPosition.x, cameraPosition.y, VIEW_WIDTH, VIEW_HEIGHT, UNIT_SIZE, options.screenshot);
+	}
+
+	world->removeSprite(player);
+	Singleton<GameSession>::destroyInstance();
+}
+
+/**
+ * Program entry point for the headless simulator.
+ */
+int main( int argc, char** argv )
+{
+	HeadlessOptions options;
+	options.frames = 10000;
+	options.seed = 0;
+	options.generator = "test";
+	options.threads = -1;
+	options.broadphase = "sweep";
+	options.crowd = 0;
+	options.thumbnails = 0;
+	if( !parseArguments(argc, argv, options) )
+	{
+		return 1;
+	}
+
+	ilInit();
+
+	createGlobals();
+
+	LOG << "Started headless simulation." << std::endl;
+
+	int exitCode = 0;
+	try
+	{
+		loadSettings();
+		if( options.threads != -1 )
+		{
+			SETTINGS.updateThreads = options.threads;
+		}
+		auto loadStartTime = std::chrono::steady_clock::now();
+		if( !options.bake.empty() )
+		{
+			if( !RESOURCE_MANAGER.bakeResources("resources.xml", options.bake) )
+			{
+				exitCode = 1;
+			}
+		}
+		else
+		{
+			RESOURCE_MANAGER.loadResources("resources.xml");
+		}
+		auto loadEndTime = std::chrono::steady_clock::now();
+		LOG << "Loaded resources in " << std::chrono::duration<double>(loadEndTime - loadStartTime).count() << " seconds.\n";
+
+		createTextTextures();
+		if( !options.bake.empty() )
+		{
+			// Baking only loads the resources
+		}
+		else if( options.thumbnails > 0 )
+		{
+			renderThumbnails(options);
+		}
+		else if( !options.replay.empty() )
+		{
+			playReplay(options);
+		}
+		else if( options.broadphase == "grid" )
+		{
+			simulate(options, BROADPHASE_GRID);
+		}
+		else if( options.broadphase == "sweep" )
+		{
+			simulate(options, BROADPHASE_SWEEP);
+		}
+		else if( options.broadphase == "both" )
+		{
+			// Run the same simulation with each broadphase to compare them
+			simulate(options, BROADPHASE_GRID);
+			simulate(options, BROADPHASE_SWEEP);
+		}
+		else
+		{
+			throw Exception("Unknown broadphase: ") << options.broadphase;
+		}
+	}
+	catch( std::exception& e )
+	{
+		LOG << "Fatal error: Unhandled exception caught at main():\n\"" << e.what() << "\"\n";
+		exitCode = 1;
+	}
+	catch( ... )
+	{
+		LOG << "Fatal error: Unknown exception caught at main()...\n";
+		exitCode = 1;
+	}
+
+	freeTextTextures();
+	destroyGlobals();
+
+	return exitCode;
+}
@@ -1,10 +1,47 @@
+#include <cstring>
+#include <mutex>
+
 #include <IL/il.h>
 #include <IL/ilu.h>
+#include <png.h>
 
 #include "Exception.hpp"
 #include "Font.hpp"
 #include "Image.hpp"
 
+static std::mutex devilMutex; /**< DevIL keeps the bound image in global state, so only one thread can use it at a time. */
+
+/**
+ * Decode a PNG file with libpng. Unlike DevIL, libpng keeps no global
+ * state, so any number of threads can decode at once.
+ *
+ * @return the pixels, row by row from the top, or nullptr if the file
+ * isn't a PNG that libpng can read.
+ */
+static Color* loadPng( const std::string& fileName, int& width, int& height )
+{
+	png_image png;
+	std::memset(&png, 0, sizeof(png));
+	png.version = PNG_IMAGE_VERSION;
+	if( !png_image_begin_read_from_file(&png, fileName.c_str()) )
+	{
+		return nullptr;
+	}
+
+	png.format = PNG_FORMAT_RGBA;
+	Color* pixels = new Color[png.width * png.height];
+	if( !png_image_finish_read(&png, nullptr, pixels, 0, nullptr) )
+	{
+		png_image_free(&png);
+		delete [] pixels;
+		return nullptr;
+	}
+
+	width = png.width;
+	height = png.height;
+	return pixels;
+}
+
 Image::Image(int width, int height) :
 	width(width),
 	height(height)
@@ -20,6 +57,15 @@ Image::Image(int width, int height) :
 
 Image::Image(const std::string& fileName)
 {
+	pixels = loadPng(fileName, width, height);
+	if( pixels != nullptr )
+	{
+		return;
+	}
+
+	// Everything else goes through DevIL, one image at a time
+	std::lock_guard<std::mutex> lock(devilMutex);
+
 	ILboolean success;
 	ILuint texId = ilGenImage();
 	ilBindImage(texId);
@@ -76,6 +122,16 @@ Color Image::getPixel(int x, int y) const
 	return pixels[y * width + x];
 }
 
+Color* Image::getPixels()
+{
+	return pixels;
+}
+
+const Color* Image::getPixels() const
+{
+	return pixels;
+}
+
 int Image::getWidth() const
 {
 	return width;
@@ -83,6 +139,8 @@ int Image::getWidth() const
 
 void Image::save(const std::string& fileName)
 {
+	std::lock_guard<std::mutex> lock(devilMutex);
+
 	ILuint texId = ilGenImage();
 	ilBindImage(texId);
 
@@ -20,7 +20,9 @@ public:
 	Image(int width, int height);
 
 	/**
-	 * Load an image from a file.
+	 * Load an image from a file. Images can be loaded on any thread. PNG
+	 * files are decoded by libpng on every thread at once, and any other
+	 * format by DevIL, one image at a time.
 	 *
 	 * @param fileName the name of the file to load from.
 	 */
@@ -51,6 +53,16 @@ public:
 	 */
 	Color getPixel(int x, int y) const;
 
+	/**
+	 * Get the pixel array of the Image, stored row by row from the top.
+	 */
+	Color* getPixels();
+
+	/**
+	 * Get the pixel array of the Image, stored row by row from the top.
+	 */
+	const Color* getPixels() const;
+
 	/**
 	 * Get the width of the image.
 	 */
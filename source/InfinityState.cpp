@@ -8,6 +8,7 @@
 #include "InfinityState.hpp"
 #include "Player.hpp"
 #include "Rendering.hpp"
+#include "Replay.hpp"
 #include "TransitionState.hpp"
 #include "World.hpp"
 
@@ -40,47 +41,55 @@ InfinityState::~InfinityState()
 	Singleton<GameSession>::destroyInstance();
 }
 
-void InfinityState::generateNewLevel()
+Level* InfinityState::generateLevel( unsigned int seed )
 {
-	// Clear the episode
-	delete GAME_SESSION.episode;
-	GAME_SESSION.episode = new Episode();
-
-	// Generate a new level
 	std::vector<LevelGenerator*> generators;
 	//generators.push_back(new SimpleLevelGenerator);
 	//generators.push_back(new HillyLevelGenerator);
 	//generators.push_back(new SmbLevelLoader);
 	generators.push_back(new TestLevelGenerator);
 	Random random;
-	random.seedTime();
-	const std::vector<LevelTheme*>& themes = RESOURCE_MANAGER.getLevelThemes();
+	random.seed(seed);
 
 	// Pick a suitable combination theme and level generator
 	const LevelGenerator& generator = *generators[random.nextInt() % generators.size()];
 	Level* level = generator.generateLevel(random.nextInt());
-	while( true )
+	level->setRandomTheme(random);
+
+	for( auto g : generators )
 	{
-		const LevelTheme& theme = *themes[random.nextInt(themes.size())];
-		if( !level->isThemeCompatible(theme) )
-		{
-			continue;
-		}
-		level->setTheme(theme, random);
-		GAME_SESSION.episode->addLevel(1, level);
-		break;
+		delete g;
 	}
 
-	levelNumber++;
+	return level;
+}
 
-	for( auto g : generators )
+void InfinityState::generateNewLevel()
+{
+	// Clear the episode
+	delete GAME_SESSION.episode;
+	GAME_SESSION.episode = new Episode();
+
+	// Generate a new level from a single seed, so that it can be recreated for replays
+	Random random;
+	random.seedTime();
+	unsigned int levelSeed = random.nextUnsigned();
+	GAME_SESSION.episode->addLevel(1, generateLevel(levelSeed));
+
+	delete GAME_SESSION.replay;
+	GAME_SESSION.replay = nullptr;
+	if( SETTINGS.recordReplays )
 	{
-		delete g;
+		GAME_SESSION.replay = new Replay(levelSeed);
 	}
+
+	levelNumber++;
 }
 
 void InfinityState::input()
 {
+	static const ResourceId LEVEL_ENTER_SOUND = ResourceManager::getResourceId("level_enter");
+
 	SDL_Event event;
 	while( SDL_PollEvent(&event) )
 	{
@@ -115,7 +124,7 @@ void InfinityState::input()
 	if( controller->getButtonState(BUTTON_A) || controller->getButtonState(BUTTON_START) )
 	{
 		fadeOutProgress = 1;
-		PLAY_SOUND("level_enter");
+		PLAY_SOUND(LEVEL_ENTER_SOUND);
 		///@todo stop music here if there is any playing
 	}
 }
@@ -140,9 +149,9 @@ void InfinityState::render()
 	// Draw status information
 	auto font = GET_FONT("font_bold");
 	std::string text = "Infinity Mode";
-	glTranslatef( renderGetScreenWidth() / 2 - font->getTextWidth(text) / 2, renderGetScreenHeight() * 2.0f / 3.0f, 0.0f);
+	SPRITE_BATCH.translate( renderGetScreenWidth() / 2 - font->getTextWidth(text) / 2, renderGetScreenHeight() * 2.0 / 3.0 );
 	font->renderText(text);
-	glTranslatef( 0.0f, -2.0f * font->getCharacterHeight(), 0.0f );
+	SPRITE_BATCH.translate( 0.0, -2.0 * font->getCharacterHeight() );
 	char buffer[128];
 	sprintf( buffer, "Level %d\nLives %d\nScore %d\n\nPress Any Button", levelNumber, GAME_SESSION.player->getLives(), GAME_SESSION.player->getScore() );
 	font->renderText(buffer);
@@ -162,21 +171,16 @@ void InfinityState::render()
 			fade = fadeOutProgress / (double)FADE_DURATION;
 		}
 
+		SPRITE_BATCH.flush();
 		glClear(GL_DEPTH_BUFFER_BIT);
 		glMatrixMode(GL_PROJECTION);
 		glLoadIdentity();
 		glOrtho(0, 1, 0, 1, -1, 1);
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		glDisable(GL_TEXTURE_2D);
-
-		glColor4f(0.0f, 0.0f, 0.0f, fade);
-		glBegin(GL_QUADS);
-			glVertex2i(0, 0);
-			glVertex2i(1, 0);
-			glVertex2i(1, 1);
-			glVertex2i(0, 1);
-		glEnd();
+
+		SPRITE_BATCH.loadIdentity();
+		SPRITE_BATCH.drawQuad(0.0, 0.0, 1.0, 1.0, Color(0, 0, 0, static_cast<ubyte>(fade * 255.0)));
 	}
 
 	renderSwapBuffers();
@@ -3,6 +3,8 @@
 
 #include "GameState.hpp"
 
+class Level;
+
 /**
  * The game state that manages infinity mode.
  */
@@ -12,6 +14,11 @@ public:
 	InfinityState();
 	~InfinityState();
 
+	/**
+	 * Generate an infinity mode level. The same seed always generates the same level.
+	 */
+	static Level* generateLevel( unsigned int seed );
+
 	void update();
 
 private:
@@ -48,6 +48,18 @@ void InputManager::Controller::removeListener( ControllerListener& listener )
 	listeners.remove(&listener);
 }
 
+void InputManager::Controller::setButtonState( InputButton button, bool pressed )
+{
+	if( pressed != buttonStates[button] )
+	{
+		for( auto l : listeners )
+		{
+			l->onButtonToggle( button, pressed );
+		}
+	}
+	buttonStates[button] = pressed;
+}
+
 InputManager::InputManager()
 {
 	// Open all joysticks for use
@@ -122,14 +134,7 @@ void InputManager::update()
 				state = (SDL_JoystickGetButton(joysticks[b.joystick], b.button) != 0);
 			}
 
-			if( state != c->buttonStates[i] )
-			{
-				for( auto l : c->listeners )
-				{
-					l->onButtonToggle( static_cast<InputButton>(i), state );
-				}
-			}
-			c->buttonStates[i] = state;
+			c->setButtonState( static_cast<InputButton>(i), state );
 		}
 	}
 }
@@ -88,6 +88,11 @@ public:
 		 */
 		void removeListener( ControllerListener& listener );
 
+		/**
+		 * Set the state of a button, notifying listeners if it changed.
+		 */
+		void setButtonState( InputButton button, bool pressed );
+
 	private:
 		enum ButtonMappingType
 		{
@@ -5,11 +5,13 @@
 
 Koopa::Koopa()
 {
+	static const ResourceId KOOPA_ANIMATION = ResourceManager::getResourceId("koopa");
+
 	setDefaultXVelocity(-1.0 * MOVEMENT_SPEED);
 	setWidth(WIDTH);
 	setHeight(HEIGHT);
 
-	setAnimation("koopa");
+	setAnimation(KOOPA_ANIMATION);
 }
 
 void Koopa::onBump()
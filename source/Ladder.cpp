@@ -1,4 +1,5 @@
 #include "Ladder.hpp"
+#include "ResourceManager.hpp"
 
 Ladder::Ladder() :
 	Tile(TILE_NONE)
@@ -7,5 +8,7 @@ Ladder::Ladder() :
 
 void Ladder::onInit()
 {
-	setAnimation("ladder");
+	static const ResourceId LADDER_ANIMATION = ResourceManager::getResourceId("ladder");
+
+	setAnimation(LADDER_ANIMATION);
 }
@@ -2,6 +2,7 @@
 #include "Particle.hpp"
 #include "Player.hpp"
 #include "Random.hpp"
+#include "ResourceManager.hpp"
 #include "Spiny.hpp"
 #include "World.hpp"
 
@@ -15,7 +16,9 @@ public:
 
 	SpinyEgg()
 	{
-		setAnimation("spiny_egg");
+		static const ResourceId SPINY_EGG_ANIMATION = ResourceManager::getResourceId("spiny_egg");
+
+		setAnimation(SPINY_EGG_ANIMATION);
 		setFireproof(true);
 		setStompable(false);
 		setGravityEnabled(false);
@@ -41,13 +44,20 @@ private:
 Lakitu::Lakitu() :
 	throwTimer(0)
 {
+	static const ResourceId LAKITU_ANIMATION = ResourceManager::getResourceId("lakitu");
+
 	setBounceOffEnemiesEnabled(false);
 	setGravityEnabled(false);
-	setAnimation("lakitu");
+	setAnimation(LAKITU_ANIMATION);
+	setActivityPolicy(ACTIVITY_ALWAYS); // Always chase the player
 }
 
 void Lakitu::onPreUpdate()
 {
+	static const ResourceId LAKITU_ANIMATION = ResourceManager::getResourceId("lakitu");
+	static const ResourceId LAKITU_DUCKING_ANIMATION = ResourceManager::getResourceId("lakitu_ducking");
+	static const ResourceId LAKITU_THROWING_ANIMATION = ResourceManager::getResourceId("lakitu_throwing");
+
 	// Get the player that we are following
 	Player* player = getWorld().getPlayer();
 	if( player == nullptr )
@@ -78,7 +88,7 @@ void Lakitu::onPreUpdate()
 			egg->setYVelocity( 12.0 );
 			getWorld().addSprite( egg );
 
-			setAnimation("lakitu");
+			setAnimation(LAKITU_ANIMATION);
 		}
 	}
 	else
@@ -87,7 +97,7 @@ void Lakitu::onPreUpdate()
 		if( getWorld().getRandom().nextInt() % 120 == 0 )
 		{
 			throwTimer = THROW_DURATION;
-			playAnimation("lakitu_ducking", "lakitu_throwing");
+			playAnimation(LAKITU_DUCKING_ANIMATION, LAKITU_THROWING_ANIMATION);
 		}
 	}
 }
@@ -1,6 +1,9 @@
 #include "Leaf.hpp"
+#include "ResourceManager.hpp"
 
 Leaf::Leaf()
 {
-	setAnimation("leaf");
+	static const ResourceId LEAF_ANIMATION = ResourceManager::getResourceId("leaf");
+
+	setAnimation(LEAF_ANIMATION);
 }
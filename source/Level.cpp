@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 
 #include "Level.hpp"
@@ -404,6 +405,20 @@ void Level::setMusic( const Music* music )
 	this->music = music;
 }
 
+void Level::setRandomTheme( Random& random )
+{
+	const std::vector<LevelTheme*>& themes = RESOURCE_MANAGER.getLevelThemes();
+	while( true )
+	{
+		const LevelTheme& theme = *themes[random.nextInt(themes.size())];
+		if( isThemeCompatible(theme) )
+		{
+			setTheme(theme, random);
+			break;
+		}
+	}
+}
+
 void Level::setSpriteData( int spriteId, const std::string& key, int value )
 {
 	///@todo error checking
@@ -419,8 +434,10 @@ void Level::setSpriteData( int spriteId, const std::string& key, const std::stri
 void Level::setTheme( const LevelTheme& theme, Random& random )
 {
 	// Set the background and the music
+	// Music is always drawn from the random source so that levels are identical when audio is not loaded
 	setBackground( theme.backgrounds[random.nextInt(theme.backgrounds.size())] );
-	setMusic( theme.musics[random.nextInt(theme.musics.size()) ] );
+	int musicIndex = random.nextInt( std::max<int>(theme.musics.size(), 1) );
+	setMusic( theme.musics.empty() ? nullptr : theme.musics[musicIndex] );
 
 	// Set the theme for sprites
 	for( auto& sprite : sprites )
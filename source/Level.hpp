@@ -131,6 +131,14 @@ public:
 	 */
 	void setTheme( const LevelTheme& theme, Random& random );
 
+	/**
+	 * Set the theme used by the Level to a random LevelTheme that is
+	 * compatible with it.
+	 *
+	 * @param random the source of randomness for picking the theme and themed items.
+	 */
+	void setRandomTheme( Random& random );
+
 	/**
 	 * Set data used to create a tile.
 	 *
@@ -6,8 +6,11 @@
 
 LevelEnd::LevelEnd()
 {
-	setAnimation("level_end_block");
+	static const ResourceId LEVEL_END_BLOCK_ANIMATION = ResourceManager::getResourceId("level_end_block");
+
+	setAnimation(LEVEL_END_BLOCK_ANIMATION);
 	setGravityEnabled(false);
+	setActivityPolicy(ACTIVITY_SLEEP); // Sparkles are timed by the frame number, so don't skip frames
 }
 
 void LevelEnd::onPreUpdate()
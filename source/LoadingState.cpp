@@ -34,9 +34,8 @@ void LoadingState::onLog( const std::string& text )
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
 	glClear(GL_COLOR_BUFFER_BIT);
 	renderSetUnitsToPixels();
-	glTranslatef( 0, SETTINGS.getRenderedScreenHeight() - FONT_HEIGHT - 1, 0);
+	SPRITE_BATCH.translate( 0, SETTINGS.getRenderedScreenHeight() - FONT_HEIGHT - 1 );
 
-	glColor3ub(0xff, 0xff, 0xff);
 	char tempString[64];
 	char c = '|';
 	switch( (frame++ / 2) % 4 )
@@ -57,7 +56,7 @@ void LoadingState::onLog( const std::string& text )
 	sprintf(tempString, "Loading resources... %d%c", RESOURCE_MANAGER.getLoadingProgress(), c);
 	drawText(tempString);
 
-	SDL_GL_SwapWindow((SDL_Window*)window);
+	renderSwapBuffers();
 
 	lastRenderTime = SDL_GetTicks();
 }
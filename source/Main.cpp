@@ -12,6 +12,9 @@
 #include "Globals.hpp"
 #include "IniFile.hpp"
 #include "LoadingState.hpp"
+#include "Rendering.hpp"
+#include "Text.hpp"
+#include "TileMap.hpp"
 
 //=====================================================================
 // Initialization routines
@@ -35,6 +38,12 @@ bool convertString(const std::string& str)
 	return (convertString<int>(str) != 0);
 }
 
+template<>
+std::string convertString(const std::string& str)
+{
+	return str;
+}
+
 // Loads a setting from an INI file
 template <typename T>
 static void loadSetting(const IniFile& file, const std::string& key, T& setting)
@@ -65,23 +74,24 @@ static void loadSettings()
 	LOAD_SETTING(int, screenHeight);
 	LOAD_SETTING(bool, fullscreen);
 	//LOAD_SETTING(int, scale);
-	// Calculate scale automatically. Ideally, screenHeight / (16 * scale) should be as close to 14 as possible
-	int bestRatio = INT_MAX;
-	int scale;
-	for( scale = 1; scale < 16; scale++ )
-	{
-		int ratio = std::abs(SETTINGS.screenHeight / (16 * scale) - 14);
-		if( ratio > bestRatio )
-		{
-			scale--;
-			break;
-		}
-		bestRatio = ratio;
-	}
-	SETTINGS.scale = scale;
+	// Calculate scale automatically
+	SETTINGS.calculateScale();
 	LOAD_SETTING(bool, sound);
 	LOAD_SETTING(bool, music);
 	LOAD_SETTING(bool, debugMode);
+	LOAD_SETTING(bool, recordReplays);
+	LOAD_SETTING(bool, renderThread);
+	LOAD_SETTING(int, updateThreads);
+	LOAD_SETTING(bool, lowResolution);
+	LOAD_SETTING(bool, tileMaps);
+	LOAD_SETTING(bool, precisePacing);
+	LOAD_SETTING(std::string, frameTimeLog);
+	LOAD_SETTING(std::string, resourcePack);
+
+	if( !SETTINGS.frameTimeLog.empty() && !FPS_MANAGER.openFrameTimeLog(SETTINGS.frameTimeLog) )
+	{
+		LOG << "Failed to open the frame time log " << SETTINGS.frameTimeLog << ".\n";
+	}
 
 	///@todo load controller settings instead of hard-coding them here
 	InputManager::Controller* c = new InputManager::Controller();
@@ -182,10 +192,20 @@ int main( int argc, char** argv )
 		}
 
 		// Create the GL context
-		if( SDL_GL_CreateContext((SDL_Window*)window) == NULL )
+		glContext = SDL_GL_CreateContext((SDL_Window*)window);
+		if( glContext == NULL )
 		{
 			throw Exception("Failed to create the GL context!\nDetails:\n") << SDL_GetError();
 		}
+		createTextTextures();
+		if( SETTINGS.lowResolution && !renderCreateFramebuffer() )
+		{
+			LOG << "Framebuffers are not supported. Drawing at the window resolution instead.\n";
+		}
+		if( SETTINGS.tileMaps && !TileMap::createShader() )
+		{
+			LOG << "Shaders are not supported. Drawing tiles as quads instead.\n";
+		}
 
 		// Open Audio
 		if( Mix_OpenAudio(22050, AUDIO_S16, 2, 1024) )
@@ -209,6 +229,9 @@ int main( int argc, char** argv )
 
 	LOG << "Exited main loop." << std::endl;
 
+	TileMap::freeShader();
+	renderFreeFramebuffer();
+	freeTextTextures();
 	destroyGlobals();
 
 	// Unload libraries
@@ -1,4 +1,7 @@
 #include <boost/algorithm/string.hpp>
+#include <ctime>
+#include <fstream>
+#include <sstream>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
 
@@ -16,9 +19,13 @@
 #include "MainState.hpp"
 #include "Mushroom.hpp"
 #include "Music.hpp"
+#include "ObjectPool.hpp"
 #include "Player.hpp"
 #include "Random.hpp"
+#include "RenderSnapshot.hpp"
+#include "RenderThread.hpp"
 #include "Rendering.hpp"
+#include "Replay.hpp"
 #include "Shell.hpp"
 #include "Star.hpp"
 #include "Text.hpp"
@@ -28,6 +35,28 @@
 #define VIEW_WIDTH (SETTINGS.getRenderedScreenWidth() / (double)UNIT_SIZE)
 #define VIEW_HEIGHT (SETTINGS.getRenderedScreenHeight() / (double)UNIT_SIZE)
 
+/**
+ * Get the name of a replay file that doesn't exist yet. Attempts started in
+ * the same second have the same world seed, so a counter tells them apart.
+ */
+static std::string getReplayFileName( unsigned int worldSeed )
+{
+	for( int i = 0; ; ++i )
+	{
+		std::ostringstream fileName;
+		fileName << "replay_" << worldSeed;
+		if( i > 0 )
+		{
+			fileName << '_' << i;
+		}
+		fileName << ".bin";
+		if( !std::ifstream(fileName.str().c_str()) )
+		{
+			return fileName.str();
+		}
+	}
+}
+
 MainState::MainState(int level) :
 	GameState(true),
 	commandMode(false),
@@ -35,11 +64,34 @@ MainState::MainState(int level) :
 	deadPlayer(nullptr),
 	playerDeathHandled(false),
 	endTimer(0),
-	initialEndTimer(0)
+	initialEndTimer(0),
+	renderThread(nullptr)
 {
 	world = GAME_SESSION.world;
-	world->setLevel( level );
 	player = GAME_SESSION.player;
+
+	// Find the HUD resources once, rather than by name every frame
+	coinIndicator = GET_ANIMATION("coin_indicator");
+	font = GET_FONT("font_bold");
+	marioIndicator = GET_ANIMATION("mario_indicator");
+	pMeterBarEmpty = GET_ANIMATION("p_meter_bar_empty");
+	pMeterBarFull = GET_ANIMATION("p_meter_bar_full");
+	pMeterEmpty = GET_ANIMATION("p_meter_empty");
+	pMeterFull = GET_ANIMATION("p_meter_full");
+	reserveItemBox = GET_ANIMATION("reserve_item_box");
+	timeIndicator = GET_ANIMATION("time_indicator");
+	times = GET_ANIMATION("times");
+
+	// Seed the world explicitly so that the attempt can be replayed
+	Replay* replay = GAME_SESSION.replay;
+	if( replay != nullptr )
+	{
+		unsigned int worldSeed = static_cast<unsigned int>(time(NULL));
+		world->getRandom().seed(worldSeed);
+		replay->beginRecording(worldSeed, player->getState(), SETTINGS.getRenderedScreenWidth(), SETTINGS.getRenderedScreenHeight());
+	}
+
+	world->setLevel( level );
 	player->setLayer(1);
 	player->setCenterX(1.0);
 	player->setY(9.0);
@@ -48,13 +100,23 @@ MainState::MainState(int level) :
 	world->setPlayer(player);
 	world->playBackgroundMusic();
 	INPUT_MANAGER.getController(0)->addListener(*player);
+
+	if( SETTINGS.renderThread )
+	{
+		renderThread = new RenderThread;
+	}
 }
 
 MainState::~MainState()
 {
+	// Give the OpenGL context back before the next state renders
+	delete renderThread;
+
 	Mix_HaltMusic();
 	world->removeSprite(player);
 	INPUT_MANAGER.getController(0)->removeListener(*player);
+
+	saveReplay();
 }
 
 void MainState::executeCommand()
@@ -218,13 +280,16 @@ void MainState::render()
 {
 	static int frames = 0;
 
+	// Record the frame, to be presented by the render thread if there is one
+	RenderSnapshot& snapshot = (renderThread != nullptr) ? renderThread->beginSnapshot() : this->snapshot;
+	if( renderThread == nullptr )
+	{
+		snapshot.reset();
+	}
+
 	// Render the world
-	renderClearScreen();
-	glMatrixMode(GL_PROJECTION);
-	glLoadIdentity();
-	glOrtho(0.0, VIEW_WIDTH, 0.0, VIEW_HEIGHT, -10.0, 10.0);
-	glMatrixMode(GL_MODELVIEW);
-	glLoadIdentity();
+	snapshot.beginPass(VIEW_WIDTH, VIEW_HEIGHT);
+	snapshot.clearColor(Color(0, 0, 0, 0x7f));
 
 	const Camera& c = player->getCamera();
 	double renderX = c.getPosition().x;
@@ -234,43 +299,31 @@ void MainState::render()
 		renderX,
 		renderY,
 		VIEW_WIDTH,
-		VIEW_HEIGHT);
+		VIEW_HEIGHT,
+		&snapshot);
 
 	// Set projection units to pixels
-	glClear(GL_DEPTH_BUFFER_BIT);
-	renderSetUnitsToPixels();
+	snapshot.beginPass(SETTINGS.getRenderedScreenWidth(), SETTINGS.getRenderedScreenHeight());
+	snapshot.clearDepth();
 
 	// Render the HUD
-	const Animation* marioIndicator = GET_ANIMATION("mario_indicator");
-	const Animation* times = GET_ANIMATION("times");
-	const Animation* timeIndicator = GET_ANIMATION("time_indicator");
-	const Animation* coinIndicator = GET_ANIMATION("coin_indicator");
-	const Animation* pMeterBarEmpty = GET_ANIMATION("p_meter_bar_empty");
-	const Animation* pMeterBarFull = GET_ANIMATION("p_meter_bar_full");
-	const Animation* pMeterEmpty = GET_ANIMATION("p_meter_empty");
-	const Animation* pMeterFull = GET_ANIMATION("p_meter_full");
-	const Animation* reserveItemBox = GET_ANIMATION("reserve_item_box");
-	const BitmapFont* font = GET_FONT("font_bold");
-
-	glEnable(GL_TEXTURE_2D);
-	RESOURCE_MANAGER.bindTextureAtlas();
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+	SpriteBatch& batch = SPRITE_BATCH;
 
 	// Lives indicator
-	glTranslatef(font->getCharacterWidth(), SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 2.0, 0.0f);
+	batch.translate(font->getCharacterWidth(), SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 2.0);
 	Animation::Frame frame = marioIndicator->getFrame(world->getFrameNumber());
 	marioIndicator->renderFrame(frame);
-	glTranslatef(frame.width * UNIT_SIZE + font->getCharacterWidth(), 0.0f, 0.0f);
+	batch.translate(frame.width * UNIT_SIZE + font->getCharacterWidth(), 0.0);
 	frame = times->getFrame(world->getFrameNumber());
 	times->renderFrame(frame);
-	glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+	batch.translate(frame.width * UNIT_SIZE, 0.0);
 	char tempString[128];
 	sprintf(tempString, " %d", player->getLives());
 	font->renderText(tempString);
 
 	// P meter
-	glLoadIdentity();
-	glTranslatef(font->getCharacterWidth(), SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 3.0 - 1.0, 0.0f);
+	batch.loadIdentity();
+	batch.translate(font->getCharacterWidth(), SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 3.0 - 1.0);
 	for( int i = 0; i < Player::P_METER_FULL_BARS; i++ )
 	{
 		if( i == Player::P_METER_FULL_BARS - 1 )
@@ -296,90 +349,82 @@ void MainState::render()
 			pMeterBarFull->renderFrame(frame);
 		}
 
-		glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+		batch.translate(frame.width * UNIT_SIZE, 0.0);
 	}
 
 	// Reserve item box
-	glLoadIdentity();
+	batch.loadIdentity();
 	frame = reserveItemBox->getFrame(world->getFrameNumber());
-	glTranslatef(
+	batch.translate(
 		SETTINGS.getRenderedScreenWidth() / 2.0 - frame.width * UNIT_SIZE / 2.0,
-		SETTINGS.getRenderedScreenHeight() - frame.height * UNIT_SIZE - 4.0,
-		0.0f
-	);
+		SETTINGS.getRenderedScreenHeight() - frame.height * UNIT_SIZE - 4.0);
 	reserveItemBox->renderFrame(frame);
 	if( player->getReserveItem() != nullptr )
 	{
 		const Animation* a = player->getReserveItem()->getActiveAnimation();
 		Animation::Frame f = a->getFrame(world->getFrameNumber());
-		glTranslatef( (frame.width / 2.0 - f.width / 2.0) * UNIT_SIZE, (frame.height / 2.0 - f.height / 2.0) * UNIT_SIZE, 1.0f );
+		batch.translate( (frame.width / 2.0 - f.width / 2.0) * UNIT_SIZE, (frame.height / 2.0 - f.height / 2.0) * UNIT_SIZE, 1.0);
 		a->renderFrame(f);
 	}
 
 	// Time
 	if( world->getTime() != INFINITE_LEVEL_TIME )
 	{
-		glLoadIdentity();
-		glTranslatef(
+		batch.loadIdentity();
+		batch.translate(
 			SETTINGS.getRenderedScreenWidth() - font->getCharacterWidth() * 13.0,
-			SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 2.0,
-			0.0f
-		);
+			SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 2.0);
 		frame = timeIndicator->getFrame(world->getFrameNumber());
 		timeIndicator->renderFrame(frame);
-		glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+		batch.translate(frame.width * UNIT_SIZE, 0.0);
 		sprintf(tempString, "%d", world->getTime());
 		font->renderText(tempString);
 	}
 
 	// Coins and score
-	glLoadIdentity();
-	glTranslatef(
+	batch.loadIdentity();
+	batch.translate(
 		SETTINGS.getRenderedScreenWidth() - font->getCharacterWidth() * 6.0,
-		SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 2.0,
-		0.0f);
+		SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 2.0);
 	frame = coinIndicator->getFrame(world->getFrameNumber());
 	coinIndicator->renderFrame(frame);
-	glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+	batch.translate(frame.width * UNIT_SIZE, 0.0);
 	frame = times->getFrame(world->getFrameNumber());
 	times->renderFrame(frame);
-	glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+	batch.translate(frame.width * UNIT_SIZE, 0.0);
 	sprintf(tempString, " %2d", player->getCoins());
 	font->renderText(tempString);
-	glLoadIdentity();
-	glTranslatef(
+	batch.loadIdentity();
+	batch.translate(
 		SETTINGS.getRenderedScreenWidth() - font->getCharacterWidth() * 11.0,
-		SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 3.0 - 1.0,
-		0.0f);
+		SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 3.0 - 1.0);
 	sprintf(tempString, "%10d", player->getScore());
 	font->renderText(tempString);
 
 	// Stuff for if we finish a level
 	if( world->getStatus().statusType == WORLD_LEVEL_ENDED )
 	{
-		glLoadIdentity();
-		glTranslatef(
+		batch.loadIdentity();
+		batch.translate(
 			SETTINGS.getRenderedScreenWidth() / 2.0 - font->getCharacterWidth() * 6.0,
-			SETTINGS.getRenderedScreenHeight() / 2.0 + font->getCharacterHeight() * 3.0,
-			1.0f
-		);
+			SETTINGS.getRenderedScreenHeight() / 2.0 + font->getCharacterHeight() * 3.0, 1.0);
 		font->renderText("Level Cleared");
-		glTranslatef( 0.0f, -2.0 * font->getCharacterHeight(), 0.0f);
+		batch.translate( 0.0, -2.0 * font->getCharacterHeight());
 
 		if( world->getTime() != INFINITE_LEVEL_TIME && initialEndTimer - endTimer > 60 )
 		{
 			frame = timeIndicator->getFrame(world->getFrameNumber());
 			timeIndicator->renderFrame(frame);
-			glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+			batch.translate(frame.width * UNIT_SIZE, 0.0);
 
 
 			sprintf(tempString, "%d ", remainingTime);
 			font->renderText(tempString);
-			glTranslatef( strlen(tempString) * font->getCharacterWidth(), 0.0f, 0.0f);
+			batch.translate( strlen(tempString) * font->getCharacterWidth(), 0.0);
 
 			frame = times->getFrame(world->getFrameNumber());
 			times->renderFrame(frame);
-			glTranslatef(frame.width * UNIT_SIZE, 0.0f, 0.0f);
+			batch.translate(frame.width * UNIT_SIZE, 0.0);
 
 			sprintf(tempString, " 50 = %d", remainingTime * 50);
 			font->renderText(tempString);
@@ -389,72 +434,80 @@ void MainState::render()
 	// Fade out effect
 	if( endTimer != 0 && endTimer < 60 )
 	{
-		glClear(GL_DEPTH_BUFFER_BIT);
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		glOrtho(0, 1, 0, 1, -1, 1);
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glDisable(GL_TEXTURE_2D);
-
-		glColor4f(0.0f, 0.0f, 0.0f, (60 - endTimer) / 60.0f);
-		glBegin(GL_QUADS);
-			glVertex2i(0, 0);
-			glVertex2i(1, 0);
-			glVertex2i(1, 1);
-			glVertex2i(0, 1);
-		glEnd();
+		snapshot.beginPass(1.0, 1.0);
+		snapshot.clearDepth();
+		batch.drawQuad(0.0, 0.0, 1.0, 1.0, Color(0, 0, 0, static_cast<ubyte>((60 - endTimer) / 60.0f * 255.0f)));
 	}
 
 	// Render debug stuff
-	glDisable(GL_TEXTURE_2D);
 	if( SETTINGS.debugMode )
 	{
-		glClear(GL_DEPTH_BUFFER_BIT);
-		glMatrixMode(GL_PROJECTION);
-		glLoadIdentity();
-		glOrtho(0.0, VIEW_WIDTH, 0.0, VIEW_HEIGHT, -10.0, 10.0);
-		glMatrixMode(GL_MODELVIEW);
-		glLoadIdentity();
-		glPushMatrix();
-		glTranslatef(0.0f, 0.0f, 10.0f);
+		snapshot.beginPass(VIEW_WIDTH, VIEW_HEIGHT);
+		snapshot.clearDepth();
+		batch.translate(0.0, 0.0, 10.0);
 		if( commandMode )
 		{
-			glColor4ub(0x0, 0x0, 0x0, 0x80);
-			glDisable(GL_TEXTURE_2D);
-			glBegin(GL_QUADS);
-			glVertex2f(0.0f, 0.7f * VIEW_HEIGHT);
-			glVertex2f(VIEW_WIDTH, 0.7f * VIEW_HEIGHT);
-			glVertex2f(VIEW_WIDTH, VIEW_HEIGHT);
-			glVertex2f(0.0f, VIEW_HEIGHT);
-			glEnd();
-			glTranslatef( 0.0f, VIEW_HEIGHT - (FONT_HEIGHT + 2) / (double)UNIT_SIZE, 0.0f);
+			batch.drawQuad(0.0, 0.7 * VIEW_HEIGHT, VIEW_WIDTH, 0.3 * VIEW_HEIGHT, Color(0x0, 0x0, 0x0, 0x80));
+			batch.translate( 0.0, VIEW_HEIGHT - (FONT_HEIGHT + 2) / (double)UNIT_SIZE);
 			drawTextScaled(std::string("Debug Command:\n") + commandString + (frames % 30 < 15 ? '_' : ' '));
 		}
 		else
 		{
-			glTranslatef(0.0f, VIEW_HEIGHT - (FONT_HEIGHT + 2) / (double)UNIT_SIZE, 0.0f);
-			char debugText[256];
-			sprintf( debugText, "Debug Mode\n----------\nX: %.2f\nY: %.2f\nV_X: %.2f\nV_Y: %.2f\nA_X: %.2f\nA_Y: %.2f\nFrame: %d",
+			batch.translate(0.0, VIEW_HEIGHT - (FONT_HEIGHT + 2) / (double)UNIT_SIZE);
+			int pooledSprites = ObjectPool::getTotalLiveCount();
+			int pooledSpritesPeak = ObjectPool::getTotalHighWaterMark();
+			int drawCalls = batch.getDrawCallCount();
+			int vertices = batch.getVertexCount();
+			float presentRate = FPS_MANAGER.getFrameRate();
+			if( renderThread != nullptr )
+			{
+				drawCalls = renderThread->getDrawCallCount();
+				vertices = renderThread->getVertexCount();
+				presentRate = renderThread->getFrameRate();
+			}
+			FpsManager::FrameTimeStats frameTimes = FPS_MANAGER.getFrameTimeStats();
+			char debugText[512];
+			sprintf( debugText, "Debug Mode\n----------\nX: %.2f\nY: %.2f\nV_X: %.2f\nV_Y: %.2f\nA_X: %.2f\nA_Y: %.2f\nFrame: %d\nCollision allocs: %d\nPooled: %d (peak %d)\nDraw calls: %d\nVertices: %d\nFPS: %.1f (update %.1f)\nFrame ms: %.2f p95 %.2f p99 %.2f max %.2f\nDropped frames: %d",
 				player->getX(),
 				player->getY(),
 				player->getXVelocity(),
 				player->getYVelocity(),
 				player->getXAcceleration(),
 				player->getYAcceleration(),
-				world->getFrameNumber() );
+				world->getFrameNumber(),
+				world->getCollisionAllocationCount(),
+				pooledSprites,
+				pooledSpritesPeak,
+				drawCalls,
+				vertices,
+				presentRate,
+				FPS_MANAGER.getFrameRate(),
+				frameTimes.p50,
+				frameTimes.p95,
+				frameTimes.p99,
+				frameTimes.max,
+				FPS_MANAGER.getDroppedFrameCount() );
 			drawBorderedTextScaled(debugText);
 		}
-		glPopMatrix();
 	}
-	glEnable(GL_TEXTURE_2D);
 
-	SDL_GL_SwapWindow((SDL_Window*)window);
+	if( renderThread != nullptr )
+	{
+		renderThread->submit();
+	}
+	else
+	{
+		snapshot.finish();
+		snapshot.render(SPRITE_BATCH, nullptr, 1.0);
+		renderSwapBuffers();
+	}
 	frames++;
 }
 
 void MainState::update()
 {
+	static const ResourceId COUNT_SOUND = ResourceManager::getResourceId("count");
+
 	// Handle input
 	input();
 
@@ -477,8 +530,10 @@ void MainState::update()
 	{
 		if( --endTimer == 0 )
 		{
-			// Head back to the map now...
+			// Head back to the map now. The replay is saved first, since the
+			// state below may replace it before this state is destroyed.
 			world->removeSprite(player);
+			saveReplay();
 			getGame().popState();
 			return;
 		}
@@ -508,7 +563,7 @@ void MainState::update()
 				player->scorePointsWithoutEffect(50 * dt);
 				if( endTimer % 2 == 0 )
 				{
-					PLAY_SOUND_CHANNEL("count", 0);
+					PLAY_SOUND_CHANNEL(COUNT_SOUND, 0);
 				}
 			}
 		}
@@ -517,8 +572,37 @@ void MainState::update()
 	else if( !paused )
 	{
 		world->update(GAME_DELTA);
+		if( GAME_SESSION.replay != nullptr )
+		{
+			GAME_SESSION.replay->recordFrame(*INPUT_MANAGER.getController(0), world->getStateHash());
+		}
+	}
+	else if( GAME_SESSION.replay != nullptr )
+	{
+		// Buttons pressed while paused still reach the player, so they are recorded too
+		GAME_SESSION.replay->recordPausedFrame(*INPUT_MANAGER.getController(0), world->getStateHash());
 	}
 
 	// Rendering
 	render();
 }
+
+void MainState::saveReplay()
+{
+	Replay* replay = GAME_SESSION.replay;
+	if( replay == nullptr || replay->getFrameCount() == 0 )
+	{
+		return;
+	}
+
+	std::string fileName = getReplayFileName(replay->getWorldSeed());
+	if( replay->save(fileName) )
+	{
+		LOG << "Saved replay of " << replay->getFrameCount() << " frames to " << fileName << ".\n";
+	}
+	else
+	{
+		LOG << "Failed to save replay to " << fileName << ".\n";
+	}
+	replay->clearFrames();
+}
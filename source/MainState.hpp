@@ -2,9 +2,13 @@
 #define MAINSTATE_HPP
 
 #include "GameState.hpp"
+#include "RenderSnapshot.hpp"
 
+class Animation;
+class BitmapFont;
 class DeadPlayer;
 class Player;
+class RenderThread;
 class World;
 
 /**
@@ -32,9 +36,30 @@ private:
 	int initialEndTimer; /**< The initial value of the end timer when it was set. */
 	int remainingTime; /**< Used when calculating the player's bonus from level time. */
 
+	// The resources drawn by the HUD, which are found when the state is created
+	const Animation* coinIndicator;
+	const BitmapFont* font;
+	const Animation* marioIndicator;
+	const Animation* pMeterBarEmpty;
+	const Animation* pMeterBarFull;
+	const Animation* pMeterEmpty;
+	const Animation* pMeterFull;
+	const Animation* reserveItemBox;
+	const Animation* timeIndicator;
+	const Animation* times;
+
+	RenderThread* renderThread; /**< Presents the frames, if enabled in the settings. */
+	RenderSnapshot snapshot; /**< The snapshot that frames are recorded into when there is no render thread. */
+
 	void executeCommand();
 	void input();
 	void render();
+
+	/**
+	 * Save the replay being recorded, if any, and discard its frames so
+	 * that it isn't saved twice.
+	 */
+	void saveReplay();
 };
 
 #endif // MAINSTATE_HPP
@@ -199,15 +199,12 @@ void Map::playEvent( int node, int eventNumber )
 void Map::render( double viewX, double viewY, double viewWidth, double viewHeight ) const
 {
 	static int frame = 0;
-
-	// bind the texture atlas
-	RESOURCE_MANAGER.bindTextureAtlas();
+	SpriteBatch& batch = SPRITE_BATCH;
 
 	// clamp the view
 	renderClampView(viewX, viewY, viewWidth, viewHeight, width, height);
 
 	// render cells - layer 1
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 	for( int x = std::floor(viewX - viewWidth / 2.0); x <= std::ceil(viewX + viewWidth / 2.0); ++x )
 	{
 		for( int y = std::floor(viewY - viewHeight / 2.0); y <= std::ceil(viewY + viewHeight / 2.0); ++y )
@@ -226,11 +223,11 @@ void Map::render( double viewX, double viewY, double viewWidth, double viewHeigh
 					f = frame;
 				}
 
-				glPushMatrix();
-				glTranslatef(x - (viewX - viewWidth / 2.0), y - (viewY - viewHeight / 2.0), 0.0f);
-				glScalef(1.0f / HALF_UNIT_SIZE, 1.0f / HALF_UNIT_SIZE, 1.0f);
+				batch.pushTransform();
+				batch.translate(x - (viewX - viewWidth / 2.0), y - (viewY - viewHeight / 2.0));
+				batch.scale(1.0 / HALF_UNIT_SIZE, 1.0 / HALF_UNIT_SIZE);
 				cell->animation->renderFrame(f);
-				glPopMatrix();
+				batch.popTransform();
 			}
 		}
 	}
@@ -239,14 +236,14 @@ void Map::render( double viewX, double viewY, double viewWidth, double viewHeigh
 	if( currentEvent != 0 )
 	{
 		float alpha = (FRAMES_PER_EVENT_FRAME - currentEventProgress) / static_cast<float>(FRAMES_PER_EVENT_FRAME);
-		glColor4f(1.0f, 1.0f, 1.0f, alpha);
+		Color tint(0xff, 0xff, 0xff, static_cast<ubyte>(alpha * 255.0f));
 		for( const EventTile& t : events[currentEvent - 1].frames[currentEventFrame].tiles )
 		{
-			glPushMatrix();
-			glTranslatef(t.x - (viewX - viewWidth / 2.0), t.y - (viewY - viewHeight / 2.0), 1.0f );
-			glScalef(1.0f / HALF_UNIT_SIZE, 1.0f / HALF_UNIT_SIZE, 1.0f);
-			t.animation->renderFrame(t.animationFrame);
-			glPopMatrix();
+			batch.pushTransform();
+			batch.translate(t.x - (viewX - viewWidth / 2.0), t.y - (viewY - viewHeight / 2.0), 1.0 );
+			batch.scale(1.0 / HALF_UNIT_SIZE, 1.0 / HALF_UNIT_SIZE);
+			t.animation->renderFrame(t.animationFrame, false, false, tint);
+			batch.popTransform();
 		}
 
 		// If we are on the final event frame, also fade in the level icon
@@ -255,19 +252,18 @@ void Map::render( double viewX, double viewY, double viewWidth, double viewHeigh
 			const Path& p = paths[events[currentEvent - 1].path - 1];
 			for( int i = 0; i < 2; i++ )
 			{
-				glPushMatrix();
-				glTranslatef(nodes[p.nodes[i] - 1].x - (viewX - viewWidth / 2.0), nodes[p.nodes[i] - 1].y - (viewY - viewHeight / 2.0), 2.0f);
-				glScalef(1.0f / HALF_UNIT_SIZE, 1.0f / HALF_UNIT_SIZE, 1.0f);
-				GET_ANIMATION("level_single_exit")->renderFrame(frame);
-				glPopMatrix();
+				batch.pushTransform();
+				batch.translate(nodes[p.nodes[i] - 1].x - (viewX - viewWidth / 2.0), nodes[p.nodes[i] - 1].y - (viewY - viewHeight / 2.0), 2.0);
+				batch.scale(1.0 / HALF_UNIT_SIZE, 1.0 / HALF_UNIT_SIZE);
+				GET_ANIMATION("level_single_exit")->renderFrame(frame, false, false, tint);
+				batch.popTransform();
 			}
 		}
 	}
 
 	// render level icons - layer 2
-	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
-	glPushMatrix();
-	glTranslatef(0.0f, 0.0f, 3.0f);
+	batch.pushTransform();
+	batch.translate(0.0, 0.0, 3.0);
 	for( int x = std::floor(viewX - viewWidth / 2.0); x <= std::ceil(viewX + viewWidth / 2.0); ++x )
 	{
 		for( int y = std::floor(viewY - viewHeight / 2.0); y <= std::ceil(viewY + viewHeight / 2.0); ++y )
@@ -296,21 +292,21 @@ void Map::render( double viewX, double viewY, double viewWidth, double viewHeigh
 				}
 				if( n.levelId != 0 && x == n.x && y == n.y )
 				{
-					glPushMatrix();
-					glTranslatef(x - (viewX - viewWidth / 2.0), y - (viewY - viewHeight / 2.0), 0.0f);
-					glScalef(1.0f / HALF_UNIT_SIZE, 1.0f / HALF_UNIT_SIZE, 1.0f);
+					batch.pushTransform();
+					batch.translate(x - (viewX - viewWidth / 2.0), y - (viewY - viewHeight / 2.0));
+					batch.scale(1.0 / HALF_UNIT_SIZE, 1.0 / HALF_UNIT_SIZE);
 					GET_ANIMATION("level_single_exit")->renderFrame(frame);
-					glPopMatrix();
+					batch.popTransform();
 				}
 			}
 		}
 	}
-	glPopMatrix();
+	batch.popTransform();
 
 	// draw the player
-	glPushMatrix();
-	glTranslatef(playerX - (viewX - viewWidth / 2.0), playerY - (viewY - viewHeight / 2.0), 4.0f);
-	glScalef(1.0f / HALF_UNIT_SIZE, 1.0f / HALF_UNIT_SIZE, 1.0f);
+	batch.pushTransform();
+	batch.translate(playerX - (viewX - viewWidth / 2.0), playerY - (viewY - viewHeight / 2.0), 4.0);
+	batch.scale(1.0 / HALF_UNIT_SIZE, 1.0 / HALF_UNIT_SIZE);
 	const Animation* animation = nullptr;
 	bool mirrorX = false;
 	if( playerPath != 0 )
@@ -399,15 +395,16 @@ void Map::render( double viewX, double viewY, double viewWidth, double viewHeigh
 		animation = GET_ANIMATION("map_mario");
 	}
 	Animation::Frame f = animation->getFrame(frame);
-	glTranslatef(f.width / -2.0 * UNIT_SIZE, 0.0f, 0.0f);
+	batch.translate(f.width / -2.0 * UNIT_SIZE, 0.0);
 	animation->renderFrame(f, mirrorX);
-	glPopMatrix();
+	batch.popTransform();
 
 	if( SETTINGS.debugMode )
 	{
+		batch.flush();
 		glClear(GL_DEPTH_BUFFER_BIT);
 		renderSetUnitsToPixels();
-		glTranslatef(0.0f, SETTINGS.getRenderedScreenHeight() - FONT_HEIGHT - 2, 0.0f);
+		batch.translate(0.0, SETTINGS.getRenderedScreenHeight() - FONT_HEIGHT - 2);
 		char tempString[128];
 		sprintf(tempString,
 			"Debug Mode\nNode:%d\nPath:%d\nProgress:%d\nLevel:%d",
@@ -419,6 +416,8 @@ void Map::render( double viewX, double viewY, double viewWidth, double viewHeigh
 		drawBorderedText(tempString);
 	}
 
+	// Draw everything before the caller changes any OpenGL state
+	batch.flush();
 	frame++;
 }
 
@@ -444,6 +443,9 @@ void Map::setTile( int x, int y, const Animation* animation, int frame )
 
 void Map::update()
 {
+	static const ResourceId MAP_MOVE_SOUND = ResourceManager::getResourceId("map_move");
+	static const ResourceId MAP_REVEAL_SOUND = ResourceManager::getResourceId("map_reveal");
+
 	// Is an event occurring?
 	if( currentEvent != 0 )
 	{
@@ -455,7 +457,7 @@ void Map::update()
 			{
 				setTile(t.x, t.y, t.animation, t.animationFrame);
 			}
-			PLAY_SOUND_CHANNEL("map_reveal", 0);
+			PLAY_SOUND_CHANNEL(MAP_REVEAL_SOUND, 0);
 
 			// Are we done?
 			if( ++currentEventFrame >= (int)(e.frames.size()) )
@@ -529,7 +531,7 @@ void Map::update()
 		{
 			playerPath = 0;
 			setPlayerPosition(node2);
-			PLAY_SOUND("map_move");
+			PLAY_SOUND(MAP_MOVE_SOUND);
 			return;
 		}
 
@@ -276,6 +276,8 @@ MapState::~MapState()
 
 void MapState::input()
 {
+	static const ResourceId LEVEL_ENTER_SOUND = ResourceManager::getResourceId("level_enter");
+
 	SDL_Event event;
 	while( SDL_PollEvent(&event) )
 	{
@@ -321,7 +323,7 @@ void MapState::input()
 	if( levelId != 0 && INPUT_MANAGER.getController(0)->getButtonState(BUTTON_A) )
 	{
 		fadeOutProgress = 1;
-		PLAY_SOUND("level_enter");
+		PLAY_SOUND(LEVEL_ENTER_SOUND);
 		Mix_HaltMusic();
 	}
 }
@@ -356,10 +358,10 @@ void MapState::render() const
 		char tempString[64];
 		sprintf(tempString, "Level %d", map->getLevelId());
 		renderSetUnitsToPixels();
-		glTranslatef(
+		SPRITE_BATCH.translate(
 			SETTINGS.getRenderedScreenWidth() / 2.0 - strlen(tempString) * font->getCharacterWidth() / 2.0,
-			SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 1.5f,
-			1.0f
+			SETTINGS.getRenderedScreenHeight() - font->getCharacterHeight() * 1.5,
+			1.0
 		);
 		font->renderText(tempString);
 	}
@@ -378,21 +380,16 @@ void MapState::render() const
 			fade = fadeOutProgress / (double)FADE_DURATION;
 		}
 
+		SPRITE_BATCH.flush();
 		glClear(GL_DEPTH_BUFFER_BIT);
 		glMatrixMode(GL_PROJECTION);
 		glLoadIdentity();
 		glOrtho(0, 1, 0, 1, -1, 1);
 		glMatrixMode(GL_MODELVIEW);
 		glLoadIdentity();
-		glDisable(GL_TEXTURE_2D);
-
-		glColor4f(0.0f, 0.0f, 0.0f, fade);
-		glBegin(GL_QUADS);
-			glVertex2i(0, 0);
-			glVertex2i(1, 0);
-			glVertex2i(1, 1);
-			glVertex2i(0, 1);
-		glEnd();
+
+		SPRITE_BATCH.loadIdentity();
+		SPRITE_BATCH.drawQuad(0.0, 0.0, 1.0, 1.0, Color(0, 0, 0, static_cast<ubyte>(fade * 255.0)));
 	}
 
 	renderSwapBuffers();
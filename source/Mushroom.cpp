@@ -1,17 +1,21 @@
 #include "Mushroom.hpp"
+#include "ResourceManager.hpp"
 
 Mushroom::Mushroom( MushroomType type ) :
 	Item( type == MUSHROOM_SUPER ? POWERUP_POINT_VALUE : 0 ), // Only super mushrooms give the player points
 	type(type)
 {
+	static const ResourceId MUSHROOM_1UP_ANIMATION = ResourceManager::getResourceId("mushroom_1up");
+	static const ResourceId MUSHROOM_ANIMATION = ResourceManager::getResourceId("mushroom");
+
 	switch( type )
 	{
 		case MUSHROOM_1UP:
-			setAnimation("mushroom_1up");
+			setAnimation(MUSHROOM_1UP_ANIMATION);
 			break;
 		case MUSHROOM_SUPER:
 		default:
-			setAnimation("mushroom");
+			setAnimation(MUSHROOM_ANIMATION);
 			break;
 	}
 	setXVelocity(MOVEMENT_SPEED);
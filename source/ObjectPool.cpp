@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <new>
+
+#include "ObjectPool.hpp"
+
+int ObjectPool::totalHighWaterMark = 0;
+int ObjectPool::totalLiveCount = 0;
+
+ObjectPool::ObjectPool( const char* name, std::size_t blockSize ) :
+	freeBlocks(nullptr),
+	highWaterMark(0),
+	liveCount(0),
+	name(name)
+{
+	// Every block must be able to hold a free list link and stay aligned for any type
+	const std::size_t alignment = alignof(std::max_align_t);
+	blockSize = std::max(blockSize, sizeof(FreeBlock));
+	this->blockSize = (blockSize + alignment - 1) / alignment * alignment;
+
+	getPoolList().push_back(this);
+}
+
+ObjectPool::~ObjectPool()
+{
+	std::vector<ObjectPool*>& pools = getPoolList();
+	pools.erase(std::remove(pools.begin(), pools.end(), this), pools.end());
+
+	for( auto chunk : chunks )
+	{
+		::operator delete(chunk);
+	}
+}
+
+void* ObjectPool::allocate( std::size_t size )
+{
+	if( size > blockSize )
+	{
+		return ::operator new(size);
+	}
+
+	if( freeBlocks == nullptr )
+	{
+		// Carve a new chunk into free blocks
+		char* chunk = static_cast<char*>(::operator new(blockSize * BLOCKS_PER_CHUNK));
+		chunks.push_back(chunk);
+		for( int i = BLOCKS_PER_CHUNK - 1; i >= 0; --i )
+		{
+			FreeBlock* block = reinterpret_cast<FreeBlock*>(chunk + i * blockSize);
+			block->next = freeBlocks;
+			freeBlocks = block;
+		}
+	}
+
+	FreeBlock* block = freeBlocks;
+	freeBlocks = block->next;
+	liveCount++;
+	highWaterMark = std::max(highWaterMark, liveCount);
+	totalLiveCount++;
+	totalHighWaterMark = std::max(totalHighWaterMark, totalLiveCount);
+	return block;
+}
+
+void ObjectPool::deallocate( void* block, std::size_t size )
+{
+	if( block == nullptr )
+	{
+		return;
+	}
+	if( size > blockSize )
+	{
+		::operator delete(block);
+		return;
+	}
+
+	FreeBlock* freeBlock = static_cast<FreeBlock*>(block);
+	freeBlock->next = freeBlocks;
+	freeBlocks = freeBlock;
+	liveCount--;
+	totalLiveCount--;
+}
+
+int ObjectPool::getCapacity() const
+{
+	return chunks.size() * BLOCKS_PER_CHUNK;
+}
+
+int ObjectPool::getHighWaterMark() const
+{
+	return highWaterMark;
+}
+
+int ObjectPool::getLiveCount() const
+{
+	return liveCount;
+}
+
+const char* ObjectPool::getName() const
+{
+	return name;
+}
+
+std::vector<ObjectPool*>& ObjectPool::getPoolList()
+{
+	static std::vector<ObjectPool*>* pools = new std::vector<ObjectPool*>();
+	return *pools;
+}
+
+const std::vector<ObjectPool*>& ObjectPool::getPools()
+{
+	return getPoolList();
+}
+
+int ObjectPool::getTotalHighWaterMark()
+{
+	return totalHighWaterMark;
+}
+
+int ObjectPool::getTotalLiveCount()
+{
+	return totalLiveCount;
+}
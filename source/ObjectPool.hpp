@@ -0,0 +1,129 @@
+#ifndef OBJECTPOOL_HPP
+#define OBJECTPOOL_HPP
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A pool of fixed size memory blocks for a single class. Freed blocks are
+ * kept on a free list and handed out again, so classes that are created
+ * and destroyed constantly don't go through the general heap.
+ *
+ * Pools are not thread safe. Sprites are only created and destroyed from
+ * the serial part of the World update.
+ */
+class ObjectPool
+{
+public:
+	/**
+	 * Create an object pool.
+	 *
+	 * @param name the name of the pooled class, for statistics.
+	 * @param blockSize the size of the pooled class.
+	 */
+	ObjectPool( const char* name, std::size_t blockSize );
+
+	~ObjectPool();
+
+	/**
+	 * Allocate a block. Requests larger than the block size, which come from
+	 * derived classes that are not pooled themselves, go to the general heap.
+	 */
+	void* allocate( std::size_t size );
+
+	/**
+	 * Free a block that was allocated by the pool.
+	 */
+	void deallocate( void* block, std::size_t size );
+
+	/**
+	 * Get the number of blocks that the pool has allocated memory for.
+	 */
+	int getCapacity() const;
+
+	/**
+	 * Get the largest number of blocks that were in use at the same time.
+	 */
+	int getHighWaterMark() const;
+
+	/**
+	 * Get the number of blocks currently in use.
+	 */
+	int getLiveCount() const;
+
+	/**
+	 * Get the name of the pooled class.
+	 */
+	const char* getName() const;
+
+	/**
+	 * Get all of the object pools that have been created.
+	 */
+	static const std::vector<ObjectPool*>& getPools();
+
+	/**
+	 * Get the largest number of blocks that were in use at the same time,
+	 * across every pool. This is at most the sum of the pools' own high
+	 * water marks, which may have been reached at different times.
+	 */
+	static int getTotalHighWaterMark();
+
+	/**
+	 * Get the number of blocks currently in use, across every pool.
+	 */
+	static int getTotalLiveCount();
+
+private:
+	static const int BLOCKS_PER_CHUNK = 64; /**< The number of blocks allocated at once when the pool runs out. */
+
+	/**
+	 * A free block, which links to the next free block.
+	 */
+	struct FreeBlock
+	{
+		FreeBlock* next;
+	};
+
+	std::size_t blockSize;
+	std::vector<char*> chunks;
+	FreeBlock* freeBlocks;
+	int highWaterMark;
+	int liveCount;
+	const char* name;
+
+	static int totalHighWaterMark;
+	static int totalLiveCount;
+
+	static std::vector<ObjectPool*>& getPoolList();
+};
+
+/**
+ * Declare class specific operator new and delete that use an ObjectPool.
+ * Place this in the public section of the class declaration.
+ */
+#define DECLARE_POOLED_ALLOCATION() \
+	static ObjectPool& getPool(); \
+	static void* operator new( std::size_t size ); \
+	static void operator delete( void* block, std::size_t size );
+
+/**
+ * Define the pooled allocation functions declared for a class. The pool is
+ * created on first use and never destroyed, so sprites can safely be deleted
+ * at any point during shutdown.
+ */
+#define DEFINE_POOLED_ALLOCATION(type) \
+	ObjectPool& type::getPool() \
+	{ \
+		static ObjectPool* pool = new ObjectPool(#type, sizeof(type)); \
+		return *pool; \
+	} \
+	void* type::operator new( std::size_t size ) \
+	{ \
+		return getPool().allocate(size); \
+	} \
+	void type::operator delete( void* block, std::size_t size ) \
+	{ \
+		getPool().deallocate(block, size); \
+	}
+
+#endif // OBJECTPOOL_HPP
@@ -1,16 +1,19 @@
 #include "Koopa.hpp"
 #include "Paratroopa.hpp"
+#include "ResourceManager.hpp"
 #include "World.hpp"
 
 Paratroopa::Paratroopa()
 {
+	static const ResourceId PARATROOPA_ANIMATION = ResourceManager::getResourceId("paratroopa");
+
 	setDefaultXVelocity(-1.0 * MOVEMENT_SPEED);
 	setWidth(WIDTH);
 	setHeight(HEIGHT);
 	setGravityEnabled(false);
 	setYAcceleration(GRAVITY);
 
-	setAnimation("paratroopa");
+	setAnimation(PARATROOPA_ANIMATION);
 }
 
 void Paratroopa::onBump()
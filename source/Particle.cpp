@@ -1,10 +1,14 @@
 #include "Particle.hpp"
 
+DEFINE_POOLED_ALLOCATION(Particle)
+
 Particle::Particle( const Animation* animation, bool destroyOnAnimationEnd ) :
 	destroyOnAnimationEnd(destroyOnAnimationEnd),
 	duration(-1.0),
 	initialDelay(-1.0)
 {
+	setActivityPolicy(ACTIVITY_DESPAWN);
+	setIndependentUpdateEnabled(true);
 	if( destroyOnAnimationEnd )
 	{
 		playAnimation(animation);
@@ -23,6 +27,8 @@ Particle::Particle( const Animation* animation, double initialDelay, bool destro
 	duration(-1.0),
 	initialDelay(initialDelay)
 {
+	setActivityPolicy(ACTIVITY_DESPAWN);
+	setIndependentUpdateEnabled(true);
 	initialize(animation); // for now, this is only used on coin sparkles.
 }
 
@@ -31,6 +37,8 @@ Particle::Particle( const Animation* animation, double duration ) :
 	duration(duration),
 	initialDelay(-1.0)
 {
+	setActivityPolicy(ACTIVITY_DESPAWN);
+	setIndependentUpdateEnabled(true);
 	playAnimation(animation, animation);
 	//initialize(animation);
 }
@@ -1,6 +1,7 @@
 #ifndef PARTICLE_HPP
 #define PARTICLE_HPP
 
+#include "ObjectPool.hpp"
 #include "Sprite.hpp"
 
 /**
@@ -34,6 +35,8 @@ public:
 	 */
 	Particle( const Animation* animation, double duration );
 
+	DECLARE_POOLED_ALLOCATION()
+
 private:
 	const Animation* animationToPlay;
 	bool destroyOnAnimationEnd;
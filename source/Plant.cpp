@@ -6,14 +6,17 @@
 Plant::Plant( Direction orientation ) :
 	orientation(orientation)
 {
+	static const ResourceId PLANT_HORIZONTAL_ANIMATION = ResourceManager::getResourceId("plant_horizontal");
+	static const ResourceId PLANT_VERTICAL_ANIMATION = ResourceManager::getResourceId("plant_vertical");
+
 	if( isVertical(orientation) )
 	{
-		setAnimation("plant_vertical");
+		setAnimation(PLANT_VERTICAL_ANIMATION);
 		setHeight(2.0);
 	}
 	else
 	{
-		setAnimation("plant_horizontal");
+		setAnimation(PLANT_HORIZONTAL_ANIMATION);
 		setWidth(1.5);
 	}
 
@@ -54,6 +54,7 @@ Player::Player( int controllerPort ) :
 	setHeight(SMALL_HEIGHT);
 	disableGravity(); // We compute our own gravity
 	setDeathBoundaryEnabled(false); // Don't destroy us if we are out of bounds
+	setActivityPolicy(ACTIVITY_ALWAYS);
 
 	reset();
 	setState(SMALL);
@@ -200,6 +201,8 @@ void Player::decrementFireballCount()
 
 void Player::dropReserveItem()
 {
+	static const ResourceId RESERVE_ITEM_DROP_SOUND = ResourceManager::getResourceId("reserve_item_drop");
+
 	if( reserveItem != nullptr )
 	{
 		double x = camera.getPosition().x;
@@ -211,12 +214,14 @@ void Player::dropReserveItem()
 		reserve->setTop(y + VIEW_HEIGHT / 2.0 - 1.0);
 		getWorld().addSprite(reserve);
 		reserveItem = nullptr;
-		playSound("reserve_item_drop");
+		playSound(RESERVE_ITEM_DROP_SOUND);
 	}
 }
 
 void Player::gainCoins( int coins )
 {
+	static const ResourceId COIN_GET_SOUND = ResourceManager::getResourceId("coin_get");
+
 	this->coins += coins;
 	if( this->coins > 99 )
 	{
@@ -225,15 +230,17 @@ void Player::gainCoins( int coins )
 	}
 	else
 	{
-		playSound("coin_get");
+		playSound(COIN_GET_SOUND);
 	}
 }
 
 void Player::gainLives(int lives, double x, double y)
 {
+	static const ResourceId ONE_UP_SOUND = ResourceManager::getResourceId("1up");
+
 	this->lives += lives;
 
-	playSound("1up", 0);
+	playSound(ONE_UP_SOUND, 0);
 
 	if( isDead() )
 	{
@@ -548,6 +555,12 @@ void Player::loadAnimations( State state )
 
 void Player::onButtonToggle( InputButton button, bool pressed )
 {
+	static const ResourceId JUMP_SOUND = ResourceManager::getResourceId("jump");
+	static const ResourceId KICK_SOUND = ResourceManager::getResourceId("kick");
+	static const ResourceId SPIN_SOUND = ResourceManager::getResourceId("spin");
+	static const ResourceId SWIM_SOUND = ResourceManager::getResourceId("swim");
+	static const ResourceId THROW_SOUND = ResourceManager::getResourceId("throw");
+
 	if( isDead() || phase != PHASE_DEFAULT )
 	{
 		return;
@@ -560,7 +573,7 @@ void Player::onButtonToggle( InputButton button, bool pressed )
 			{
 				setYVelocity(clamp(getYVelocity() + SWIM_POWER_FACTOR, 0.0, VELOCITY(0x0200)));
 				playAnimation(swimMoveAnimation);
-				playSound("swim");
+				playSound(SWIM_SOUND);
 			}
 			else if( pressed && (!isFlying() || climbing) )
 			{
@@ -589,7 +602,7 @@ void Player::onButtonToggle( InputButton button, bool pressed )
 					flightTimer = FLIGHT_DURATION;
 				}
 
-				playSound("jump");
+				playSound(JUMP_SOUND);
 			}
 			break;
 
@@ -617,7 +630,7 @@ void Player::onButtonToggle( InputButton button, bool pressed )
 				{
 					xv *= -1.0;
 				}
-				playSound("throw");
+				playSound(THROW_SOUND);
 				Sprite* fireball = new Fireball(this, xv);
 				getWorld().addSprite(getCenterX(), getCenterY(), fireball);
 				fireball->setCenterX(getCenterX());
@@ -628,7 +641,7 @@ void Player::onButtonToggle( InputButton button, bool pressed )
 			{
 				// Spin the tail
 				playAnimation(spinAnimation);
-				playSound("spin");
+				playSound(SPIN_SOUND);
 
 				double left;
 				double bottom = getBottom();
@@ -652,7 +665,7 @@ void Player::onButtonToggle( InputButton button, bool pressed )
 					{
 						enemy->bump();
 						scorePoints( MULTIPLE_KILL_POINT_SEQUENCE[0], enemy->getX(), enemy->getY() );
-						playSound("kick");
+						playSound(KICK_SOUND);
 					}
 				}
 
@@ -711,6 +724,9 @@ void Player::onButtonToggle( InputButton button, bool pressed )
 
 void Player::onCollision(Sprite& sprite, Edge edge)
 {
+	static const ResourceId KICK_SOUND = ResourceManager::getResourceId("kick");
+	static const ResourceId STOMP_SOUND = ResourceManager::getResourceId("stomp");
+
 	// Pick up sprites that can be held
 	if( sprite.isHoldingEnabled() && !isHoldingSprite() && !sprite.isHeld() && INPUT_MANAGER.getController(0)->getButtonState(BUTTON_B) && getYVelocity() <= 0.0 )
 	{
@@ -749,7 +765,7 @@ void Player::onCollision(Sprite& sprite, Edge edge)
 				// Play the appropriate sound
 				if( slideKills == 0 )
 				{
-					playSound("kick");
+					playSound(KICK_SOUND);
 				}
 				else
 				{
@@ -772,7 +788,7 @@ void Player::onCollision(Sprite& sprite, Edge edge)
 			if( enemy->isStompable() )
 			{
 				enemy->stomp();
-				playSound("stomp");
+				playSound(STOMP_SOUND);
 				setYVelocity(STOMP_VELOCITY);
 
 				if( MULTIPLE_KILL_POINT_SEQUENCE[stompCount] != -1 )
@@ -885,6 +901,8 @@ void Player::onGround()
 
 void Player::onPostUpdate()
 {
+	static const ResourceId SPIN_SOUND = ResourceManager::getResourceId("spin");
+
 	// Check if we are in a different phase and process accordingly
 	switch( phase )
 	{
@@ -990,7 +1008,7 @@ void Player::onPostUpdate()
 		setAnimation(flightAnimation);
 		if( getWorld().getFrameNumber() % flightAnimation->getLength() == 0 )
 		{
-			playSound("spin", 0);
+			playSound(SPIN_SOUND, 0);
 		}
 	}
 	else if( isDescending() && descentAnimation != nullptr && heldSprite == nullptr )
@@ -998,7 +1016,7 @@ void Player::onPostUpdate()
 		setAnimation(descentAnimation);
 			if( getWorld().getFrameNumber() % descentAnimation->getLength() == 0 )
 		{
-			playSound("spin", 0);
+			playSound(SPIN_SOUND, 0);
 		}
 	}
 	else if( climbing )
@@ -1777,6 +1795,9 @@ void Player::reset()
 
 void Player::setPhase( Phase phase )
 {
+	static const ResourceId PLAYER_DEAD_ANIMATION = ResourceManager::getResourceId("player_dead");
+	static const ResourceId POWERDOWN_SOUND = ResourceManager::getResourceId("powerdown");
+
 	switch( phase )
 	{
 	case PHASE_DEFAULT:
@@ -1795,7 +1816,7 @@ void Player::setPhase( Phase phase )
 		climbing = false;
 		if( getTop() > 0.0 )
 		{
-			setAnimation( "player_dead" );
+			setAnimation( PLAYER_DEAD_ANIMATION );
 		}
 		else
 		{
@@ -1839,7 +1860,7 @@ void Player::setPhase( Phase phase )
 
 		warpTimer = WARP_TIMER;
 
-		playSound( "powerdown" );
+		playSound( POWERDOWN_SOUND );
 		break;
 
 	default:
@@ -1851,6 +1872,9 @@ void Player::setPhase( Phase phase )
 
 void Player::setReserveItem( State itemState )
 {
+	static const ResourceId POWERUP_SOUND = ResourceManager::getResourceId("powerup");
+	static const ResourceId RESERVE_ITEM_SOUND = ResourceManager::getResourceId("reserve_item");
+
 	// Set the reserve item only if we need to
 	bool setReserve = false;
 	Item* reserve = nullptr;
@@ -1918,16 +1942,16 @@ void Player::setReserveItem( State itemState )
 		reserveItem = reserve;
 		if( state == SUPER && itemState > SUPER )
 		{
-			playSound("powerup");
+			playSound(POWERUP_SOUND);
 		}
 		else
 		{
-			playSound("reserve_item");
+			playSound(RESERVE_ITEM_SOUND);
 		}
 	}
 	else
 	{
-		playSound("powerup");
+		playSound(POWERUP_SOUND);
 	}
 }
 
@@ -2027,6 +2051,8 @@ void Player::shrink()
 
 void Player::takeDamage( bool fatal )
 {
+	static const ResourceId POWERDOWN_SOUND = ResourceManager::getResourceId("powerdown");
+
 	if( dead || (!fatal && (invincibilityTimer != 0 || starTimer != 0)) )
 	{
 		return;
@@ -2067,7 +2093,7 @@ void Player::takeDamage( bool fatal )
 	else
 	{
 		invincibilityTimer = INVINCIBILITY_DURATION;
-		playSound("powerdown");
+		playSound(POWERDOWN_SOUND);
 	}
 }
 
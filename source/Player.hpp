@@ -165,6 +165,13 @@ public:
 	 */
 	void scorePointsWithoutEffect( int points );
 
+	/**
+	 * Set the powerup state of the player.
+	 *
+	 * @param transformAnimation whether to play the transformation animation.
+	 */
+	void setState( State state, bool transformAnimation = false );
+
 	/**
 	 * Have the player take one unit of damage.
 	 *
@@ -336,7 +343,6 @@ private:
 	void releaseHeldSprite( bool kickIfShell );
 	void setPhase( Phase phase );
 	void setReserveItem( State itemState );
-	void setState( State state, bool transformAnimation = false );
 	void shrink();
 	void updateCamera();
 };
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include <cmath>
+
+#include <SDL2/SDL_opengl.h>
+
+#include "Globals.hpp"
+#include "RenderSnapshot.hpp"
+#include "Rendering.hpp"
+
+static const double MAX_INTERPOLATION_DISTANCE = 2.0; /**< Objects that moved further than this in one frame, in units, jumped and are not interpolated. */
+
+/**
+ * Snap a position in units to the pixel grid, the same way World does.
+ */
+static double snapToPixel( double position )
+{
+	return std::floor( (double)UNIT_SIZE * position ) / (double)UNIT_SIZE;
+}
+
+RenderSnapshot::RenderSnapshot() :
+	passCount(0)
+{
+}
+
+void RenderSnapshot::beginMotion( unsigned int id, double x, double y )
+{
+	Pass& pass = passes[passCount - 1];
+	Motion motion;
+	motion.id = id;
+	motion.x = x;
+	motion.y = y;
+	motion.first = pass.mesh.getVertexCount();
+	motion.count = 0;
+	pass.motions.push_back(motion);
+}
+
+void RenderSnapshot::beginPass( double width, double height )
+{
+	SpriteBatch& batch = SPRITE_BATCH;
+	if( passCount > 0 )
+	{
+		batch.endMesh();
+	}
+
+	if( passCount == (int)passes.size() )
+	{
+		passes.push_back(Pass());
+	}
+	Pass& pass = passes[passCount++];
+	pass.clearColor = false;
+	pass.clearDepth = false;
+	pass.height = height;
+	pass.mesh.clear();
+	pass.motions.clear();
+	pass.motionIndex.clear();
+	pass.scrolls.clear();
+	pass.width = width;
+
+	batch.loadIdentity();
+	batch.beginMesh(pass.mesh);
+}
+
+void RenderSnapshot::beginScroll( double scrollX, double scrollY, int frameWidth, int frameHeight )
+{
+	Pass& pass = passes[passCount - 1];
+	Scroll scroll;
+	scroll.x = scrollX;
+	scroll.y = scrollY;
+	scroll.frameWidth = frameWidth;
+	scroll.frameHeight = frameHeight;
+	scroll.first = pass.mesh.getVertexCount();
+	scroll.count = 0;
+	pass.scrolls.push_back(scroll);
+}
+
+void RenderSnapshot::clearColor( const Color& color )
+{
+	Pass& pass = passes[passCount - 1];
+	pass.clearColor = true;
+	pass.color = color;
+}
+
+void RenderSnapshot::clearDepth()
+{
+	passes[passCount - 1].clearDepth = true;
+}
+
+void RenderSnapshot::endMotion()
+{
+	Pass& pass = passes[passCount - 1];
+	Motion& motion = pass.motions.back();
+	motion.count = pass.mesh.getVertexCount() - motion.first;
+}
+
+void RenderSnapshot::endScroll()
+{
+	Pass& pass = passes[passCount - 1];
+	Scroll& scroll = pass.scrolls.back();
+	scroll.count = pass.mesh.getVertexCount() - scroll.first;
+}
+
+const RenderSnapshot::Motion* RenderSnapshot::findMotion( const Pass& pass, unsigned int id )
+{
+	auto it = std::lower_bound(pass.motionIndex.begin(), pass.motionIndex.end(), std::make_pair(id, 0));
+	if( it == pass.motionIndex.end() || it->first != id )
+	{
+		return nullptr;
+	}
+
+	return &pass.motions[it->second];
+}
+
+void RenderSnapshot::finish()
+{
+	if( passCount > 0 )
+	{
+		SPRITE_BATCH.endMesh();
+	}
+
+	for( int i = 0; i < passCount; ++i )
+	{
+		Pass& pass = passes[i];
+		for( int j = 0; j < (int)pass.motions.size(); ++j )
+		{
+			pass.motionIndex.push_back(std::make_pair(pass.motions[j].id, j));
+		}
+		std::sort(pass.motionIndex.begin(), pass.motionIndex.end());
+	}
+}
+
+void RenderSnapshot::render( SpriteBatch& batch, const RenderSnapshot* previous, double alpha ) const
+{
+	for( int i = 0; i < passCount; ++i )
+	{
+		const Pass& pass = passes[i];
+		if( pass.clearColor )
+		{
+			renderClearScreen(pass.color.r / 255.0f, pass.color.g / 255.0f, pass.color.b / 255.0f, pass.color.a / 255.0f);
+		}
+		else if( pass.clearDepth )
+		{
+			glClear(GL_DEPTH_BUFFER_BIT);
+		}
+
+		glMatrixMode(GL_PROJECTION);
+		glLoadIdentity();
+		glOrtho(0.0, pass.width, 0.0, pass.height, -10.0, 10.0);
+		glMatrixMode(GL_MODELVIEW);
+		glLoadIdentity();
+
+		// Move each object to where it was between the two snapshots
+		const SpriteBatch::Mesh* mesh = &pass.mesh;
+		if( previous != nullptr && i < previous->passCount && (!pass.motions.empty() || !pass.scrolls.empty()) )
+		{
+			const Pass& previousPass = previous->passes[i];
+			presentedMesh = pass.mesh;
+			for( auto& motion : pass.motions )
+			{
+				const Motion* previousMotion = findMotion(previousPass, motion.id);
+				if( previousMotion == nullptr ||
+					std::abs(motion.x - previousMotion->x) > MAX_INTERPOLATION_DISTANCE ||
+					std::abs(motion.y - previousMotion->y) > MAX_INTERPOLATION_DISTANCE )
+				{
+					continue;
+				}
+
+				double x = previousMotion->x + (motion.x - previousMotion->x) * alpha;
+				double y = previousMotion->y + (motion.y - previousMotion->y) * alpha;
+				double offsetX = snapToPixel(x) - snapToPixel(motion.x);
+				double offsetY = snapToPixel(y) - snapToPixel(motion.y);
+				if( offsetX != 0.0 || offsetY != 0.0 )
+				{
+					presentedMesh.translateVertices(motion.first, motion.count, offsetX, offsetY);
+				}
+			}
+
+			// Scroll each background to where the view was, in whole pixels
+			for( int j = 0; j < (int)pass.scrolls.size() && j < (int)previousPass.scrolls.size(); ++j )
+			{
+				const Scroll& scroll = pass.scrolls[j];
+				const Scroll& previousScroll = previousPass.scrolls[j];
+				if( std::abs(scroll.x - previousScroll.x) > MAX_INTERPOLATION_DISTANCE * UNIT_SIZE ||
+					std::abs(scroll.y - previousScroll.y) > MAX_INTERPOLATION_DISTANCE * UNIT_SIZE )
+				{
+					continue;
+				}
+
+				double offsetX = std::floor(previousScroll.x + (scroll.x - previousScroll.x) * alpha) - scroll.x;
+				double offsetY = std::floor(previousScroll.y + (scroll.y - previousScroll.y) * alpha) - scroll.y;
+				if( offsetX == 0.0 && offsetY == 0.0 )
+				{
+					continue;
+				}
+
+				// Texture rows start at the top of the image, so scrolling up moves v the other way
+				presentedMesh.translateTextureCoordinates(scroll.first, scroll.count,
+					scroll.frameWidth > 0 ? offsetX / scroll.frameWidth : 0.0,
+					scroll.frameHeight > 0 ? -offsetY / scroll.frameHeight : 0.0);
+				presentedMesh.translateVertices(scroll.first, scroll.count,
+					scroll.frameWidth > 0 ? 0.0 : -offsetX / UNIT_SIZE,
+					scroll.frameHeight > 0 ? 0.0 : -offsetY / UNIT_SIZE);
+			}
+			mesh = &presentedMesh;
+		}
+
+		batch.loadIdentity();
+		batch.drawMesh(*mesh);
+	}
+}
+
+void RenderSnapshot::reset()
+{
+	passCount = 0;
+}
@@ -0,0 +1,152 @@
+#ifndef RENDERSNAPSHOT_HPP
+#define RENDERSNAPSHOT_HPP
+
+#include <utility>
+#include <vector>
+
+#include "Color.hpp"
+#include "SpriteBatch.hpp"
+
+/**
+ * Everything drawn during one simulation frame, recorded so that it can be
+ * presented later, possibly on another thread, without touching the game
+ * state. A snapshot is never changed after it is finished.
+ *
+ * A snapshot is made of passes, each with its own projection, like the
+ * world and the HUD on top of it. Geometry that belongs to a moving object
+ * is recorded as a motion, with the position of the object, so that it can
+ * be moved to a position between two snapshots when they are presented.
+ */
+class RenderSnapshot
+{
+public:
+	static const unsigned int LEVEL_MOTION_ID = 0; /**< The motion ID used for geometry that is fixed to the level. */
+
+	RenderSnapshot();
+
+	/**
+	 * Start recording a new pass. Everything drawn through the SpriteBatch
+	 * is added to the pass, until the next pass is started or the snapshot
+	 * is finished. This resets the SpriteBatch transform.
+	 *
+	 * @param width the width of the projection, like glOrtho().
+	 * @param height the height of the projection, like glOrtho().
+	 */
+	void beginPass( double width, double height );
+
+	/**
+	 * Start recording geometry that moves with an object.
+	 *
+	 * @param id an ID that identifies the object in every snapshot.
+	 * @param x the position of the object in the pass, in world units.
+	 * @param y the position of the object in the pass, in world units.
+	 */
+	void beginMotion( unsigned int id, double x, double y );
+
+	/**
+	 * Start recording a background that scrolls with the view. Its texture
+	 * repeats, so it is scrolled between snapshots by moving its texture
+	 * coordinates along the axes it tiles on, and by moving it along the
+	 * others.
+	 *
+	 * @param scrollX how far the background is scrolled horizontally, in pixels.
+	 * @param scrollY how far the background is scrolled vertically, in pixels.
+	 * @param frameWidth the width of the background texture, in pixels, or 0 if it doesn't tile horizontally.
+	 * @param frameHeight the height of the background texture, in pixels, or 0 if it doesn't tile vertically.
+	 */
+	void beginScroll( double scrollX, double scrollY, int frameWidth, int frameHeight );
+
+	/**
+	 * Clear the color and depth buffers before drawing the current pass.
+	 */
+	void clearColor( const Color& color );
+
+	/**
+	 * Clear the depth buffer before drawing the current pass, so that it is
+	 * drawn on top of earlier passes.
+	 */
+	void clearDepth();
+
+	/**
+	 * Stop recording the current motion.
+	 */
+	void endMotion();
+
+	/**
+	 * Stop recording the current scrolling background.
+	 */
+	void endScroll();
+
+	/**
+	 * Stop recording and prepare the snapshot to be presented.
+	 */
+	void finish();
+
+	/**
+	 * Draw the snapshot with OpenGL. Moving objects are placed between their
+	 * positions in the previous snapshot and this one, snapped to pixels.
+	 *
+	 * @param batch the batch to draw with.
+	 * @param previous the snapshot before this one, or nullptr to not interpolate.
+	 * @param alpha how far to go from the previous snapshot to this one, from 0 to 1.
+	 */
+	void render( SpriteBatch& batch, const RenderSnapshot* previous, double alpha ) const;
+
+	/**
+	 * Remove everything from the snapshot so that it can be recorded again.
+	 */
+	void reset();
+
+private:
+	/**
+	 * Geometry that moves with an object.
+	 */
+	struct Motion
+	{
+		unsigned int id;
+		double x;
+		double y;
+		int first; /**< The first vertex of the geometry in the pass mesh. */
+		int count; /**< The number of vertices in the geometry. */
+	};
+
+	/**
+	 * A background that scrolls with the view.
+	 */
+	struct Scroll
+	{
+		double x; /**< How far the background is scrolled horizontally, in pixels. */
+		double y; /**< How far the background is scrolled vertically, in pixels. */
+		int frameWidth; /**< The width of the texture, or 0 if it doesn't tile horizontally. */
+		int frameHeight; /**< The height of the texture, or 0 if it doesn't tile vertically. */
+		int first; /**< The first vertex of the background in the pass mesh. */
+		int count; /**< The number of vertices in the background. */
+	};
+
+	/**
+	 * Geometry drawn with one projection.
+	 */
+	struct Pass
+	{
+		bool clearColor;
+		bool clearDepth;
+		Color color; /**< The color that the color buffer is cleared to. */
+		double height;
+		SpriteBatch::Mesh mesh;
+		std::vector<Motion> motions;
+		std::vector<std::pair<unsigned int, int>> motionIndex; /**< Motion IDs and indices, sorted by ID. */
+		std::vector<Scroll> scrolls; /**< The backgrounds, in the order they were drawn. */
+		double width;
+	};
+
+	int passCount; /**< The number of passes in use. Passes past this are kept to reuse their memory. */
+	std::vector<Pass> passes;
+	mutable SpriteBatch::Mesh presentedMesh; /**< A copy of the pass mesh with the interpolated positions, kept to reuse its memory. */
+
+	/**
+	 * Find the motion with an ID in a pass.
+	 */
+	static const Motion* findMotion( const Pass& pass, unsigned int id );
+};
+
+#endif // RENDERSNAPSHOT_HPP
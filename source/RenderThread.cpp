@@ -0,0 +1,167 @@
+#include <algorithm>
+
+#include <SDL2/SDL.h>
+
+#include "Globals.hpp"
+#include "RenderSnapshot.hpp"
+#include "RenderThread.hpp"
+#include "Rendering.hpp"
+
+RenderThread::RenderThread() :
+	current(nullptr),
+	drawCalls(0),
+	frameRate(0.0f),
+	presentingCurrent(nullptr),
+	presentingPrevious(nullptr),
+	previous(nullptr),
+	quitting(false),
+	recording(nullptr),
+	submitCount(0),
+	vertices(0)
+{
+	// The context can only be current on one thread at a time
+	SDL_GL_MakeCurrent((SDL_Window*)window, nullptr);
+	thread = std::thread(&RenderThread::threadMain, this);
+}
+
+RenderThread::~RenderThread()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quitting = true;
+	}
+	submitCondition.notify_one();
+	thread.join();
+
+	SDL_GL_MakeCurrent((SDL_Window*)window, (SDL_GLContext)glContext);
+}
+
+RenderSnapshot& RenderThread::beginSnapshot()
+{
+	// Reuse a snapshot that neither thread is using
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if( freeSnapshots.empty() )
+		{
+			recording = nullptr;
+		}
+		else
+		{
+			recording = freeSnapshots.back();
+			freeSnapshots.pop_back();
+		}
+	}
+	if( recording == nullptr )
+	{
+		snapshots.emplace_back(new RenderSnapshot);
+		recording = snapshots.back().get();
+	}
+
+	recording->reset();
+	return *recording;
+}
+
+int RenderThread::getDrawCallCount() const
+{
+	return drawCalls;
+}
+
+float RenderThread::getFrameRate() const
+{
+	return frameRate;
+}
+
+int RenderThread::getVertexCount() const
+{
+	return vertices;
+}
+
+void RenderThread::releaseSnapshot( RenderSnapshot* snapshot )
+{
+	if( snapshot != nullptr && snapshot != current && snapshot != previous &&
+		snapshot != presentingCurrent && snapshot != presentingPrevious )
+	{
+		freeSnapshots.push_back(snapshot);
+	}
+}
+
+void RenderThread::submit()
+{
+	recording->finish();
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		RenderSnapshot* dropped = previous;
+		previous = current;
+		current = recording;
+		recording = nullptr;
+		currentTime = Clock::now();
+		submitCount++;
+
+		// If the snapshot is still being presented, the render thread releases it when it is done
+		releaseSnapshot(dropped);
+	}
+	submitCondition.notify_one();
+}
+
+void RenderThread::threadMain()
+{
+	SDL_GL_MakeCurrent((SDL_Window*)window, (SDL_GLContext)glContext);
+
+	// Swapping buffers paces the thread to the display when vsync is available.
+	// Otherwise, present once for every snapshot.
+	bool vsync = (SDL_GL_SetSwapInterval(1) == 0);
+
+	unsigned int presentedCount = 0;
+	int frameCount = 0;
+	Clock::time_point frameRateTime = Clock::now();
+	while( true )
+	{
+		RenderSnapshot* currentSnapshot;
+		RenderSnapshot* previousSnapshot;
+		Clock::time_point snapshotTime;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			submitCondition.wait(lock, [&]{ return quitting || (submitCount > 0 && (vsync || submitCount != presentedCount)); });
+			if( quitting )
+			{
+				break;
+			}
+			currentSnapshot = current;
+			previousSnapshot = previous;
+			presentingCurrent = current;
+			presentingPrevious = previous;
+			snapshotTime = currentTime;
+			presentedCount = submitCount;
+		}
+
+		// Place objects by how far along we are to the next snapshot
+		double alpha = std::chrono::duration<double>(Clock::now() - snapshotTime).count() / GAME_DELTA;
+		alpha = std::min(std::max(alpha, 0.0), 1.0);
+		currentSnapshot->render(batch, previousSnapshot, alpha);
+		batch.finishFrame();
+
+		// Give back the snapshots that were replaced while they were presented
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			presentingCurrent = nullptr;
+			presentingPrevious = nullptr;
+			releaseSnapshot(currentSnapshot);
+			releaseSnapshot(previousSnapshot);
+		}
+		drawCalls = batch.getDrawCallCount();
+		vertices = batch.getVertexCount();
+		renderPresent();
+
+		frameCount++;
+		double seconds = std::chrono::duration<double>(Clock::now() - frameRateTime).count();
+		if( seconds >= 1.0 )
+		{
+			frameRate = static_cast<float>(frameCount / seconds);
+			frameCount = 0;
+			frameRateTime = Clock::now();
+		}
+	}
+
+	SDL_GL_MakeCurrent((SDL_Window*)window, nullptr);
+}
@@ -0,0 +1,98 @@
+#ifndef RENDERTHREAD_HPP
+#define RENDERTHREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "SpriteBatch.hpp"
+
+class RenderSnapshot;
+
+/**
+ * Presents RenderSnapshots on a thread of its own, so that a slow frame on
+ * either the simulation or the graphics side doesn't hold up the other.
+ * The thread owns the OpenGL context while it runs, and presents as often
+ * as the display refreshes, placing moving objects between the last two
+ * snapshots it was given. This adds one simulation frame of latency.
+ *
+ * Snapshots are recycled: the simulation thread records into the snapshot
+ * returned by beginSnapshot(), and then hands it over with submit(). Once
+ * a snapshot is neither one of the last two submitted nor being presented,
+ * it goes back to a free list for beginSnapshot() to take from.
+ */
+class RenderThread
+{
+public:
+	/**
+	 * Take the OpenGL context from the calling thread and start presenting.
+	 */
+	RenderThread();
+
+	/**
+	 * Stop presenting and give the OpenGL context back to the calling thread.
+	 */
+	~RenderThread();
+
+	/**
+	 * Get a snapshot to record the next frame into. It is reset and ready
+	 * for its first pass.
+	 */
+	RenderSnapshot& beginSnapshot();
+
+	/**
+	 * Get the number of draw calls made to present the last frame.
+	 */
+	int getDrawCallCount() const;
+
+	/**
+	 * Get the number of frames presented per second.
+	 */
+	float getFrameRate() const;
+
+	/**
+	 * Get the number of vertices drawn to present the last frame.
+	 */
+	int getVertexCount() const;
+
+	/**
+	 * Finish the snapshot returned by beginSnapshot() and hand it over to be
+	 * presented.
+	 */
+	void submit();
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	SpriteBatch batch; /**< The batch used to present, since the global one records on the simulation thread. */
+	RenderSnapshot* current; /**< The latest snapshot. */
+	Clock::time_point currentTime; /**< When the latest snapshot was submitted. */
+	std::atomic<int> drawCalls;
+	std::atomic<float> frameRate;
+	std::vector<RenderSnapshot*> freeSnapshots; /**< Snapshots that neither thread is using. */
+	std::mutex mutex;
+	RenderSnapshot* presentingCurrent; /**< The latest snapshot being presented, or nullptr. */
+	RenderSnapshot* presentingPrevious; /**< The snapshot before it being presented, or nullptr. */
+	RenderSnapshot* previous; /**< The snapshot before the latest one. */
+	bool quitting;
+	RenderSnapshot* recording; /**< The snapshot being recorded. */
+	std::vector<std::unique_ptr<RenderSnapshot>> snapshots; /**< Every snapshot, which are owned by the simulation thread. */
+	std::condition_variable submitCondition;
+	unsigned int submitCount; /**< The number of snapshots submitted so far. */
+	std::thread thread;
+	std::atomic<int> vertices;
+
+	/**
+	 * Put a snapshot on the free list if it is no longer submitted or being
+	 * presented. The mutex must be locked.
+	 */
+	void releaseSnapshot( RenderSnapshot* snapshot );
+
+	void threadMain();
+};
+
+#endif // RENDERTHREAD_HPP
@@ -1,8 +1,34 @@
+#include <SDL2/SDL.h>
 #include <SDL2/SDL_opengl.h>
 
 #include "Globals.hpp"
 #include "Rendering.hpp"
 
+// Framebuffer functions, which have to be loaded at run time
+static PFNGLBINDFRAMEBUFFERPROC glBindFramebufferPointer = nullptr;
+static PFNGLBINDRENDERBUFFERPROC glBindRenderbufferPointer = nullptr;
+static PFNGLBLITFRAMEBUFFERPROC glBlitFramebufferPointer = nullptr;
+static PFNGLCHECKFRAMEBUFFERSTATUSPROC glCheckFramebufferStatusPointer = nullptr;
+static PFNGLDELETEFRAMEBUFFERSPROC glDeleteFramebuffersPointer = nullptr;
+static PFNGLDELETERENDERBUFFERSPROC glDeleteRenderbuffersPointer = nullptr;
+static PFNGLFRAMEBUFFERRENDERBUFFERPROC glFramebufferRenderbufferPointer = nullptr;
+static PFNGLGENFRAMEBUFFERSPROC glGenFramebuffersPointer = nullptr;
+static PFNGLGENRENDERBUFFERSPROC glGenRenderbuffersPointer = nullptr;
+static PFNGLRENDERBUFFERSTORAGEPROC glRenderbufferStoragePointer = nullptr;
+
+static GLuint framebuffer = 0; /**< The framebuffer that frames are drawn into, or 0 to draw to the window. */
+static GLuint framebufferColor = 0;
+static GLuint framebufferDepth = 0;
+
+/**
+ * Draw into the framebuffer, with a viewport that covers it.
+ */
+static void bindFramebuffer()
+{
+	glBindFramebufferPointer(GL_FRAMEBUFFER, framebuffer);
+	glViewport(0, 0, SETTINGS.getRenderedScreenWidth(), SETTINGS.getRenderedScreenHeight());
+}
+
 void renderClampView( double& viewX, double& viewY, double viewWidth, double viewHeight, int width, int height )
 {
 	if( width < viewWidth || viewX - viewWidth / 2.0 < 0 )
@@ -40,6 +66,68 @@ void renderClearScreen( float r, float g, float b, float a )
 	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
 }
 
+bool renderCreateFramebuffer()
+{
+	glBindFramebufferPointer = (PFNGLBINDFRAMEBUFFERPROC)SDL_GL_GetProcAddress("glBindFramebuffer");
+	glBindRenderbufferPointer = (PFNGLBINDRENDERBUFFERPROC)SDL_GL_GetProcAddress("glBindRenderbuffer");
+	glBlitFramebufferPointer = (PFNGLBLITFRAMEBUFFERPROC)SDL_GL_GetProcAddress("glBlitFramebuffer");
+	glCheckFramebufferStatusPointer = (PFNGLCHECKFRAMEBUFFERSTATUSPROC)SDL_GL_GetProcAddress("glCheckFramebufferStatus");
+	glDeleteFramebuffersPointer = (PFNGLDELETEFRAMEBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteFramebuffers");
+	glDeleteRenderbuffersPointer = (PFNGLDELETERENDERBUFFERSPROC)SDL_GL_GetProcAddress("glDeleteRenderbuffers");
+	glFramebufferRenderbufferPointer = (PFNGLFRAMEBUFFERRENDERBUFFERPROC)SDL_GL_GetProcAddress("glFramebufferRenderbuffer");
+	glGenFramebuffersPointer = (PFNGLGENFRAMEBUFFERSPROC)SDL_GL_GetProcAddress("glGenFramebuffers");
+	glGenRenderbuffersPointer = (PFNGLGENRENDERBUFFERSPROC)SDL_GL_GetProcAddress("glGenRenderbuffers");
+	glRenderbufferStoragePointer = (PFNGLRENDERBUFFERSTORAGEPROC)SDL_GL_GetProcAddress("glRenderbufferStorage");
+	if( glBindFramebufferPointer == nullptr || glBindRenderbufferPointer == nullptr || glBlitFramebufferPointer == nullptr ||
+		glCheckFramebufferStatusPointer == nullptr || glDeleteFramebuffersPointer == nullptr || glDeleteRenderbuffersPointer == nullptr ||
+		glFramebufferRenderbufferPointer == nullptr || glGenFramebuffersPointer == nullptr || glGenRenderbuffersPointer == nullptr ||
+		glRenderbufferStoragePointer == nullptr )
+	{
+		return false;
+	}
+
+	int width = SETTINGS.getRenderedScreenWidth();
+	int height = SETTINGS.getRenderedScreenHeight();
+
+	glGenRenderbuffersPointer(1, &framebufferColor);
+	glBindRenderbufferPointer(GL_RENDERBUFFER, framebufferColor);
+	glRenderbufferStoragePointer(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glGenRenderbuffersPointer(1, &framebufferDepth);
+	glBindRenderbufferPointer(GL_RENDERBUFFER, framebufferDepth);
+	glRenderbufferStoragePointer(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+	glBindRenderbufferPointer(GL_RENDERBUFFER, 0);
+
+	glGenFramebuffersPointer(1, &framebuffer);
+	glBindFramebufferPointer(GL_FRAMEBUFFER, framebuffer);
+	glFramebufferRenderbufferPointer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, framebufferColor);
+	glFramebufferRenderbufferPointer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, framebufferDepth);
+	if( glCheckFramebufferStatusPointer(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE )
+	{
+		renderFreeFramebuffer();
+		return false;
+	}
+
+	bindFramebuffer();
+	return true;
+}
+
+void renderFreeFramebuffer()
+{
+	if( glBindFramebufferPointer == nullptr )
+	{
+		return;
+	}
+
+	glBindFramebufferPointer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, SETTINGS.screenWidth, SETTINGS.screenHeight);
+	glDeleteFramebuffersPointer(1, &framebuffer);
+	glDeleteRenderbuffersPointer(1, &framebufferColor);
+	glDeleteRenderbuffersPointer(1, &framebufferDepth);
+	framebuffer = 0;
+	framebufferColor = 0;
+	framebufferDepth = 0;
+}
+
 int renderGetScreenHeight()
 {
 	return SETTINGS.screenHeight / SETTINGS.scale;
@@ -50,8 +138,35 @@ int renderGetScreenWidth()
 	return SETTINGS.screenWidth / SETTINGS.scale;
 }
 
+void renderPresent()
+{
+	if( framebuffer == 0 )
+	{
+		SDL_GL_SwapWindow((SDL_Window*)window);
+		return;
+	}
+
+	// Upscale the frame by a whole number, centered in the window
+	int width = SETTINGS.getRenderedScreenWidth();
+	int height = SETTINGS.getRenderedScreenHeight();
+	int left = (SETTINGS.screenWidth - width * SETTINGS.scale) / 2;
+	int bottom = (SETTINGS.screenHeight - height * SETTINGS.scale) / 2;
+
+	glBindFramebufferPointer(GL_READ_FRAMEBUFFER, framebuffer);
+	glBindFramebufferPointer(GL_DRAW_FRAMEBUFFER, 0);
+	glViewport(0, 0, SETTINGS.screenWidth, SETTINGS.screenHeight);
+	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glBlitFramebufferPointer(0, 0, width, height, left, bottom, left + width * SETTINGS.scale, bottom + height * SETTINGS.scale, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+	SDL_GL_SwapWindow((SDL_Window*)window);
+
+	bindFramebuffer();
+}
+
 void renderSetUnitsToPixels()
 {
+	SPRITE_BATCH.flush();
+	SPRITE_BATCH.loadIdentity();
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	glOrtho(0.0, SETTINGS.getRenderedScreenWidth(), 0.0, SETTINGS.getRenderedScreenHeight(), -10.0, 10.0);
@@ -61,5 +176,6 @@ void renderSetUnitsToPixels()
 
 void renderSwapBuffers()
 {
-	SDL_GL_SwapWindow((SDL_Window*)window);
+	SPRITE_BATCH.finishFrame();
+	renderPresent();
 }
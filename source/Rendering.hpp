@@ -27,6 +27,23 @@ void renderClampView( double& viewX, double& viewY, double viewWidth, double vie
  */
 void renderClearScreen( float r = 0.0f, float g = 0.0f, float b = 0.0f, float a = 0.5f);
 
+/**
+ * Create a framebuffer at the rendered screen size, and draw everything
+ * into it from now on. Each frame is then upscaled to the window by the
+ * screen scale when it is presented, so the cost of drawing doesn't depend
+ * on the window size.
+ *
+ * @return false if framebuffers aren't supported, in which case everything
+ * is still drawn to the window directly.
+ */
+bool renderCreateFramebuffer();
+
+/**
+ * Free the framebuffer created by renderCreateFramebuffer(), and draw to the
+ * window directly again.
+ */
+void renderFreeFramebuffer();
+
 /**
  * Get the height of the screen in pixels.
  */
@@ -38,12 +55,19 @@ int renderGetScreenHeight();
 int renderGetScreenWidth();
 
 /**
- * Set the matrix units to represent individual pixels on the screen.
+ * Show the frame that was drawn on the window, upscaling it if there is a
+ * framebuffer.
+ */
+void renderPresent();
+
+/**
+ * Set the matrix units to represent individual pixels on the screen. This
+ * flushes the SpriteBatch and resets its transform.
  */
 void renderSetUnitsToPixels();
 
 /**
- * Swap screen buffers.
+ * Finish the frame in the SpriteBatch and swap screen buffers.
  */
 void renderSwapBuffers();
 
@@ -0,0 +1,200 @@
+#include <cstring>
+#include <fstream>
+
+#include "Replay.hpp"
+
+static const char REPLAY_MAGIC[4] = { 'M', 'R', 'P', 'L' }; /**< Identifies replay files. */
+static const unsigned int REPLAY_VERSION = 3; /**< The version of the replay file format. Version 1 had no paused frames, and version 2 had no view size. */
+
+// Values are stored little endian, regardless of the platform
+static void writeUnsigned( std::ofstream& file, unsigned int value )
+{
+	char bytes[4];
+	for( int i = 0; i < 4; ++i )
+	{
+		bytes[i] = static_cast<char>((value >> (i * 8)) & 0xff);
+	}
+	file.write(bytes, 4);
+}
+
+static unsigned int readUnsigned( std::ifstream& file )
+{
+	unsigned char bytes[4] = { 0, 0, 0, 0 };
+	file.read(reinterpret_cast<char*>(bytes), 4);
+	unsigned int value = 0;
+	for( int i = 0; i < 4; ++i )
+	{
+		value |= static_cast<unsigned int>(bytes[i]) << (i * 8);
+	}
+	return value;
+}
+
+Replay::Replay( unsigned int levelSeed ) :
+	levelSeed(levelSeed),
+	playerState(0),
+	viewHeight(0),
+	viewWidth(0),
+	worldSeed(0)
+{
+}
+
+void Replay::addFrame( const InputManager::Controller& controller, unsigned int hash, bool paused )
+{
+	Frame frame;
+	frame.buttons = 0;
+	for( int i = 0; i < NUM_BUTTONS; ++i )
+	{
+		if( controller.getButtonState(static_cast<InputButton>(i)) )
+		{
+			frame.buttons |= (1 << i);
+		}
+	}
+	frame.hash = hash;
+	frame.paused = paused;
+	frames.push_back(frame);
+}
+
+void Replay::beginRecording( unsigned int worldSeed, int playerState, int viewWidth, int viewHeight )
+{
+	this->worldSeed = worldSeed;
+	this->playerState = playerState;
+	this->viewWidth = viewWidth;
+	this->viewHeight = viewHeight;
+	frames.clear();
+}
+
+void Replay::clearFrames()
+{
+	frames.clear();
+}
+
+int Replay::getFrameCount() const
+{
+	return frames.size();
+}
+
+unsigned int Replay::getHash( int frame ) const
+{
+	return frames[frame].hash;
+}
+
+unsigned int Replay::getLevelSeed() const
+{
+	return levelSeed;
+}
+
+int Replay::getPlayerState() const
+{
+	return playerState;
+}
+
+int Replay::getViewHeight() const
+{
+	return viewHeight;
+}
+
+int Replay::getViewWidth() const
+{
+	return viewWidth;
+}
+
+unsigned int Replay::getWorldSeed() const
+{
+	return worldSeed;
+}
+
+bool Replay::isFramePaused( int frame ) const
+{
+	return frames[frame].paused;
+}
+
+bool Replay::load( const std::string& fileName )
+{
+	std::ifstream file(fileName.c_str(), std::ios::binary);
+	char magic[4];
+	if( !file.read(magic, 4) || std::memcmp(magic, REPLAY_MAGIC, 4) != 0 )
+	{
+		return false;
+	}
+	unsigned int version = readUnsigned(file);
+	if( version < 1 || version > REPLAY_VERSION )
+	{
+		return false;
+	}
+
+	levelSeed = readUnsigned(file);
+	worldSeed = readUnsigned(file);
+	playerState = static_cast<int>(readUnsigned(file));
+	viewWidth = 0;
+	viewHeight = 0;
+	if( version >= 3 )
+	{
+		viewWidth = static_cast<int>(readUnsigned(file));
+		viewHeight = static_cast<int>(readUnsigned(file));
+	}
+	unsigned int frameCount = readUnsigned(file);
+	if( !file )
+	{
+		return false;
+	}
+
+	frames.clear();
+	frames.reserve(frameCount);
+	for( unsigned int i = 0; i < frameCount; ++i )
+	{
+		Frame frame;
+		char buttons;
+		file.read(&buttons, 1);
+		frame.buttons = static_cast<unsigned char>(buttons);
+		frame.hash = readUnsigned(file);
+		frame.paused = false;
+		if( version >= 2 )
+		{
+			char paused;
+			file.read(&paused, 1);
+			frame.paused = paused != 0;
+		}
+		frames.push_back(frame);
+	}
+
+	return static_cast<bool>(file);
+}
+
+void Replay::playFrame( int frame, InputManager::Controller& controller ) const
+{
+	for( int i = 0; i < NUM_BUTTONS; ++i )
+	{
+		controller.setButtonState( static_cast<InputButton>(i), (frames[frame].buttons & (1 << i)) != 0 );
+	}
+}
+
+void Replay::recordFrame( const InputManager::Controller& controller, unsigned int hash )
+{
+	addFrame(controller, hash, false);
+}
+
+void Replay::recordPausedFrame( const InputManager::Controller& controller, unsigned int hash )
+{
+	addFrame(controller, hash, true);
+}
+
+bool Replay::save( const std::string& fileName ) const
+{
+	std::ofstream file(fileName.c_str(), std::ios::binary);
+	file.write(REPLAY_MAGIC, 4);
+	writeUnsigned(file, REPLAY_VERSION);
+	writeUnsigned(file, levelSeed);
+	writeUnsigned(file, worldSeed);
+	writeUnsigned(file, static_cast<unsigned int>(playerState));
+	writeUnsigned(file, static_cast<unsigned int>(viewWidth));
+	writeUnsigned(file, static_cast<unsigned int>(viewHeight));
+	writeUnsigned(file, frames.size());
+	for( auto& frame : frames )
+	{
+		file.put(static_cast<char>(frame.buttons));
+		writeUnsigned(file, frame.hash);
+		file.put(frame.paused ? 1 : 0);
+	}
+
+	return static_cast<bool>(file);
+}
@@ -0,0 +1,146 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <string>
+#include <vector>
+
+#include "InputManager.hpp"
+
+/**
+ * A recording of an attempt at an infinity mode level. It stores the random
+ * seeds used to generate the level and to run the World, the controller
+ * buttons held during every frame, a hash of the World state after every
+ * frame, and the size of the view, since sprites are spawned and updated
+ * depending on their distance from it. Frames spent paused are recorded too, so that buttons pressed and
+ * released during a pause reach the listeners when played back. Playing it
+ * back reproduces the attempt exactly, so the hashes can be compared to find
+ * where a simulation diverges.
+ */
+class Replay
+{
+public:
+	/**
+	 * Create an empty replay.
+	 *
+	 * @param levelSeed the seed used to generate the level.
+	 */
+	Replay( unsigned int levelSeed = 0 );
+
+	/**
+	 * Start recording an attempt at the level, discarding any recorded frames.
+	 *
+	 * @param worldSeed the seed of the World's random number generator.
+	 * @param playerState the powerup state of the Player when the attempt started.
+	 * @param viewWidth the width of the view, in rendered pixels.
+	 * @param viewHeight the height of the view, in rendered pixels.
+	 */
+	void beginRecording( unsigned int worldSeed, int playerState, int viewWidth, int viewHeight );
+
+	/**
+	 * Discard the recorded frames, after they have been saved.
+	 */
+	void clearFrames();
+
+	/**
+	 * Get the number of recorded frames.
+	 */
+	int getFrameCount() const;
+
+	/**
+	 * Get the hash of the World state recorded after a frame.
+	 */
+	unsigned int getHash( int frame ) const;
+
+	/**
+	 * Get the seed used to generate the level.
+	 */
+	unsigned int getLevelSeed() const;
+
+	/**
+	 * Get the powerup state of the Player when the attempt started.
+	 */
+	int getPlayerState() const;
+
+	/**
+	 * Get the height of the view, in rendered pixels, or 0 if the replay
+	 * was saved before the view size was recorded.
+	 */
+	int getViewHeight() const;
+
+	/**
+	 * Get the width of the view, in rendered pixels, or 0 if the replay
+	 * was saved before the view size was recorded.
+	 */
+	int getViewWidth() const;
+
+	/**
+	 * Get the seed of the World's random number generator.
+	 */
+	unsigned int getWorldSeed() const;
+
+	/**
+	 * Check if the game was paused during a frame, so the World wasn't updated.
+	 */
+	bool isFramePaused( int frame ) const;
+
+	/**
+	 * Load a replay from a file.
+	 *
+	 * @return true if the replay was loaded successfully.
+	 */
+	bool load( const std::string& fileName );
+
+	/**
+	 * Set the buttons of a controller to the states recorded for a frame.
+	 * Listeners are notified of buttons that change state.
+	 */
+	void playFrame( int frame, InputManager::Controller& controller ) const;
+
+	/**
+	 * Record a frame after the World has been updated.
+	 *
+	 * @param controller the controller used during the frame.
+	 * @param hash the hash of the World state after the frame.
+	 */
+	void recordFrame( const InputManager::Controller& controller, unsigned int hash );
+
+	/**
+	 * Record a frame during which the game was paused.
+	 *
+	 * @param controller the controller used during the frame.
+	 * @param hash the hash of the World state, which the frame didn't change.
+	 */
+	void recordPausedFrame( const InputManager::Controller& controller, unsigned int hash );
+
+	/**
+	 * Save the replay to a file.
+	 *
+	 * @return true if the replay was saved successfully.
+	 */
+	bool save( const std::string& fileName ) const;
+
+private:
+	/**
+	 * A single recorded frame.
+	 */
+	struct Frame
+	{
+		unsigned char buttons; /**< Bit mask of the buttons held, one bit per InputButton. */
+		unsigned int hash;     /**< Hash of the World state after the frame. */
+		bool paused;           /**< Whether the World was paused, and not updated, during the frame. */
+	};
+
+	/**
+	 * Record a frame, whether or not the game was paused during it.
+	 */
+	void addFrame( const InputManager::Controller& controller, unsigned int hash, bool paused );
+
+	std::vector<Frame> frames;
+	unsigned int levelSeed;
+	int playerState;
+	int viewHeight;
+	int viewWidth;
+	unsigned int worldSeed;
+};
+
+#endif // REPLAY_HPP
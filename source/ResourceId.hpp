@@ -0,0 +1,6 @@
+#ifndef RESOURCEID_HPP
+#define RESOURCEID_HPP
+
+typedef int ResourceId; /**< Identifies a resource name, or a key of a resource group, without the string. */
+
+#endif // RESOURCEID_HPP
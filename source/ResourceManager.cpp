@@ -1,8 +1,12 @@
+#include <algorithm>
 #include <cstdlib>
+#include <cstring>
+#include <thread>
 
 #include <rapidxml_utils.hpp>
 
 #include "Animation.hpp"
+#include "AtlasPacker.hpp"
 #include "Background.hpp"
 #include "BitmapFont.hpp"
 #include "Exception.hpp"
@@ -13,34 +17,241 @@
 #include "ResourceManager.hpp"
 #include "Sound.hpp"
 #include "Texture.hpp"
+#include "ThreadPool.hpp"
 
 using namespace rapidxml;
 
+static const int ATLAS_SIZE = 2048; /**< The size of each page of the texture atlas. Frames that don't fit on one page go on another. */
+
+static std::map<std::string, ResourceId> resourceIds; /**< The id of every resource name and group key. Ids are only given out while resources are loaded. */
+
+/**
+ * An image used by animations, decoded ahead of time along with a table for
+ * finding blank frames quickly.
+ */
+struct AnimationImage
+{
+	std::string error; /**< Why the image couldn't be decoded, if it couldn't. */
+	Image* image;
+	std::vector<int> opaqueCounts; /**< The number of opaque pixels above and to the left of each pixel, with an extra row and column of zeros. */
+
+	AnimationImage() :
+		image(nullptr)
+	{
+	}
+
+	~AnimationImage()
+	{
+		delete image;
+	}
+
+	/**
+	 * Decode the image and count its opaque pixels. This is safe to call on
+	 * any thread.
+	 */
+	void decode( const std::string& fileName )
+	{
+		try
+		{
+			image = new Image(fileName);
+		}
+		catch( std::exception& e )
+		{
+			error = e.what();
+			return;
+		}
+
+		int width = image->getWidth();
+		int height = image->getHeight();
+		const Color* pixels = image->getPixels();
+		opaqueCounts.assign((width + 1) * (height + 1), 0);
+		for( int y = 0; y < height; y++ )
+		{
+			int rowCount = 0;
+			for( int x = 0; x < width; x++ )
+			{
+				if( pixels[y * width + x].a != 0 )
+				{
+					rowCount++;
+				}
+				opaqueCounts[(y + 1) * (width + 1) + x + 1] = opaqueCounts[y * (width + 1) + x + 1] + rowCount;
+			}
+		}
+	}
+
+	/**
+	 * Check if every pixel of a rectangle of the image is transparent.
+	 * Pixels outside of the image are read as opaque black, the same as
+	 * Image::getPixel().
+	 */
+	bool isBlank( int x, int y, int w, int h ) const
+	{
+		if( w <= 0 || h <= 0 )
+		{
+			return true;
+		}
+
+		int width = image->getWidth();
+		if( x < 0 || y < 0 || x + w > width || y + h > image->getHeight() )
+		{
+			return false;
+		}
+
+		int opaque = opaqueCounts[(y + h) * (width + 1) + x + w] - opaqueCounts[y * (width + 1) + x + w] -
+			opaqueCounts[(y + h) * (width + 1) + x] + opaqueCounts[y * (width + 1) + x];
+		return opaque == 0;
+	}
+};
+
+/**
+ * A frame of an animation that shows an atlas slot, and gets its texture
+ * coordinates once the slot is placed.
+ */
+struct PendingFrame
+{
+	Animation* animation;
+	int sequence;
+	int slot;
+	bool mirrorX;
+	bool mirrorY;
+};
+
+/**
+ * Copy a rectangle of one image into another. Pixels outside of the source
+ * are read as opaque black, and pixels outside of the destination are
+ * dropped, the same as Image::getPixel() and Image::setPixel().
+ */
+static void copyImageRect( const Image& source, int x, int y, int w, int h, Image& destination, int destinationX, int destinationY )
+{
+	// Copy whole rows when the rectangle is inside both images
+	if( x >= 0 && y >= 0 && x + w <= source.getWidth() && y + h <= source.getHeight() &&
+		destinationX >= 0 && destinationY >= 0 && destinationX + w <= destination.getWidth() && destinationY + h <= destination.getHeight() )
+	{
+		for( int b = 0; b < h; ++b )
+		{
+			const Color* row = source.getPixels() + (y + b) * source.getWidth() + x;
+			std::copy(row, row + w, destination.getPixels() + (destinationY + b) * destination.getWidth() + destinationX);
+		}
+		return;
+	}
+
+	for( int b = 0; b < h; ++b )
+	{
+		for( int a = 0; a < w; ++a )
+		{
+			destination.setPixel(destinationX + a, destinationY + b, source.getPixel(x + a, y + b));
+		}
+	}
+}
+
 static std::string getResourceFileName( const std::string& relativeFileName )
 {
 	return std::string("resources/") + relativeFileName;
 }
 
+/**
+ * Hash the pixels of a rectangle of an image with FNV-1a, row by row, after
+ * mirroring it. The hash depends on the order of the pixels, so each way of
+ * mirroring a rectangle has a hash of its own.
+ */
+static unsigned long long hashImageRect( const Image& image, int x, int y, int w, int h, bool mirrorX, bool mirrorY )
+{
+	unsigned long long hash = 0xcbf29ce484222325ull;
+	auto hashBytes = [&hash]( const unsigned char* bytes, std::size_t count )
+	{
+		for( std::size_t i = 0; i < count; ++i )
+		{
+			hash ^= bytes[i];
+			hash *= 0x100000001b3ull;
+		}
+	};
+	hashBytes(reinterpret_cast<const unsigned char*>(&w), sizeof(w));
+	hashBytes(reinterpret_cast<const unsigned char*>(&h), sizeof(h));
+
+	bool inside = x >= 0 && y >= 0 && x + w <= image.getWidth() && y + h <= image.getHeight();
+	for( int b = 0; b < h; ++b )
+	{
+		int row = y + (mirrorY ? h - 1 - b : b);
+
+		// Hash whole rows when they are inside the image and read in order
+		if( inside && !mirrorX )
+		{
+			hashBytes(reinterpret_cast<const unsigned char*>(image.getPixels() + row * image.getWidth() + x), w * sizeof(Color));
+			continue;
+		}
+
+		for( int a = 0; a < w; ++a )
+		{
+			Color pixel = image.getPixel(x + (mirrorX ? w - 1 - a : a), row);
+			hashBytes(reinterpret_cast<const unsigned char*>(&pixel), sizeof(pixel));
+		}
+	}
+	return hash;
+}
+
+/**
+ * Check if a rectangle of one image has the same pixels as a rectangle of
+ * another image, after mirroring the second one.
+ */
+static bool isSameImageRect( const Image& image, int x, int y, const Image& other, int otherX, int otherY, int w, int h, bool mirrorX, bool mirrorY )
+{
+	// Compare whole rows when the rectangles are inside both images
+	if( !mirrorX &&
+		x >= 0 && y >= 0 && x + w <= image.getWidth() && y + h <= image.getHeight() &&
+		otherX >= 0 && otherY >= 0 && otherX + w <= other.getWidth() && otherY + h <= other.getHeight() )
+	{
+		for( int b = 0; b < h; ++b )
+		{
+			const Color* row = image.getPixels() + (y + b) * image.getWidth() + x;
+			const Color* otherRow = other.getPixels() + (otherY + (mirrorY ? h - 1 - b : b)) * other.getWidth() + otherX;
+			if( std::memcmp(row, otherRow, w * sizeof(Color)) != 0 )
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	for( int b = 0; b < h; ++b )
+	{
+		for( int a = 0; a < w; ++a )
+		{
+			Color pixel = image.getPixel(x + a, y + b);
+			Color otherPixel = other.getPixel(otherX + (mirrorX ? w - 1 - a : a), otherY + (mirrorY ? h - 1 - b : b));
+			if( pixel.r != otherPixel.r || pixel.g != otherPixel.g || pixel.b != otherPixel.b || pixel.a != otherPixel.a )
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 ResourceManager::ResourceManager() :
+	bakingPack(nullptr),
 	isMainResourceManager(true),
-	textureAtlas(nullptr),
-	atlasImage(nullptr),
-	atlasX(0),
-	atlasY(0),
-	atlasMaxHeight(0),
-	parent(nullptr)
+	loadErrors(0),
+	atlasPacker(nullptr),
+	defaultGroup(nullptr),
+	parent(nullptr),
+	threadPool(nullptr)
 {
 }
 
-ResourceManager::ResourceManager( const ResourceManager& parent ) :
+ResourceManager::ResourceManager( const ResourceManager* parent ) :
+	bakingPack(nullptr),
 	isMainResourceManager(false),
-	textureAtlas(nullptr),
-	atlasImage(nullptr),
-	atlasX(0),
-	atlasY(0),
-	atlasMaxHeight(0),
-	parent(&parent)
+	loadErrors(0),
+	atlasPacker(nullptr),
+	defaultGroup(nullptr),
+	parent(parent),
+	threadPool(nullptr)
 {
+	// Share everything the parent has, so that finding a resource never has to look through the parents
+	if( parent != nullptr )
+	{
+		resourceTable = parent->resourceTable;
+	}
 }
 
 ResourceManager::~ResourceManager()
@@ -52,10 +263,18 @@ ResourceManager::~ResourceManager()
 	}
 
 	// Free the texture atlas
-	delete textureAtlas;
+	for( auto texture : textureAtlases )
+	{
+		delete texture;
+	}
 
-	// Free the texture atlas image if it is still loaded in memory
-	delete atlasImage;
+	// Free the texture atlas images if they are still loaded in memory
+	for( auto image : atlasImages )
+	{
+		delete image;
+	}
+	delete atlasPacker;
+	delete threadPool;
 
 	// Free all other textures
 	for( auto texture : textures )
@@ -99,17 +318,470 @@ ResourceManager::~ResourceManager()
 	LOG << "Done.\n";
 }
 
-void ResourceManager::bindTextureAtlas() const
+void ResourceManager::addResource( const std::string& name, const Resource& resource )
 {
-	if( textureAtlas != nullptr )
+	Resource& stored = resources[name];
+	stored = resource;
+
+	// Point the table at the resource, growing it for a new name
+	ResourceId id;
+	auto it = resourceIds.find(name);
+	if( it == resourceIds.end() )
+	{
+		id = resourceIds.size();
+		resourceIds[name] = id;
+	}
+	else
+	{
+		id = (*it).second;
+	}
+	if( id >= (int)resourceTable.size() )
+	{
+		resourceTable.resize(id + 1, nullptr);
+	}
+	resourceTable[id] = &stored;
+}
+
+bool ResourceManager::bakeResources( const std::string& resourceFileName, const std::string& packFileName )
+{
+	// Only the root level resource manager can load resources
+	assert(isMainResourceManager);
+
+	// Load the resource files, adding everything to the pack as it is loaded
+	ResourcePack pack;
+	bakingPack = &pack;
+	loadErrors = 0;
+	try
+	{
+		loadResourcesFromFile(resourceFileName);
+	}
+	catch( ... )
+	{
+		bakingPack = nullptr;
+		throw;
+	}
+	bakingPack = nullptr;
+
+	// A pack missing some of the resources would hide the error on every
+	// later run, so nothing is saved
+	bool saved = false;
+	if( loadErrors > 0 )
+	{
+		LOG << "Warning: not writing resource pack \"" << packFileName << "\", because " << loadErrors << " resource file(s) failed to load.\n";
+	}
+	else
+	{
+		// Only the rows of each atlas page that are used are saved
+		for( int i = 0; i < (int)atlasImages.size(); i++ )
+		{
+			int atlasHeight = atlasPacker->getUsedHeight(i);
+			Image* page = new Image(ATLAS_SIZE, atlasHeight);
+			std::copy(atlasImages[i]->getPixels(), atlasImages[i]->getPixels() + ATLAS_SIZE * atlasHeight, page->getPixels());
+			pack.atlasPages.push_back(page);
+		}
+
+		saved = pack.save(packFileName);
+		if( saved )
+		{
+			LOG << "Baked resources into pack \"" << packFileName << "\".\n";
+		}
+		else
+		{
+			LOG << "Warning: unable to write resource pack \"" << packFileName << "\".\n";
+		}
+	}
+
+	createTextureAtlas();
+
+	LOG << "Done loading resources.\n";
+	return saved;
+}
+
+void ResourceManager::createAnimation( const ResourcePack::AnimationEntry& entry )
+{
+	// The frames were already placed in the atlas and repeated for their durations
+	Animation* animation = new Animation(entry.horizontalOrientation, entry.verticalOrientation);
+	for( auto& frame : entry.frames )
+	{
+		animation->addFrame(frame);
+	}
+
+	Resource resource;
+	resource.type = RESOURCE_ANIMATION;
+	resource.animation = animation;
+	addResource(entry.name, resource);
+}
+
+void ResourceManager::createBackground( const ResourcePack::BackgroundEntry& entry )
+{
+	// Give each image a texture of its own, so that it can be tiled by
+	// wrapping the texture coordinates
+	std::vector<Texture*> imageTextures;
+	std::vector<Animation::Frame> frames;
+	for( auto image : entry.images )
 	{
-		textureAtlas->bind();
+		Texture* texture = new Texture( *image );
+		textures.push_back(texture);
+		imageTextures.push_back(texture);
+
+		Animation::Frame f;
+		f.left = 0.0;
+		f.right = 1.0;
+		f.bottom = 1.0;
+		f.top = 0.0;
+		f.xOffset = 0;
+		f.yOffset = 0;
+		f.width = (double)image->getWidth() / (double)UNIT_SIZE;
+		f.height = (double)image->getHeight() / (double)UNIT_SIZE;
+		frames.push_back(f);
 	}
+
+	// Create the animation, with the texture of each of its frames
+	Animation* animation = new Animation();
+	std::vector<const Texture*> frameTextures;
+	for( int i = 0; i < (int)entry.indices.size(); i++ )
+	{
+		animation->addFrame(frames[entry.indices[i]], entry.time );
+		for( int j = 0; j < entry.time; j++ )
+		{
+			frameTextures.push_back(imageTextures[entry.indices[i]]);
+		}
+	}
+	if( frameTextures.empty() )
+	{
+		LOG << "Warning: Ignoring background resource \"" << entry.name << "\" that did not have any frames.\n";
+		delete animation;
+		return;
+	}
+
+	// Create the background resource
+	Background* background = new Background( frameTextures, animation, entry.tiling, entry.parallaxX, entry.parallaxY );
+	Resource resource;
+	resource.type = RESOURCE_BACKGROUND;
+	resource.background = background;
+	addResource(entry.name, resource);
+
+	LOG << "Loaded background \"" << entry.name << "\".\n";
+}
+
+void ResourceManager::createFont( const ResourcePack::FontEntry& entry )
+{
+	BitmapFont* font = new BitmapFont(*entry.image, entry.charWidth, entry.charHeight);
+
+	// Add all characters to the font
+	for( auto& characters : entry.characters )
+	{
+		if( characters.number >= 0 )
+		{
+			font->addCharacters( characters.ch, characters.x, characters.y, characters.number );
+		}
+		else
+		{
+			font->addCharacter( characters.ch, characters.x, characters.y );
+		}
+	}
+
+	// Save the resource
+	Resource resource;
+	resource.type = RESOURCE_FONT;
+	resource.font = font;
+	addResource(entry.name, resource);
+
+	LOG << "Loaded font \"" << entry.name << "\" from file \"" << entry.fileName << "\".\n";
+}
+
+void ResourceManager::createGroup( const ResourcePack::GroupEntry& entry )
+{
+	// Check that the parent resource manager exists
+	const ResourceManager* parent = nullptr;
+	if( !entry.parent.empty() )
+	{
+		auto it = groups.find(entry.parent);
+		if( it != groups.end() )
+		{
+			parent = (*it).second;
+		}
+		else
+		{
+			LOG << "Warning: attempted to add a resource group \"" << entry.name << "with parent \"" <<
+				entry.parent << "\" which did not exist. The group will not be added.\n";
+			return;
+		}
+	}
+
+	auto it = groups.find(entry.name);
+	if( it != groups.end() )
+	{
+		LOG << "Warning: attempted to add a resource group to a name that was already being used: \"" <<
+			entry.name << "\". Any resources mapped by the resource group will not be available.\n";
+		return;
+	}
+
+	ResourceManager* group = new ResourceManager(parent);
+	groups.insert(it, std::pair<std::string, ResourceManager*>(entry.name, group));
+	if( entry.name == DEFAULT_RESOURCE_GROUP_NAME )
+	{
+		defaultGroup = group;
+	}
+
+	// Add all key-value pairs to the child
+	for( auto& groupKey : entry.keys )
+	{
+		// Check that it has a key-value pair specified
+		if( groupKey.key.empty() || (groupKey.value.empty() && (groupKey.animation.empty() || groupKey.index.empty())) )
+		{
+			LOG << "Warning: resource group \"" << entry.name << "\" had an invalid key-value pair specified. It will be ignored.\n";
+			continue;
+		}
+
+		// Check that the key is unique and that the value exists
+		const std::string& key = groupKey.key;
+		auto iter = group->resources.find(key);
+		if( iter != group->resources.end() )
+		{
+			LOG << "Warning: resource group \"" << entry.name << "\" specified a key that was already in use: \"" << key << "\".\n";
+			continue;
+		}
+
+		if( !groupKey.value.empty() )
+		{
+			const std::string& value = groupKey.value;
+			iter = resources.find(value);
+			if( iter == resources.end() )
+			{
+				LOG << "Warning: resource group \"" << entry.name << "\" specified a value for a resource that does not exist: \"" << value << "\".\n";
+				continue;
+			}
+
+			// Create the link to the resource
+			const Resource* resource = getResource(value);
+			Resource newResource(*resource);
+			group->addResource(key, newResource);
+
+			LOG << "Added resource key-value pair: " << key << " -> " << value << ".\n";
+		}
+		else
+		{
+			// Find the animation
+			const std::string& animationName = groupKey.animation;
+			const Animation* animation = getAnimation(animationName);
+			if( animation == nullptr )
+			{
+				LOG << "Warning: resource group \"" << entry.name << "\" with key \"" << key << "\" specified an animation that does not exist: \"" << animationName << "\".\n";
+				continue;
+			}
+
+			// Read the index as hex
+			int index = strtol( groupKey.index.c_str(), NULL, 16 );
+			if( index < 0 || index >= animation->getLength() )
+			{
+				LOG << "Warning: resource group name \"" << entry.name << "\" with key \"" << key << "\" specified an animation as its value with the following issue:\n";
+				LOG << "\tanimation frame for animation \"" << animationName << "\" had a bad index specified.\n";
+				continue;
+			}
+
+			// Check if we've loaded this frame before
+			std::string frameName = animationName + '[' + groupKey.index + ']';
+			const Animation* frameAnimation = getAnimation(frameName);
+			if( frameAnimation == nullptr )
+			{
+				// Does this name conflict with another resource that we've loaded? (Rare)
+				if( getResource(frameName) != nullptr )
+				{
+					LOG << "Warning: couldn't load key-value pair with key \"" << key << "\" and animation \"" << animationName;
+					LOG << "\" with index [" << index << "] since the name \"" << frameName << "\" was already being used for a different resource.\n";
+					continue;
+				}
+
+				// Create the animation
+				Animation* a = new Animation;
+				a->addFrame( animation->getFrame(index) );
+
+				//Store it in the resource map
+				Resource r;
+				r.animation = a;
+				r.type = RESOURCE_ANIMATION;
+				addResource(frameName, r);
+
+				// Now, create a link to it for the group
+				group->addResource(key, r);
+			}
+			else
+			{
+				// Just create a link to the animation frame resource since it's already been loaded
+				const Resource* resource = getResource(frameName);
+				Resource newResource(*resource);
+				group->addResource(key, newResource);
+			}
+
+			LOG << "Added resource key-value pair (with implicit animation value): " << key << " -> " << frameName << ".\n";
+		}
+	}
+
+	LOG << "Added resource group \"" << entry.name << "\".\n";
+}
+
+void ResourceManager::createLevelTheme( const ResourcePack::LevelThemeEntry& entry )
+{
+	LevelTheme* theme = new LevelTheme;
+	const std::string& name = entry.name;
+
+	// Add entities
+	for( auto& entity : entry.entities )
+	{
+		auto it = groups.find(entity.second);
+		if( it == groups.end() )
+		{
+			LOG << "Warning: theme \"" << name << "\" had an entity with an invalid group attribute \"" << entity.second << "\" specified.\n";
+			continue;
+		}
+
+		ResourceManager* resourceGroup = (*it).second;
+		theme->addEntityType( entity.first, resourceGroup );
+	}
+
+	// Add additional resources
+	for( auto& id : entry.resources )
+	{
+		const Resource* resource = getResource(id);
+		if( resource == nullptr )
+		{
+			LOG << "Warning: theme \"" << name << "\" had a resource with an invalid id specified: \"" << id << "\".\n";
+			continue;
+		}
+
+		if( resource->type == RESOURCE_BACKGROUND )
+		{
+			theme->backgrounds.push_back(resource->background);
+		}
+		else if( resource->type == RESOURCE_MUSIC )
+		{
+			theme->musics.push_back(resource->music);
+		}
+		else
+		{
+			LOG << "Warning: theme \"" << name << "\" had a resource \"" << id << "\" that was not a background or music track.\n";
+			continue;
+		}
+	}
+
+	// Check if a parent was specified
+	if( !entry.parent.empty() )
+	{
+		///@todo this code branch is untested... try it out
+		// Find the parent level theme
+		const LevelTheme* parent = getLevelTheme(entry.parent);
+		if( parent == nullptr )
+		{
+			LOG << "Warning: theme \"" << name << "\" specified a parent theme \"" << entry.parent << "\" that did not exist.\n";
+		}
+		else
+		{
+			// Find anything that the parent has that we don't have and copy it
+			theme->inherit( *parent );
+		}
+	}
+	else if( name.compare("default_theme") != 0 )
+	{
+		// By default, inherit default_theme
+		theme->inherit( *getLevelTheme("default_theme") );
+	}
+
+	// Create the resource
+	Resource resource;
+	resource.type = RESOURCE_LEVELTHEME;
+	resource.levelTheme = theme;
+	addResource(name, resource);
+	levelThemes.push_back(theme);
+
+	LOG << "Loaded theme \"" << name << "\".\n";
+}
+
+void ResourceManager::createMusic( const ResourcePack::AudioEntry& entry )
+{
+	// Audio is never loaded in headless mode
+	if( SETTINGS.headless )
+	{
+		return;
+	}
+
+	Music* music = new Music(entry.fileName);
+	if( !music->isLoaded() )
+	{
+		LOG << "Warning: Unable to load music track \"" << entry.name << "\" from file \"" << entry.fileName << "\".\n";
+		delete music;
+		return;
+	}
+
+	// Save the resource
+	Resource resource;
+	resource.type = RESOURCE_MUSIC;
+	resource.music = music;
+	addResource(entry.name, resource);
+
+	LOG << "Loaded music track \"" << entry.name << "\" from file \"" << entry.fileName << "\".\n";
+}
+
+void ResourceManager::createSound( const ResourcePack::AudioEntry& entry )
+{
+	// Audio is never loaded in headless mode
+	if( SETTINGS.headless )
+	{
+		return;
+	}
+
+	Sound* sound = new Sound(entry.fileName);
+	if( !sound->isLoaded() )
+	{
+		LOG << "Warning: Unable to load sound effect \"" << entry.name << "\" from file \"" << entry.fileName << "\".\n";
+		delete sound;
+		return;
+	}
+
+	// Save the resource
+	Resource resource;
+	resource.type = RESOURCE_SOUND;
+	resource.sound = sound;
+	addResource(entry.name, resource);
+
+	LOG << "Loaded sound effect \"" << entry.name << "\" from file \"" << entry.fileName << "\".\n";
+}
+
+void ResourceManager::createTextureAtlas()
+{
+	// Generate a texture for each page of the atlas. There is always at least one page.
+	if( atlasImages.empty() )
+	{
+		atlasImages.push_back(new Image(ATLAS_SIZE, ATLAS_SIZE));
+	}
+	for( int i = 0; i < (int)atlasImages.size(); i++ )
+	{
+		textureAtlases.push_back(new Texture(*atlasImages[i]));
+		if( SETTINGS.debugMode )
+		{
+			std::stringstream fileName;
+			fileName << "atlas" << i << ".png";
+			atlasImages[i]->save(fileName.str());
+		}
+		delete atlasImages[i];
+	}
+	atlasImages.clear();
+	atlasFrames.clear();
+	atlasSlots.clear();
+	delete atlasPacker;
+	atlasPacker = nullptr;
+	delete threadPool;
+	threadPool = nullptr;
 }
 
 const Animation* ResourceManager::getAnimation( const std::string& name ) const
 {
-	const Resource* resource = getResource(name);
+	return getAnimation(getResourceId(name));
+}
+
+const Animation* ResourceManager::getAnimation( ResourceId id ) const
+{
+	const Resource* resource = getResource(id);
 	if( resource == nullptr || resource->type != RESOURCE_ANIMATION )
 	{
 		return nullptr;
@@ -129,6 +801,16 @@ const Background* ResourceManager::getBackground( const std::string& name ) cons
 	return resource->background;
 }
 
+const ResourceManager* ResourceManager::getDefaultResourceGroup() const
+{
+	if( defaultGroup == nullptr )
+	{
+		return getResourceGroup(DEFAULT_RESOURCE_GROUP_NAME);
+	}
+
+	return defaultGroup;
+}
+
 const BitmapFont* ResourceManager::getFont( const std::string& name ) const
 {
 	const Resource* resource = getResource(name);
@@ -175,19 +857,28 @@ const Music* ResourceManager::getMusic( const std::string& name ) const
 
 const ResourceManager::Resource* ResourceManager::getResource( const std::string& name ) const
 {
-	auto it = resources.find(name);
-	if( it == resources.end() && parent == nullptr )
+	return getResource(getResourceId(name));
+}
+
+const ResourceManager::Resource* ResourceManager::getResource( ResourceId id ) const
+{
+	if( id < 0 || id >= (int)resourceTable.size() )
 	{
 		return nullptr;
 	}
-	else if( parent != nullptr )
-	{
-		return parent->getResource( name );
-	}
-	else
+
+	return resourceTable[id];
+}
+
+ResourceId ResourceManager::getResourceId( const std::string& name )
+{
+	auto it = resourceIds.find(name);
+	if( it == resourceIds.end() )
 	{
-		return &((*it).second);
+		return -1;
 	}
+
+	return (*it).second;
 }
 
 const ResourceManager* ResourceManager::getResourceGroup( const std::string& name ) const
@@ -202,39 +893,168 @@ const ResourceManager* ResourceManager::getResourceGroup( const std::string& nam
 	return (*it).second;
 }
 
-const Sound* ResourceManager::getSound( const std::string& name ) const
+const Texture* ResourceManager::getTextureAtlas( int page ) const
 {
-	const Resource* resource = getResource(name);
+	return textureAtlases[page];
+}
+
+const Sound* ResourceManager::getSound( ResourceId id ) const
+{
+	const Resource* resource = getResource(id);
 	if( resource == nullptr || resource->type != RESOURCE_SOUND )
 	{
 		return nullptr;
 	}
 
-	return resource->sound;
-}
+	return resource->sound;
+}
+
+void ResourceManager::loadAnimations( xml_node<>* root )
+{
+	// Start packing the texture atlas if it hasn't been started already,
+	// along with the threads that every resource file's images share
+	if( atlasPacker == nullptr )
+	{
+		atlasPacker = new AtlasPacker(ATLAS_SIZE);
+		threadPool = new ThreadPool(std::max(1, (int)std::thread::hardware_concurrency()));
+	}
+
+	// Find every image that the animations use, and decode them all up front
+	// in parallel. Only placing the frames in the atlas has to happen in order.
+	std::vector<std::string> imageFiles;
+	for( xml_node<>* node = root->first_node("animation"); node != nullptr; node = node->next_sibling("animation") )
+	{
+		for( xml_node<>* frame = node->first_node("frame"); frame != nullptr; frame = frame->next_sibling("frame") )
+		{
+			xml_attribute<>* attr = frame->first_attribute("image");
+			if( attr != nullptr )
+			{
+				imageFiles.push_back(getResourceFileName(attr->value()));
+			}
+		}
+	}
+	std::sort(imageFiles.begin(), imageFiles.end());
+	imageFiles.erase(std::unique(imageFiles.begin(), imageFiles.end()), imageFiles.end());
+
+	std::vector<AnimationImage> decodedImages(imageFiles.size());
+	threadPool->parallelFor(imageFiles.size(), [&]( int i )
+	{
+		decodedImages[i].decode(imageFiles[i]);
+	});
+
+	std::map< std::string, const AnimationImage* > images;
+	for( int i = 0; i < (int)imageFiles.size(); i++ )
+	{
+		images[imageFiles[i]] = &decodedImages[i];
+	}
+
+	// Frames are added to animations before they have a place in the atlas,
+	// and are given their texture coordinates once every frame is placed.
+	// Slots placed for earlier resource files are kept, so that their frames
+	// can be reused too.
+	int firstSlot = atlasSlots.size();
+	std::vector<PendingFrame> pendingFrames;
+	std::map< std::pair<const Animation*, int>, int > pendingFrameIndices;
+	std::vector< std::pair<std::string, const Animation*> > bakedAnimations;
+	long long savedBytes = 0; // The size of the frames that reuse the slot of the same pixels from another part of an image
+	auto addPendingFrame = [&]( Animation* animation, const Animation::Frame& f, int duration, int slot, bool mirrorX, bool mirrorY )
+	{
+		for( int sequence = animation->getLength(); sequence < animation->getLength() + duration; sequence++ )
+		{
+			PendingFrame pending = { animation, sequence, slot, mirrorX, mirrorY };
+			pendingFrameIndices[std::make_pair((const Animation*)animation, sequence)] = pendingFrames.size();
+			pendingFrames.push_back(pending);
+		}
+		animation->addFrame(f, duration);
+	};
+	auto placeFrames = [&]()
+	{
+		// Mixed heights pack best tallest first. The sort is stable to keep the atlas the same every time.
+		std::vector<int> order(atlasSlots.size() - firstSlot);
+		for( int i = 0; i < (int)order.size(); i++ )
+		{
+			order[i] = firstSlot + i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&]( int a, int b )
+		{
+			return atlasSlots[a].h > atlasSlots[b].h || (atlasSlots[a].h == atlasSlots[b].h && atlasSlots[a].w > atlasSlots[b].w);
+		});
+		for( int i : order )
+		{
+			// Slots are never bigger than a page, so this always succeeds
+			AtlasSlot& slot = atlasSlots[i];
+			atlasPacker->insert(slot.w, slot.h, slot.page, slot.atlasX, slot.atlasY);
+		}
+		while( (int)atlasImages.size() < atlasPacker->getPageCount() )
+		{
+			atlasImages.push_back(new Image(ATLAS_SIZE, ATLAS_SIZE));
+		}
+
+		// The slots don't overlap, so their pixels can be copied in parallel.
+		// The images are freed after loading, so the slots point at the atlas from then on.
+		threadPool->parallelFor(order.size(), [&]( int i )
+		{
+			AtlasSlot& slot = atlasSlots[firstSlot + i];
+			copyImageRect(*slot.source, slot.x, slot.y, slot.w, slot.h, *atlasImages[slot.page], slot.atlasX, slot.atlasY);
+			slot.source = atlasImages[slot.page];
+			slot.x = slot.atlasX;
+			slot.y = slot.atlasY;
+			slot.placed = true;
+		});
+
+		for( auto& pending : pendingFrames )
+		{
+			const AtlasSlot& slot = atlasSlots[pending.slot];
+			Animation::Frame f = pending.animation->getFrameBySequence(pending.sequence);
+			f.left = (double)slot.atlasX / (double)ATLAS_SIZE + 1e-6;
+			f.right = (double)(slot.atlasX + slot.w) / (double)ATLAS_SIZE - 1e-6;
+			f.bottom = (double)(slot.atlasY + slot.h) / (double)ATLAS_SIZE - 1e-6;
+			f.top = (double)slot.atlasY / (double)ATLAS_SIZE + 1e-6;
+			f.page = slot.page;
+			if( pending.mirrorX )
+			{
+				std::swap(f.left, f.right);
+			}
+			if( pending.mirrorY )
+			{
+				std::swap(f.bottom, f.top);
+			}
+			pending.animation->setFrameBySequence(pending.sequence, f);
+		}
 
-void ResourceManager::loadAnimations( xml_node<>* root )
-{
-	// Create an image to serve as a texture atlas if one hasn't been created already
-	///@todo move this constant elsewhere
-	static const int ATLAS_SIZE = 2048; // Storage size for 16k 16x16 tiles. Change if this ever gets too small
-	if( atlasImage == nullptr )
-	{
-		atlasImage = new Image(ATLAS_SIZE, ATLAS_SIZE);
+		// Animations are only added to the pack once their frames are final
+		for( auto& baked : bakedAnimations )
+		{
+			ResourcePack::AnimationEntry entry;
+			entry.name = baked.first;
+			entry.horizontalOrientation = baked.second->getHorizontalOrientation();
+			entry.verticalOrientation = baked.second->getVerticalOrientation();
+			for( int i = 0; i < baked.second->getLength(); i++ )
+			{
+				entry.frames.push_back(baked.second->getFrameBySequence(i));
+			}
+			bakingPack->addAnimation(entry);
+		}
 
-		atlasX = 0;
-		atlasY = 0;
-		atlasMaxHeight = 0;
-	}
+		if( !order.empty() )
+		{
+			LOG << "Placed " << order.size() << " frames in the texture atlas, which has " << atlasPacker->getPageCount() <<
+				" page(s) of " << ATLAS_SIZE << "x" << ATLAS_SIZE << " that are " << (int)(atlasPacker->getUtilization() * 100.0 + 0.5) << "% used.\n";
+			LOG << "Reusing frames with the same pixels saved " << savedBytes / 1024 << " KB of the atlas.\n";
+		}
 
-	// Create a cache for images
-	std::map< std::string, Image* > images;
+		firstSlot = atlasSlots.size();
+		pendingFrames.clear();
+		pendingFrameIndices.clear();
+		bakedAnimations.clear();
+		savedBytes = 0;
+	};
 
 	// Structure for frames with raw information (not atlas coordinates)
 	struct Frame
 	{
 		int x, y, w, h, xo, yo, duration;
-		Image* image;
+		const AnimationImage* image;
 		std::string imageFile;
 		bool mirrorX, mirrorY;
 	};
@@ -242,9 +1062,6 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 	// Cache for frame templates
 	std::map< std::string, Frame > frames;
 
-	// Cache for duplicate frames
-	std::map< std::string, Animation::Frame > atlasFrames;
-
 	// Enumerate animations
 	LOG << "Loading animations...\n";
 	for( xml_node<>* node = root->first_node("animation"); node != nullptr; node = node->next_sibling("animation") )
@@ -293,7 +1110,7 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 		int xo = 0;
 		int yo = 0;
 		int duration = 1;
-		Image* image = nullptr;
+		const AnimationImage* image = nullptr;
 		std::string imageFile;
 		bool mirrorX = false;
 		bool mirrorY = false;
@@ -379,7 +1196,17 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 					mirrorY = (std::atoi(attr->value()) == 1);
 				}
 
+				// A frame that isn't placed yet is placed along with the one it copies
 				Animation::Frame f =  a->getFrameBySequence(index);
+				auto pending = pendingFrameIndices.find(std::make_pair(a, index));
+				if( pending != pendingFrameIndices.end() )
+				{
+					int slot = pendingFrames[pending->second].slot;
+					bool pendingMirrorX = pendingFrames[pending->second].mirrorX != mirrorX;
+					bool pendingMirrorY = pendingFrames[pending->second].mirrorY != mirrorY;
+					addPendingFrame(animation, f, duration, slot, pendingMirrorX, pendingMirrorY);
+					continue;
+				}
 				if( mirrorX )
 				{
 					std::swap(f.left, f.right);
@@ -397,17 +1224,15 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 			if( attr != nullptr )
 			{
 				imageFile = getResourceFileName(attr->value());
-				std::map< std::string, Image* >::iterator it = images.find(imageFile);
-				if( it == images.end() )
+				image = images[imageFile];
+				if( bakingPack != nullptr )
 				{
-					// Load the image
-					image = new Image(imageFile);
-					images[imageFile] = image;
+					bakingPack->addSourceFile(imageFile);
 				}
-				else
+				if( image->image == nullptr )
 				{
-					// We've already loaded it
-					image = (*it).second;
+					placeFrames();
+					throw Exception() << image->error;
 				}
 			}
 			else if( image == nullptr )
@@ -507,18 +1332,20 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 			Image* indexImage = nullptr;
 			if( xStride != -1 && yStride != -1 )
 			{
-				xMax = image->getWidth();
+				xMax = image->image->getWidth();
 				xInc = w + xStride;
-				yMax = image->getHeight();
+				yMax = image->image->getHeight();
 				yInc = h + yStride;
-
+			}
+			if( xStride != -1 && yStride != -1 && SETTINGS.debugMode )
+			{
 				// Create an index image depicting the indices for each frame
-				indexImage = new Image(image->getWidth() * 2, image->getHeight() * 2);
-				for( int a = 0; a < image->getWidth(); a++ )
+				indexImage = new Image(image->image->getWidth() * 2, image->image->getHeight() * 2);
+				for( int a = 0; a < image->image->getWidth(); a++ )
 				{
-					for( int b = 0; b < image->getHeight(); b++ )
+					for( int b = 0; b < image->image->getHeight(); b++ )
 					{
-						Color pixel = image->getPixel(a, b);
+						Color pixel = image->image->getPixel(a, b);
 						indexImage->setPixel(a * 2, b * 2, pixel);
 						indexImage->setPixel(a * 2 + 1, b * 2, pixel);
 						indexImage->setPixel(a * 2, b * 2 + 1, pixel);
@@ -527,106 +1354,93 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 				}
 			}
 			int frameNumber = 0;
-			std::string frameString;
-			bool addToAtlas = true;
 			for( y = yMin; y < yMax; y += yInc )
 			{
 				for( x = xMin; x < xMax; x += xInc )
 				{
-					Animation::Frame f;
-					if( xStride == -1 || yStride == -1 )
+					// Check if the frame is all blank pixels
+					// If so, skip it since it is a waste to store it
+					if( image->isBlank(x, y, w, h) )
 					{
-						// Only copy to the atlas if the frame isn't a duplicate of one that has already been loaded
-						// Construct a unique string that identifies the file and pixels for the frame, and hash it
-						std::stringstream frameId;
-						frameId << imageFile << ':' << x << ':' << y << ':' << w << ':' << h;
-						frameString = frameId.str();
-						std::map< std::string, Animation::Frame >::iterator it = atlasFrames.find( frameString );
-						if( it != atlasFrames.end() )
-						{
-							// We don't need to add it to the atlas; it's already been copied
-							f = (*it).second;
-							f.xOffset = (double)xo / (double)UNIT_SIZE;
-							f.yOffset = (double)yo / (double)UNIT_SIZE * -1.0;
-							addToAtlas = false;
-						}
+						continue;
+					}
+
+					if( w > ATLAS_SIZE || h > ATLAS_SIZE )
+					{
+						LOG << "Warning: a frame of animation \"" << idAttr->value() << "\" is bigger than a page of the texture atlas. It will be ignored.\n";
+						continue;
 					}
 
-					if( addToAtlas )
+					// Only copy to the atlas if no frame with the same pixels, mirrored or not, has already been loaded.
+					// Slots are stored by the hash of their own pixels, so each mirrored copy of the frame is looked up.
+					int slot = -1;
+					bool slotMirrorX = false;
+					bool slotMirrorY = false;
+					unsigned long long frameHash = 0;
+					for( int mirror = 0; mirror < 4 && slot == -1; mirror++ )
 					{
-						// Check if the frame is all blank pixels
-						// If so, skip it since it is a waste to store it
-						bool skipFrame = true;
-						for( int a = x; a < x + w; a++ )
+						unsigned long long hash = hashImageRect(*image->image, x, y, w, h, (mirror & 1) != 0, (mirror & 2) != 0);
+						if( mirror == 0 )
 						{
-							for( int b = y; b < y + h; b++ )
-							{
-								if( image->getPixel(a, b).a != 0 )
-								{
-									skipFrame = false;
-								}
-							}
+							frameHash = hash;
 						}
-						if( skipFrame )
+						auto sameHashSlots = atlasFrames.find(hash);
+						if( sameHashSlots == atlasFrames.end() )
 						{
 							continue;
 						}
-
-						// Wrap around the atlas when a row is full
-						if( atlasX + w >= ATLAS_SIZE )
+						for( int i = 0; i < (int)sameHashSlots->second.size() && slot == -1; i++ )
 						{
-							atlasX = 0;
-							atlasY += atlasMaxHeight;
-							atlasMaxHeight = 0;
-						}
+							const AtlasSlot& atlasSlot = atlasSlots[sameHashSlots->second[i]];
+							if( atlasSlot.w != w || atlasSlot.h != h ||
+								!isSameImageRect(*image->image, x, y, *atlasSlot.source, atlasSlot.x, atlasSlot.y, w, h, (mirror & 1) != 0, (mirror & 2) != 0) )
+							{
+								continue;
+							}
 
-						// Copy pixels from the image to the atlas
-						for( int a = 0; a < w; ++a )
-						{
-							for( int b = 0; b < h; ++b )
+							// We don't need to add it to the atlas; it's already been copied.
+							// Using the same part of the same image again doesn't save anything.
+							slot = sameHashSlots->second[i];
+							slotMirrorX = (mirror & 1) != 0;
+							slotMirrorY = (mirror & 2) != 0;
+							if( atlasSlot.placed || atlasSlot.source != image->image || atlasSlot.x != x || atlasSlot.y != y )
 							{
-								///@todo add blit function for Image
-								atlasImage->setPixel(atlasX + a, atlasY + b, image->getPixel(x + a, y + b));
+								savedBytes += w * h * sizeof(Color);
 							}
 						}
-
-						f.left = (double)atlasX / (double)ATLAS_SIZE + 1e-6;
-						f.right = (double)(atlasX + w) / (double)ATLAS_SIZE - 1e-6;
-						f.bottom = (double)(atlasY + h) / (double)ATLAS_SIZE - 1e-6;
-						f.top = (double)atlasY / (double)ATLAS_SIZE + 1e-6;
-						f.xOffset = (double)xo / (double)UNIT_SIZE;
-						f.yOffset = (double)yo / (double)UNIT_SIZE * -1.0;
-						f.width = (double)w / (double)UNIT_SIZE;
-						f.height = (double)h / (double)UNIT_SIZE;
 					}
 
-					// Add the frame to the animation
-					if( mirrorX )
-					{
-						std::swap(f.left, f.right);
-					}
-					if( mirrorY )
-					{
-						std::swap(f.bottom, f.top);
-					}
-					animation->addFrame(
-						f.left,
-						f.right,
-						f.bottom,
-						f.top,
-						f.xOffset,
-						f.yOffset,
-						f.width,
-						f.height,
-						duration
-					);
-
-					if( xStride == -1 || yStride == -1 )
+					if( slot == -1 )
 					{
-						// Save the frame in case there are duplicate uses of it later
-						atlasFrames[frameString] = f;
+						// Give the frame a slot in the atlas, which is placed later
+						AtlasSlot atlasSlot;
+						atlasSlot.source = image->image;
+						atlasSlot.x = x;
+						atlasSlot.y = y;
+						atlasSlot.w = w;
+						atlasSlot.h = h;
+						atlasSlot.placed = false;
+						slot = atlasSlots.size();
+						atlasSlots.push_back(atlasSlot);
+
+						// Save the slot in case there are duplicate uses of the frame later
+						atlasFrames[frameHash].push_back(slot);
 					}
-					else
+
+					// Add the frame to the animation. Its texture coordinates are set once it is placed.
+					Animation::Frame f;
+					f.left = 0.0;
+					f.right = 0.0;
+					f.bottom = 0.0;
+					f.top = 0.0;
+					f.page = 0;
+					f.xOffset = (double)xo / (double)UNIT_SIZE;
+					f.yOffset = (double)yo / (double)UNIT_SIZE * -1.0;
+					f.width = (double)w / (double)UNIT_SIZE;
+					f.height = (double)h / (double)UNIT_SIZE;
+					addPendingFrame(animation, f, duration, slot, mirrorX != slotMirrorX, mirrorY != slotMirrorY);
+
+					if( indexImage != nullptr )
 					{
 						// Save the frame number in the index image
 						char tempString[8];
@@ -634,26 +1448,13 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 						indexImage->writeText(x * 2, y * 2, Color::WHITE, tempString);
 					}
 
-					// Advance along the atlas row
-					if( addToAtlas )
-					{
-						atlasX += w;
-						if( h > atlasMaxHeight )
-						{
-							atlasMaxHeight = h;
-						}
-					}
-
 					frameNumber++;
 				} // Loop through all frames to be added (x direction)
 			} // Loop through all frames to be added (y direction)
 
 			if( indexImage != nullptr )
 			{
-				if( SETTINGS.debugMode )
-				{
-					indexImage->save( std::string(idAttr->value()) + "_index.png" );
-				}
+				indexImage->save( std::string(idAttr->value()) + "_index.png" );
 				delete indexImage;
 			}
 
@@ -663,16 +1464,16 @@ void ResourceManager::loadAnimations( xml_node<>* root )
 		} // Loop through <frame> tags
 
 		// Save the resource
-		resources[idAttr->value()] = resource;
+		addResource(idAttr->value(), resource);
+		if( bakingPack != nullptr )
+		{
+			bakedAnimations.push_back(std::make_pair(std::string(idAttr->value()), animation));
+		}
 
 		LOG << "Loaded animation \"" << idAttr->value() << "\".\n";
 	} // Enumerate animations
 
-	// Free loaded images
-	for( auto image : images )
-	{
-		delete image.second;
-	}
+	placeFrames();
 }
 
 void ResourceManager::loadBackgrounds( xml_node<>* root )
@@ -740,6 +1541,10 @@ void ResourceManager::loadBackgrounds( xml_node<>* root )
 			if( imageAttr != nullptr )
 			{
 				std::string imageName = getResourceFileName(imageAttr->value());
+				if( bakingPack != nullptr )
+				{
+					bakingPack->addSourceFile(imageName);
+				}
 				Image* image = new Image(imageName);
 				images.push_back(image);
 				indices.push_back(images.size() - 1);
@@ -762,97 +1567,43 @@ void ResourceManager::loadBackgrounds( xml_node<>* root )
 			}
 		}
 
-		// Decide on a texture size to use...
-		// This assumes mostly 512 x 512 backgrounds
-		int textureSize;
-		if( images.size() < 2 )
+		// Check if it has parallax factors specified. By default, the background
+		// scrolls one pixel for every unit that the view scrolls.
+		double parallaxX = 1.0 / UNIT_SIZE;
+		double parallaxY = 1.0 / UNIT_SIZE;
+		xml_attribute<>* parallaxXAttr = node->first_attribute("parallaxX");
+		if( parallaxXAttr != nullptr )
 		{
-			textureSize = 512;
+			parallaxX = std::atof( parallaxXAttr->value() );
 		}
-		else if( images.size() < 5 )
+		xml_attribute<>* parallaxYAttr = node->first_attribute("parallaxY");
+		if( parallaxYAttr != nullptr )
 		{
-			textureSize = 1024;
+			parallaxY = std::atof( parallaxYAttr->value() );
 		}
-		else if( images.size() < 17 )
+
+		ResourcePack::BackgroundEntry entry;
+		entry.name = idAttr->value();
+		entry.images = images;
+		entry.indices = indices;
+		entry.time = time;
+		entry.tiling = tiling;
+		entry.parallaxX = parallaxX;
+		entry.parallaxY = parallaxY;
+		createBackground(entry);
+
+		// The pack keeps the images while baking
+		if( bakingPack != nullptr )
 		{
-			textureSize = 2048;
+			bakingPack->addBackground(entry);
 		}
 		else
 		{
-			textureSize = 4096;
-		}
-
-		// Create the image and corresponding animation
-		std::vector<Animation::Frame> frames;
-		Animation* animation = new Animation();
-		Image textureImage( textureSize, textureSize );
-		int x = 0;
-		int y = 0;
-		int maxHeight = 0;
-		for( int i = 0; i < (int)images.size(); i++ )
-		{
-			// Figure out packing coordinates
-			Image* image = images[i];
-			if( y + image->getHeight() > textureSize )
+			for( auto image : images )
 			{
-				LOG << "Warning: Failed to pack texture for background \"" << idAttr->value() << "\".\n";
-				delete animation;
-				continue;
-			}
-			if( x + image->getWidth() > textureSize )
-			{
-				x = 0;
-				y += maxHeight;
-				maxHeight = image->getHeight();
-			}
-
-			if( image->getHeight() > maxHeight )
-			{
-				maxHeight = image->getHeight();
+				delete image;
 			}
-
-			// Pack the image
-			textureImage.blit( *image, x, y );
-
-			// Save it's animation frame
-			Animation::Frame f;
-			f.left = (double)x / (double)textureSize + 1e-6;
-			f.right = (double)(x + image->getWidth()) / (double)textureSize - 1e-6;
-			f.bottom = (double)(y + image->getHeight()) / (double)textureSize - 1e-6;
-			f.top = (double)y / (double)textureSize + 1e-6;
-			f.xOffset = 0;
-			f.yOffset = 0;
-			f.width = (double)image->getWidth() / (double)UNIT_SIZE;
-			f.height = (double)image->getHeight() / (double)UNIT_SIZE;
-			frames.push_back(f);
-
-			x += image->getWidth();
-		}
-
-		// Copy frames to the animation
-		for( int i = 0; i < (int)indices.size(); i++ )
-		{
-			animation->addFrame(frames[indices[i]], time );
-		}
-
-		// Copy the image to a texture
-		Texture* texture = new Texture( textureImage );
-		textures.push_back(texture);
-
-		// Create the background resource
-		Background* background = new Background( *texture, animation, tiling );
-		Resource resource;
-		resource.type = RESOURCE_BACKGROUND;
-		resource.background = background;
-		resources[idAttr->value()] = resource;
-
-		// Free image resources
-		for( auto image : images )
-		{
-			delete image;
 		}
-
-		LOG << "Loaded background \"" << idAttr->value() << "\".\n";
 	} // Enumerate backgrounds
 }
 
@@ -862,10 +1613,6 @@ void ResourceManager::loadFonts( xml_node<>* root )
 	LOG << "Loading fonts...\n";
 	for( xml_node<>* node = root->first_node("font"); node != nullptr; node = node->next_sibling("font") )
 	{
-		// Create a Font Resource
-		Resource resource;
-		resource.type = RESOURCE_FONT;
-
 		// Check that it has an id
 		xml_attribute<>* idAttr = node->first_attribute("id");
 		if( idAttr == nullptr )
@@ -906,10 +1653,18 @@ void ResourceManager::loadFonts( xml_node<>* root )
 			continue;
 		}
 
-		std::string fileName = getResourceFileName(fileAttr->value());
-		BitmapFont* font = new BitmapFont(fileName, std::atoi(widthAttr->value()), std::atoi(heightAttr->value()));
+		ResourcePack::FontEntry entry;
+		entry.name = idAttr->value();
+		entry.fileName = getResourceFileName(fileAttr->value());
+		if( bakingPack != nullptr )
+		{
+			bakingPack->addSourceFile(entry.fileName);
+		}
+		entry.image = new Image(entry.fileName);
+		entry.charWidth = std::atoi(widthAttr->value());
+		entry.charHeight = std::atoi(heightAttr->value());
 
-		// Add all characters to the font
+		// Find all characters of the font
 		for( xml_node<>* ch = node->first_node("char"); ch != nullptr; ch = ch->next_sibling("char") )
 		{
 			// Check for attributes of the character
@@ -922,26 +1677,25 @@ void ResourceManager::loadFonts( xml_node<>* root )
 				continue;
 			}
 
-			char chId = charIdAttr->value()[0];
-			int x = std::atoi(xAttr->value());
-			int y = std::atoi(yAttr->value());
-
-			if( numberAttr != nullptr )
-			{
-				int number = std::atoi(numberAttr->value());
-				font->addCharacters( chId, x, y, number );
-			}
-			else
-			{
-				font->addCharacter( chId, x, y );
-			}
+			ResourcePack::FontCharacters characters;
+			characters.ch = charIdAttr->value()[0];
+			characters.x = std::atoi(xAttr->value());
+			characters.y = std::atoi(yAttr->value());
+			characters.number = (numberAttr != nullptr) ? std::atoi(numberAttr->value()) : -1;
+			entry.characters.push_back(characters);
 		}
 
-		// Save the resource
-		resource.font = font;
-		resources[idAttr->value()] = resource;
+		createFont(entry);
 
-		LOG << "Loaded font \"" << idAttr->value() << "\" from file \"" << fileName<< "\".\n";
+		// The pack keeps the image while baking
+		if( bakingPack != nullptr )
+		{
+			bakingPack->addFont(entry);
+		}
+		else
+		{
+			delete entry.image;
+		}
 	} // Enumerate fonts
 }
 
@@ -958,136 +1712,36 @@ void ResourceManager::loadGroups( xml_node<>* root )
 			LOG << "Warning: Ignoring a resource group that did not have an \"id\" attribute.\n";
 			continue;
 		}
-		std::string name = idAttr->value();
 
-		// Check that the parent resource manager exists
+		ResourcePack::GroupEntry entry;
+		entry.name = idAttr->value();
 		xml_attribute<>* parentAttr = node->first_attribute("parent");
-		const ResourceManager* parent = nullptr;
 		if( parentAttr != nullptr )
 		{
-			auto it = groups.find(parentAttr->value());
-			if( it != groups.end() )
-			{
-				parent = (*it).second;
-			}
-			else
-			{
-				LOG << "Warning: attempted to add a resource group \"" << name << "with parent \"" <<
-					parentAttr->value() << "\" which did not exist. The group will not be added.\n";
-				continue;
-			}
-		}
-
-		auto it = groups.find(name);
-		if( it != groups.end() )
-		{
-			LOG << "Warning: attempted to add a resource group to a name that was already being used: \"" <<
-				name << "\". Any resources mapped by the resource group will not be available.\n";
-			continue;
+			entry.parent = parentAttr->value();
 		}
 
-		ResourceManager* group = new ResourceManager(*parent);
-		groups.insert(it, std::pair<std::string, ResourceManager*>(name, group));
-
-		// Add all key-value pairs to the child
+		// Find all key-value pairs of the group
 		for( xml_node<>* res = node->first_node("resource"); res != nullptr; res = res->next_sibling("resource") )
 		{
-			// Check that it has a key-value pair specified
 			xml_attribute<>* keyAttr = res->first_attribute("key");
 			xml_attribute<>* valueAttr = res->first_attribute("value");
 			xml_attribute<>* animationAttr = res->first_attribute("animation"); // Also allow specifying single-frame animations in place of the value
 			xml_attribute<>* indexAttr = res->first_attribute("index");
-			if( keyAttr == nullptr || (valueAttr == nullptr && (animationAttr == nullptr || indexAttr == nullptr )) )
-			{
-				LOG << "Warning: resource group \"" << name << "\" had an invalid key-value pair specified. It will be ignored.\n";
-				continue;
-			}
-
-			// Check that the key is unique and that the value exists
-			std::string key = keyAttr->value();
-			auto iter = group->resources.find(key);
-			if( iter != group->resources.end() )
-			{
-				LOG << "Warning: resource group \"" << name << "\" specified a key that was already in use: \"" << key << "\".\n";
-				continue;
-			}
 
-			if( valueAttr != nullptr )
-			{
-				std::string value = valueAttr->value();
-				iter = resources.find(value);
-				if( iter == resources.end() )
-				{
-					LOG << "Warning: resource group \"" << name << "\" specified a value for a resource that does not exist: \"" << value << "\".\n";
-					continue;
-				}
-
-				// Create the link to the resource
-				const Resource* resource = getResource(value);
-				Resource newResource(*resource);
-				group->resources[key] = newResource;
-
-				LOG << "Added resource key-value pair: " << key << " -> " << value << ".\n";
-			}
-			else
-			{
-				// Find the animation
-				std::string animationName = animationAttr->value();
-				const Animation* animation = getAnimation(animationName);
-				if( animation == nullptr )
-				{
-					LOG << "Warning: resource group \"" << name << "\" with key \"" << key << "\" specified an animation that does not exist: \"" << animationName << "\".\n";
-					continue;
-				}
-
-				// Read the index as hex
-				int index = strtol( indexAttr->value(), NULL, 16 );
-				if( index < 0 || index >= animation->getLength() )
-				{
-					LOG << "Warning: resource group name \"" << name << "\" with key \"" << key << "\" specified an animation as its value with the following issue:\n";
-					LOG << "\tanimation frame for animation \"" << animationName << "\" had a bad index specified.\n";
-					continue;
-				}
-
-				// Check if we've loaded this frame before
-				std::string frameName = animationName + '[' + indexAttr->value() + ']';
-				const Animation* frameAnimation = getAnimation(frameName);
-				if( frameAnimation == nullptr )
-				{
-					// Does this name conflict with another resource that we've loaded? (Rare)
-					if( getResource(frameName) != nullptr )
-					{
-						LOG << "Warning: couldn't load key-value pair with key \"" << key << "\" and animation \"" << animationName;
-						LOG << "\" with index [" << index << "] since the name \"" << frameName << "\" was already being used for a different resource.\n";
-						continue;
-					}
-
-					// Create the animation
-					Animation* a = new Animation;
-					a->addFrame( animation->getFrame(index) );
-
-					//Store it in the resource map
-					Resource r;
-					r.animation = a;
-					r.type = RESOURCE_ANIMATION;
-					resources[frameName] = r;
-
-					// Now, create a link to it for the group
-					group->resources[key] = r;
-				}
-				else
-				{
-					// Just create a link to the animation frame resource since it's already been loaded
-					const Resource* resource = getResource(frameName);
-					Resource newResource(*resource);
-					group->resources[key] = newResource;
-				}
-
-				LOG << "Added resource key-value pair (with implicit animation value): " << key << " -> " << frameName << ".\n";
-			}
+			ResourcePack::GroupKey groupKey;
+			groupKey.key = (keyAttr != nullptr) ? keyAttr->value() : "";
+			groupKey.value = (valueAttr != nullptr) ? valueAttr->value() : "";
+			groupKey.animation = (animationAttr != nullptr) ? animationAttr->value() : "";
+			groupKey.index = (indexAttr != nullptr) ? indexAttr->value() : "";
+			entry.keys.push_back(groupKey);
 		}
 
-		LOG << "Added resource group \"" << name << "\".\n";
+		createGroup(entry);
+		if( bakingPack != nullptr )
+		{
+			bakingPack->addGroup(entry);
+		}
 	} // Enumerate groups
 }
 
@@ -1113,96 +1767,46 @@ void ResourceManager::loadLevelThemes( xml_node<>* root )
 			continue;
 		}
 
-		// Load the theme
-		LevelTheme* theme = new LevelTheme;
-		std::string name = idAttr->value();
+		ResourcePack::LevelThemeEntry entry;
+		entry.name = idAttr->value();
+		xml_attribute<>* parentAttr = node->first_attribute("parent");
+		if( parentAttr != nullptr )
+		{
+			entry.parent = parentAttr->value();
+		}
 
-		// Load entities
+		// Find entities
 		for( xml_node<>* entity = node->first_node("entity"); entity != nullptr; entity = entity->next_sibling("entity") )
 		{
 			xml_attribute<>* id = entity->first_attribute("id");
 			xml_attribute<>* group = entity->first_attribute("group");
 			if( id == nullptr || group == nullptr )
 			{
-				LOG << "Warning: theme \"" << name << "\" had an entity specified without an id or group attribute.\n";
-				continue;
-			}
-
-			auto it = groups.find(group->value());
-			if( it == groups.end() )
-			{
-				LOG << "Warning: theme \"" << name << "\" had an entity with an invalid group attribute \"" << group->value() << "\" specified.\n";
+				LOG << "Warning: theme \"" << entry.name << "\" had an entity specified without an id or group attribute.\n";
 				continue;
 			}
 
-			ResourceManager* resourceGroup = (*it).second;
-			theme->addEntityType( id->value(), resourceGroup );
+			entry.entities.push_back(std::make_pair(std::string(id->value()), std::string(group->value())));
 		}
 
-		// Load additional resources
+		// Find additional resources
 		for( xml_node<>* res = node->first_node("resource"); res != nullptr; res = res->next_sibling("resource") )
 		{
 			xml_attribute<>* id = res->first_attribute("id");
 			if( id == nullptr )
 			{
-				LOG << "Warning: theme \"" << name << "\" had a resource specified without an id attribute.\n";
-				continue;
-			}
-
-			const Resource* resource = getResource(id->value());
-			if( resource == nullptr )
-			{
-				LOG << "Warning: theme \"" << name << "\" had a resource with an invalid id specified: \"" << id->value() << "\".\n";
+				LOG << "Warning: theme \"" << entry.name << "\" had a resource specified without an id attribute.\n";
 				continue;
 			}
 
-			if( resource->type == RESOURCE_BACKGROUND )
-			{
-				theme->backgrounds.push_back(resource->background);
-			}
-			else if( resource->type == RESOURCE_MUSIC )
-			{
-				theme->musics.push_back(resource->music);
-			}
-			else
-			{
-				LOG << "Warning: theme \"" << name << "\" had a resource \"" << id->value() << "\" that was not a background or music track.\n";
-				continue;
-			}
+			entry.resources.push_back(id->value());
 		}
 
-		// Check if a parent was specified
-		xml_attribute<>* parentAttr = node->first_attribute("parent");
-		if( parentAttr != nullptr )
+		createLevelTheme(entry);
+		if( bakingPack != nullptr )
 		{
-			///@todo this code branch is untested... try it out
-			// Find the parent level theme
-			std::string parentName = parentAttr->value();
-			const LevelTheme* parent = getLevelTheme(parentName);
-			if( parent == nullptr )
-			{
-				LOG << "Warning: theme \"" << name << "\" specified a parent theme \"" << parentName << "\" that did not exist.\n";
-			}
-			else
-			{
-				// Find anything that the parent has that we don't have and copy it
-				theme->inherit( *parent );
-			}
-		}
-		else if( name.compare("default_theme") != 0 )
-		{
-			// By default, inherit default_theme
-			theme->inherit( *getLevelTheme("default_theme") );
+			bakingPack->addLevelTheme(entry);
 		}
-
-		// Create the resource
-		Resource resource;
-		resource.type = RESOURCE_LEVELTHEME;
-		resource.levelTheme = theme;
-		resources[name] = resource;
-		levelThemes.push_back(theme);
-
-		LOG << "Loaded theme \"" << name << "\".\n";
 	} // Enumerate themes
 }
 
@@ -1212,10 +1816,6 @@ void ResourceManager::loadMusic( xml_node<>* root )
 	LOG << "Loading music...\n";
 	for( xml_node<>* node = root->first_node("music"); node != nullptr; node = node->next_sibling("music") )
 	{
-		// Create a Music Resource
-		Resource resource;
-		resource.type = RESOURCE_MUSIC;
-
 		// Check that it has an id
 		xml_attribute<>* idAttr = node->first_attribute("id");
 		if( idAttr == nullptr )
@@ -1240,20 +1840,14 @@ void ResourceManager::loadMusic( xml_node<>* root )
 			continue;
 		}
 
-		std::string fileName = getResourceFileName(fileAttr->value());
-		Music* music = new Music(fileName);
-		if( !music->isLoaded() )
+		ResourcePack::AudioEntry entry;
+		entry.name = idAttr->value();
+		entry.fileName = getResourceFileName(fileAttr->value());
+		if( bakingPack != nullptr )
 		{
-			LOG << "Warning: Unable to load music track \"" << idAttr->value() << "\" from file \"" << fileName << "\".\n";
-			delete music;
-			continue;
+			bakingPack->addMusic(entry);
 		}
-
-		// Save the resource
-		resource.music = music;
-		resources[idAttr->value()] = resource;
-
-		LOG << "Loaded music track \"" << idAttr->value() << "\" from file \"" << fileName<< "\".\n";
+		createMusic(entry);
 	} // Enumerate music
 }
 
@@ -1262,21 +1856,85 @@ void ResourceManager::loadResources( const std::string& resourceFileName )
 	// Only the root level resource manager can load resources
 	assert(isMainResourceManager);
 
-	// Load the main resource file
-	loadResourcesFromFile(resourceFileName);
-
-	// Generate the texture atlas
-	textureAtlas = new Texture(*atlasImage);
-	if( SETTINGS.debugMode )
+	// Load the resource pack instead of the resource files if it is up to date
+	if( SETTINGS.resourcePack.empty() || !loadResourcePack(SETTINGS.resourcePack) )
 	{
-		atlasImage->save("atlas.png");
+		loadResourcesFromFile(resourceFileName);
 	}
-	delete atlasImage;
-	atlasImage = nullptr;
+
+	createTextureAtlas();
 
 	LOG << "Done loading resources.\n";
 }
 
+bool ResourceManager::loadResourcePack( const std::string& fileName )
+{
+	ResourcePack pack;
+	if( !pack.load(fileName) )
+	{
+		LOG << "Resource pack \"" << fileName << "\" not found or invalid. Loading resources from the resource files.\n";
+		return false;
+	}
+
+	std::string staleFileName;
+	if( !pack.isFresh(staleFileName) )
+	{
+		LOG << "Resource pack \"" << fileName << "\" is out of date, since \"" << staleFileName << "\" changed. Loading resources from the resource files.\n";
+		return false;
+	}
+
+	for( auto page : pack.atlasPages )
+	{
+		if( page->getWidth() != ATLAS_SIZE || page->getHeight() > ATLAS_SIZE )
+		{
+			LOG << "Resource pack \"" << fileName << "\" has an atlas of the wrong size. Loading resources from the resource files.\n";
+			return false;
+		}
+	}
+
+	LOG << "Loading resources from pack \"" << fileName << "\"...\n";
+
+	// The pack only has the rows of each atlas page that are used
+	for( auto page : pack.atlasPages )
+	{
+		Image* atlasImage = new Image(ATLAS_SIZE, ATLAS_SIZE);
+		std::copy(page->getPixels(), page->getPixels() + ATLAS_SIZE * page->getHeight(), atlasImage->getPixels());
+		atlasImages.push_back(atlasImage);
+	}
+
+	// Create every resource in the order it was loaded, since resources refer to the ones before them
+	for( auto& entry : pack.entries )
+	{
+		switch( entry.first )
+		{
+			case ResourcePack::ENTRY_ANIMATION:
+				createAnimation(pack.animations[entry.second]);
+				break;
+			case ResourcePack::ENTRY_BACKGROUND:
+				createBackground(pack.backgrounds[entry.second]);
+				break;
+			case ResourcePack::ENTRY_FONT:
+				createFont(pack.fonts[entry.second]);
+				break;
+			case ResourcePack::ENTRY_GROUP:
+				createGroup(pack.groups[entry.second]);
+				break;
+			case ResourcePack::ENTRY_LEVELTHEME:
+				createLevelTheme(pack.levelThemes[entry.second]);
+				break;
+			case ResourcePack::ENTRY_MUSIC:
+				createMusic(pack.music[entry.second]);
+				break;
+			case ResourcePack::ENTRY_SOUND:
+				createSound(pack.sounds[entry.second]);
+				break;
+		}
+	}
+
+	LOG << "Finished loading resources from pack \"" << fileName << "\".\n";
+	return true;
+}
+
 void ResourceManager::loadResourcesFromFile( const std::string& resourceFileName )
 {
 	assert(isMainResourceManager);
@@ -1284,6 +1942,10 @@ void ResourceManager::loadResourcesFromFile( const std::string& resourceFileName
 	LOG << "Loading resources from file \"" << resourceFileName << "\"...\n";
 
 	// Parse the XML document
+	if( bakingPack != nullptr )
+	{
+		bakingPack->addSourceFile(resourceFileName);
+	}
 	xml_document<> document;
 	file<> xmlFile(resourceFileName.c_str());
 	document.parse<0>(xmlFile.data());
@@ -1307,6 +1969,7 @@ void ResourceManager::loadResourcesFromFile( const std::string& resourceFileName
         catch( std::exception& e )
         {
         	LOG << "Failed to load resources from file \"" << fileName << "\". Exception: " << e.what() << std::endl;
+        	loadErrors++;
         }
 	}
 
@@ -1328,10 +1991,6 @@ void ResourceManager::loadSounds( xml_node<>* root )
 	LOG << "Loading sounds...\n";
 	for( xml_node<>* node = root->first_node("sound"); node != nullptr; node = node->next_sibling("sound") )
 	{
-		// Create a Sound Resource
-		Resource resource;
-		resource.type = RESOURCE_SOUND;
-
 		// Check that it has an id
 		xml_attribute<>* idAttr = node->first_attribute("id");
 		if( idAttr == nullptr )
@@ -1356,20 +2015,14 @@ void ResourceManager::loadSounds( xml_node<>* root )
 			continue;
 		}
 
-		std::string fileName = getResourceFileName(fileAttr->value());
-		Sound* sound = new Sound(fileName);
-		if( !sound->isLoaded() )
+		ResourcePack::AudioEntry entry;
+		entry.name = idAttr->value();
+		entry.fileName = getResourceFileName(fileAttr->value());
+		if( bakingPack != nullptr )
 		{
-			LOG << "Warning: Unable to load sound effect \"" << idAttr->value() << "\" from file \"" << fileName << "\".\n";
-			delete sound;
-			continue;
+			bakingPack->addSound(entry);
 		}
-
-		// Save the resource
-		resource.sound = sound;
-		resources[idAttr->value()] = resource;
-
-		LOG << "Loaded sound effect \"" << idAttr->value() << "\" from file \"" << fileName << "\".\n";
+		createSound(entry);
 	} // Enumerate sounds
 }
 
@@ -1398,7 +2051,7 @@ void ResourceManager::playSound( const std::string& soundName, int channel ) con
 		return;
 	}
 
-	const Sound* sound = getSound(soundName);
+	const Sound* sound = getSound(getResourceId(soundName));
 	if( sound == nullptr )
 	{
 		LOG << "Warning: requested sound resource \"" << soundName << "\" not found!\n";
@@ -1406,3 +2059,20 @@ void ResourceManager::playSound( const std::string& soundName, int channel ) con
 	}
 	sound->play(channel);
 }
+
+void ResourceManager::playSound( ResourceId soundId, int channel ) const
+{
+	// Only play sound if the option is turned on
+	if( !SETTINGS.sound )
+	{
+		return;
+	}
+
+	const Sound* sound = getSound(soundId);
+	if( sound == nullptr )
+	{
+		LOG << "Warning: requested sound resource with id " << soundId << " not found!\n";
+		return;
+	}
+	sound->play(channel);
+}
@@ -8,7 +8,11 @@
 
 #include <rapidxml.hpp>
 
+#include "ResourceId.hpp"
+#include "ResourcePack.hpp"
+
 class Animation;
+class AtlasPacker;
 class Background;
 class BitmapFont;
 class Image;
@@ -16,6 +20,7 @@ struct LevelTheme;
 class Music;
 class Sound;
 class Texture;
+class ThreadPool;
 
 /**
  * Manages the loading and accessing of shared resources.
@@ -31,9 +36,16 @@ public:
 	~ResourceManager();
 
 	/**
-	 * Bind the texture atlas used for graphical resources.
+	 * Load resources from a resource file, and save them to a resource pack
+	 * that can be loaded instead of the resource file afterwards.
+	 *
+	 * @param resourceFileName the name of the resource file.
+	 * @param packFileName the name of the pack file to write.
+	 * @return false if a resource file failed to load, so the pack wasn't
+	 * written, or if the pack couldn't be written. The resources that
+	 * could be are loaded either way.
 	 */
-	void bindTextureAtlas() const;
+	bool bakeResources( const std::string& resourceFileName, const std::string& packFileName );
 
 	/**
 	 * Get an Animation resource.
@@ -42,11 +54,24 @@ public:
 	 */
 	const Animation* getAnimation( const std::string& name ) const;
 
+	/**
+	 * Get an Animation resource without looking up its name.
+	 *
+	 * @param id the id of the name of the resource.
+	 */
+	const Animation* getAnimation( ResourceId id ) const;
+
 	/**
 	 * Get a Background resource.
 	 */
 	const Background* getBackground( const std::string& name ) const;
 
+	/**
+	 * Get the default resource group. This is kept when the group is
+	 * created, so it doesn't need to be looked up by name.
+	 */
+	const ResourceManager* getDefaultResourceGroup() const;
+
 	/**
 	 * Get a font resource.
 	 */
@@ -82,7 +107,27 @@ public:
 	const ResourceManager* getResourceGroup( const std::string& name ) const;
 
 	/**
-	 * Load resources from a resource file.
+	 * Get the id of the name of a resource, or of a key of a resource group.
+	 * The id finds the resource in any group with a lookup in a table, so
+	 * code that uses a resource often should get its id once and keep it.
+	 * Ids are only given out as resources are loaded, so this must be called
+	 * after loading.
+	 *
+	 * @return the id, or -1 if nothing was loaded with the name.
+	 */
+	static ResourceId getResourceId( const std::string& name );
+
+	/**
+	 * Get a page of the texture atlas used for graphical resources.
+	 *
+	 * @param page the page, which is the one that an animation frame is on.
+	 */
+	const Texture* getTextureAtlas( int page = 0 ) const;
+
+	/**
+	 * Load resources from a resource file. If the resource pack set in the
+	 * settings was baked from the same files, and none of them have changed
+	 * since, the pack is loaded instead.
 	 *
 	 * @param resourceFileName the name of the resource file.
 	 */
@@ -104,6 +149,14 @@ public:
 	 */
 	void playSound( const std::string& soundName, int channel = -1 ) const;
 
+	/**
+	 * Play a sound clip without looking up its name.
+	 *
+	 * @param soundId the id of the name of the sound effect.
+	 * @param channel the channel to play the effect on.
+	 */
+	void playSound( ResourceId soundId, int channel = -1 ) const;
+
 private:
 	enum ResourceType
 	{
@@ -115,6 +168,25 @@ private:
 		RESOURCE_SOUND
 	};
 
+	/**
+	 * A frame of an image that has its own place in the atlas. It is placed
+	 * once every frame of a resource file is known, so that the frames can
+	 * be packed tallest first. After that, its pixels are read back from the
+	 * atlas, so that frames from later resource files can reuse it.
+	 */
+	struct AtlasSlot
+	{
+		const Image* source;
+		int x;
+		int y;
+		int w;
+		int h;
+		bool placed;
+		int page;
+		int atlasX;
+		int atlasY;
+	};
+
 	struct Resource
 	{
 		ResourceType type;
@@ -130,37 +202,60 @@ private:
 		};
 	};
 
+	ResourcePack* bakingPack; /**< The pack that resources are added to as they are loaded, while baking. */
 	bool isMainResourceManager;
+	int loadErrors; /**< The number of imported resource files that failed to load. */
 
 	std::map< std::string, Resource > resources;
+	std::vector<const Resource*> resourceTable; /**< The resource for each id, including the ones shared by the parent, or nullptr for names that aren't in the group. */
 
-	Texture* textureAtlas;
-	Image* atlasImage;
-	int atlasX;
-	int atlasY;
-	int atlasMaxHeight;
+	std::vector<Texture*> textureAtlases; /**< Each page of the texture atlas. */
+	std::vector<Image*> atlasImages; /**< The pixels of each page of the texture atlas, while resources are loaded. */
+	AtlasPacker* atlasPacker; /**< Places animation frames on the pages of the atlas, while resources are loaded. */
+	std::map< unsigned long long, std::vector<int> > atlasFrames; /**< The atlas slots with each hash of the pixels of a frame, while resources are loaded. */
+	std::vector<AtlasSlot> atlasSlots; /**< Every frame with its own place in the atlas, from all resource files, while resources are loaded. */
 
 	std::list<Texture*> textures;
 
+	const ResourceManager* defaultGroup;
 	const ResourceManager* parent;
 	std::map< std::string, ResourceManager* > groups;
 
 	std::vector< LevelTheme* > levelThemes;
 
+	ThreadPool* threadPool; /**< Decodes images and copies frames into the atlas, while resources are loaded. */
+
 	/**
 	 * Create a resource manager with a parent. Everything that the parent has
 	 * will be shared with the child resource manager.
+	 *
+	 * @param parent the parent, or nullptr for a group with no parent.
+	 */
+	ResourceManager( const ResourceManager* parent );
+
+	/**
+	 * Add a resource, giving its name an id if it doesn't have one yet.
 	 */
-	ResourceManager( const ResourceManager& parent );
+	void addResource( const std::string& name, const Resource& resource );
 
+	void createAnimation( const ResourcePack::AnimationEntry& entry );
+	void createBackground( const ResourcePack::BackgroundEntry& entry );
+	void createFont( const ResourcePack::FontEntry& entry );
+	void createGroup( const ResourcePack::GroupEntry& entry );
+	void createLevelTheme( const ResourcePack::LevelThemeEntry& entry );
+	void createMusic( const ResourcePack::AudioEntry& entry );
+	void createSound( const ResourcePack::AudioEntry& entry );
+	void createTextureAtlas();
 	const Resource* getResource( const std::string& name ) const;
-	const Sound* getSound( const std::string& name ) const;
+	const Resource* getResource( ResourceId id ) const;
+	const Sound* getSound( ResourceId id ) const;
 	void loadAnimations( rapidxml::xml_node<>* root );
 	void loadBackgrounds( rapidxml::xml_node<>* root );
 	void loadFonts( rapidxml::xml_node<>* root );
 	void loadGroups( rapidxml::xml_node<>* root );
 	void loadLevelThemes( rapidxml::xml_node<>* root );
 	void loadMusic( rapidxml::xml_node<>* root );
+	bool loadResourcePack( const std::string& fileName );
 	void loadResourcesFromFile( const std::string& fileName );
 	void loadSounds( rapidxml::xml_node<>* root );
 };
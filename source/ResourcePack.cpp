@@ -0,0 +1,675 @@
+#include <cstring>
+#include <fstream>
+
+#include <sys/stat.h>
+
+#include "Image.hpp"
+#include "ResourcePack.hpp"
+
+static const char PACK_MAGIC[4] = { 'M', 'R', 'P', 'K' }; /**< Identifies resource pack files. */
+static const unsigned int PACK_VERSION = 3; /**< The version of the resource pack file format. */
+
+/**
+ * Reads values from a pack that was read into memory in one piece. Reading
+ * past the end fails the reader instead of reading garbage.
+ */
+class PackReader
+{
+public:
+	PackReader( const std::vector<unsigned char>& data ) :
+		data(data),
+		failed(false),
+		position(0)
+	{
+	}
+
+	/**
+	 * Fail the reader because what was read doesn't make sense.
+	 */
+	void fail()
+	{
+		failed = true;
+	}
+
+	bool hasFailed() const
+	{
+		return failed;
+	}
+
+	bool readBool()
+	{
+		return readUnsigned() != 0;
+	}
+
+	const unsigned char* readBytes( std::size_t count )
+	{
+		if( failed || count > data.size() - position )
+		{
+			failed = true;
+			return nullptr;
+		}
+		const unsigned char* bytes = data.data() + position;
+		position += count;
+		return bytes;
+	}
+
+	double readDouble()
+	{
+		unsigned long long bits = readUnsigned64();
+		double value;
+		std::memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	Image* readImage()
+	{
+		int width = readInt();
+		int height = readInt();
+		if( width < 0 || height < 0 || (unsigned long long)width * height * 4 > data.size() - position )
+		{
+			failed = true;
+			return nullptr;
+		}
+
+		Image* image = new Image(width, height);
+		const unsigned char* bytes = readBytes(width * height * 4);
+		Color* pixels = image->getPixels();
+		for( int i = 0; i < width * height; ++i )
+		{
+			pixels[i].r = bytes[i * 4];
+			pixels[i].g = bytes[i * 4 + 1];
+			pixels[i].b = bytes[i * 4 + 2];
+			pixels[i].a = bytes[i * 4 + 3];
+		}
+		return image;
+	}
+
+	int readInt()
+	{
+		return static_cast<int>(readUnsigned());
+	}
+
+	std::string readString()
+	{
+		unsigned int length = readUnsigned();
+		const unsigned char* bytes = readBytes(length);
+		if( bytes == nullptr )
+		{
+			return std::string();
+		}
+		return std::string(reinterpret_cast<const char*>(bytes), length);
+	}
+
+	unsigned int readUnsigned()
+	{
+		const unsigned char* bytes = readBytes(4);
+		if( bytes == nullptr )
+		{
+			return 0;
+		}
+		unsigned int value = 0;
+		for( int i = 0; i < 4; ++i )
+		{
+			value |= static_cast<unsigned int>(bytes[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	unsigned long long readUnsigned64()
+	{
+		unsigned long long low = readUnsigned();
+		unsigned long long high = readUnsigned();
+		return low | (high << 32);
+	}
+
+private:
+	const std::vector<unsigned char>& data;
+	bool failed;
+	std::size_t position;
+};
+
+// Values are stored little endian, regardless of the platform
+static void writeUnsigned( std::ofstream& file, unsigned int value )
+{
+	char bytes[4];
+	for( int i = 0; i < 4; ++i )
+	{
+		bytes[i] = static_cast<char>((value >> (i * 8)) & 0xff);
+	}
+	file.write(bytes, 4);
+}
+
+static void writeUnsigned64( std::ofstream& file, unsigned long long value )
+{
+	writeUnsigned(file, static_cast<unsigned int>(value & 0xffffffff));
+	writeUnsigned(file, static_cast<unsigned int>(value >> 32));
+}
+
+static void writeDouble( std::ofstream& file, double value )
+{
+	unsigned long long bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	writeUnsigned64(file, bits);
+}
+
+static void writeImage( std::ofstream& file, const Image& image )
+{
+	writeUnsigned(file, image.getWidth());
+	writeUnsigned(file, image.getHeight());
+
+	std::vector<char> bytes(image.getWidth() * image.getHeight() * 4);
+	const Color* pixels = image.getPixels();
+	for( int i = 0; i < image.getWidth() * image.getHeight(); ++i )
+	{
+		bytes[i * 4] = static_cast<char>(pixels[i].r);
+		bytes[i * 4 + 1] = static_cast<char>(pixels[i].g);
+		bytes[i * 4 + 2] = static_cast<char>(pixels[i].b);
+		bytes[i * 4 + 3] = static_cast<char>(pixels[i].a);
+	}
+	if( !bytes.empty() )
+	{
+		file.write(&bytes[0], bytes.size());
+	}
+}
+
+static void writeString( std::ofstream& file, const std::string& value )
+{
+	writeUnsigned(file, value.size());
+	file.write(value.data(), value.size());
+}
+
+/**
+ * Get the size and modification time of a file. The modification time is in
+ * nanoseconds where the file system keeps it, so that a file saved twice in
+ * the same second is still seen to have changed.
+ *
+ * @return false if the file doesn't exist.
+ */
+static bool getFileStamp( const std::string& fileName, unsigned long long& size, unsigned long long& modificationTime )
+{
+	struct stat info;
+	if( stat(fileName.c_str(), &info) != 0 )
+	{
+		return false;
+	}
+
+	size = static_cast<unsigned long long>(info.st_size);
+#ifdef _WIN32
+	modificationTime = static_cast<unsigned long long>(info.st_mtime) * 1000000000ULL;
+#else
+	modificationTime = static_cast<unsigned long long>(info.st_mtim.tv_sec) * 1000000000ULL +
+		static_cast<unsigned long long>(info.st_mtim.tv_nsec);
+#endif
+	return true;
+}
+
+ResourcePack::ResourcePack()
+{
+}
+
+ResourcePack::~ResourcePack()
+{
+	clear();
+}
+
+void ResourcePack::addAnimation( const AnimationEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_ANIMATION, (int)animations.size()));
+	animations.push_back(entry);
+}
+
+void ResourcePack::addBackground( const BackgroundEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_BACKGROUND, (int)backgrounds.size()));
+	backgrounds.push_back(entry);
+}
+
+void ResourcePack::addFont( const FontEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_FONT, (int)fonts.size()));
+	fonts.push_back(entry);
+}
+
+void ResourcePack::addGroup( const GroupEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_GROUP, (int)groups.size()));
+	groups.push_back(entry);
+}
+
+void ResourcePack::addLevelTheme( const LevelThemeEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_LEVELTHEME, (int)levelThemes.size()));
+	levelThemes.push_back(entry);
+}
+
+void ResourcePack::addMusic( const AudioEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_MUSIC, (int)music.size()));
+	music.push_back(entry);
+}
+
+void ResourcePack::addSound( const AudioEntry& entry )
+{
+	entries.push_back(std::make_pair(ENTRY_SOUND, (int)sounds.size()));
+	sounds.push_back(entry);
+}
+
+void ResourcePack::addSourceFile( const std::string& fileName )
+{
+	for( auto& sourceFile : sourceFiles )
+	{
+		if( sourceFile.fileName == fileName )
+		{
+			return;
+		}
+	}
+
+	SourceFile sourceFile;
+	sourceFile.fileName = fileName;
+	if( !getFileStamp(fileName, sourceFile.size, sourceFile.modificationTime) )
+	{
+		return;
+	}
+	sourceFiles.push_back(sourceFile);
+}
+
+void ResourcePack::clear()
+{
+	for( auto page : atlasPages )
+	{
+		delete page;
+	}
+	atlasPages.clear();
+
+	for( auto& background : backgrounds )
+	{
+		for( auto image : background.images )
+		{
+			delete image;
+		}
+	}
+	for( auto& font : fonts )
+	{
+		delete font.image;
+	}
+
+	animations.clear();
+	backgrounds.clear();
+	entries.clear();
+	fonts.clear();
+	groups.clear();
+	levelThemes.clear();
+	music.clear();
+	sounds.clear();
+	sourceFiles.clear();
+}
+
+bool ResourcePack::isFresh( std::string& staleFileName ) const
+{
+	for( auto& sourceFile : sourceFiles )
+	{
+		unsigned long long size;
+		unsigned long long modificationTime;
+		if( !getFileStamp(sourceFile.fileName, size, modificationTime) ||
+			size != sourceFile.size || modificationTime != sourceFile.modificationTime )
+		{
+			staleFileName = sourceFile.fileName;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool ResourcePack::load( const std::string& fileName )
+{
+	clear();
+
+	// Read the whole pack at once
+	std::ifstream file(fileName.c_str(), std::ios::binary | std::ios::ate);
+	if( !file )
+	{
+		return false;
+	}
+	std::vector<unsigned char> data((std::size_t)file.tellg());
+	file.seekg(0);
+	if( data.empty() || !file.read(reinterpret_cast<char*>(&data[0]), data.size()) )
+	{
+		return false;
+	}
+
+	PackReader reader(data);
+	const unsigned char* magic = reader.readBytes(4);
+	if( magic == nullptr || std::memcmp(magic, PACK_MAGIC, 4) != 0 || reader.readUnsigned() != PACK_VERSION )
+	{
+		return false;
+	}
+
+	unsigned int sourceFileCount = reader.readUnsigned();
+	for( unsigned int i = 0; i < sourceFileCount && !reader.hasFailed(); ++i )
+	{
+		SourceFile sourceFile;
+		sourceFile.fileName = reader.readString();
+		sourceFile.size = reader.readUnsigned64();
+		sourceFile.modificationTime = reader.readUnsigned64();
+		sourceFiles.push_back(sourceFile);
+	}
+
+	unsigned int pageCount = reader.readUnsigned();
+	for( unsigned int i = 0; i < pageCount && !reader.hasFailed(); ++i )
+	{
+		Image* page = reader.readImage();
+		if( page != nullptr )
+		{
+			atlasPages.push_back(page);
+		}
+	}
+
+	unsigned int entryCount = reader.readUnsigned();
+	for( unsigned int i = 0; i < entryCount && !reader.hasFailed(); ++i )
+	{
+		unsigned int type = reader.readUnsigned();
+		switch( type )
+		{
+			case ENTRY_ANIMATION:
+			{
+				AnimationEntry entry;
+				entry.name = reader.readString();
+				entry.horizontalOrientation = reader.readBool();
+				entry.verticalOrientation = reader.readBool();
+				unsigned int frameCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < frameCount && !reader.hasFailed(); ++j )
+				{
+					Animation::Frame frame;
+					frame.left = reader.readDouble();
+					frame.right = reader.readDouble();
+					frame.bottom = reader.readDouble();
+					frame.top = reader.readDouble();
+					frame.page = reader.readInt();
+					frame.xOffset = reader.readDouble();
+					frame.yOffset = reader.readDouble();
+					frame.width = reader.readDouble();
+					frame.height = reader.readDouble();
+					entry.frames.push_back(frame);
+				}
+				addAnimation(entry);
+				break;
+			}
+			case ENTRY_BACKGROUND:
+			{
+				BackgroundEntry entry;
+				entry.name = reader.readString();
+				unsigned int imageCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < imageCount && !reader.hasFailed(); ++j )
+				{
+					Image* image = reader.readImage();
+					if( image != nullptr )
+					{
+						entry.images.push_back(image);
+					}
+				}
+				unsigned int indexCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < indexCount && !reader.hasFailed(); ++j )
+				{
+					entry.indices.push_back(reader.readInt());
+				}
+				entry.time = reader.readInt();
+				unsigned int tiling = reader.readUnsigned();
+				entry.parallaxX = reader.readDouble();
+				entry.parallaxY = reader.readDouble();
+
+				// Reject backgrounds with an unknown tiling or frames past their own images
+				if( tiling > BACKGROUND_ALL )
+				{
+					reader.fail();
+					tiling = BACKGROUND_ALL;
+				}
+				entry.tiling = static_cast<BackgroundTiling>(tiling);
+				for( auto index : entry.indices )
+				{
+					if( index < 0 || index >= (int)entry.images.size() )
+					{
+						reader.fail();
+					}
+				}
+				addBackground(entry);
+				break;
+			}
+			case ENTRY_FONT:
+			{
+				FontEntry entry;
+				entry.name = reader.readString();
+				entry.fileName = reader.readString();
+				entry.image = reader.readImage();
+				entry.charWidth = reader.readInt();
+				entry.charHeight = reader.readInt();
+				unsigned int characterCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < characterCount && !reader.hasFailed(); ++j )
+				{
+					FontCharacters characters;
+					characters.ch = static_cast<char>(reader.readUnsigned());
+					characters.x = reader.readInt();
+					characters.y = reader.readInt();
+					characters.number = reader.readInt();
+					entry.characters.push_back(characters);
+				}
+				addFont(entry);
+				break;
+			}
+			case ENTRY_GROUP:
+			{
+				GroupEntry entry;
+				entry.name = reader.readString();
+				entry.parent = reader.readString();
+				unsigned int keyCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < keyCount && !reader.hasFailed(); ++j )
+				{
+					GroupKey key;
+					key.key = reader.readString();
+					key.value = reader.readString();
+					key.animation = reader.readString();
+					key.index = reader.readString();
+					entry.keys.push_back(key);
+				}
+				addGroup(entry);
+				break;
+			}
+			case ENTRY_LEVELTHEME:
+			{
+				LevelThemeEntry entry;
+				entry.name = reader.readString();
+				entry.parent = reader.readString();
+				unsigned int entityCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < entityCount && !reader.hasFailed(); ++j )
+				{
+					std::string id = reader.readString();
+					entry.entities.push_back(std::make_pair(id, reader.readString()));
+				}
+				unsigned int resourceCount = reader.readUnsigned();
+				for( unsigned int j = 0; j < resourceCount && !reader.hasFailed(); ++j )
+				{
+					entry.resources.push_back(reader.readString());
+				}
+				addLevelTheme(entry);
+				break;
+			}
+			case ENTRY_MUSIC:
+			case ENTRY_SOUND:
+			{
+				AudioEntry entry;
+				entry.name = reader.readString();
+				entry.fileName = reader.readString();
+				if( type == ENTRY_MUSIC )
+				{
+					addMusic(entry);
+				}
+				else
+				{
+					addSound(entry);
+				}
+				break;
+			}
+			default:
+				reader.readBytes(data.size());
+				break;
+		}
+	}
+
+	if( reader.hasFailed() )
+	{
+		clear();
+		return false;
+	}
+
+	// Every frame has to be on one of the atlas pages
+	for( auto& animation : animations )
+	{
+		for( auto& frame : animation.frames )
+		{
+			if( frame.page < 0 || frame.page >= (int)atlasPages.size() )
+			{
+				clear();
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool ResourcePack::save( const std::string& fileName ) const
+{
+	std::ofstream file(fileName.c_str(), std::ios::binary);
+	if( !file )
+	{
+		return false;
+	}
+
+	file.write(PACK_MAGIC, 4);
+	writeUnsigned(file, PACK_VERSION);
+
+	writeUnsigned(file, sourceFiles.size());
+	for( auto& sourceFile : sourceFiles )
+	{
+		writeString(file, sourceFile.fileName);
+		writeUnsigned64(file, sourceFile.size);
+		writeUnsigned64(file, sourceFile.modificationTime);
+	}
+
+	writeUnsigned(file, atlasPages.size());
+	for( auto page : atlasPages )
+	{
+		writeImage(file, *page);
+	}
+
+	writeUnsigned(file, entries.size());
+	for( auto& entry : entries )
+	{
+		writeUnsigned(file, entry.first);
+		switch( entry.first )
+		{
+			case ENTRY_ANIMATION:
+			{
+				const AnimationEntry& animation = animations[entry.second];
+				writeString(file, animation.name);
+				writeUnsigned(file, animation.horizontalOrientation);
+				writeUnsigned(file, animation.verticalOrientation);
+				writeUnsigned(file, animation.frames.size());
+				for( auto& frame : animation.frames )
+				{
+					writeDouble(file, frame.left);
+					writeDouble(file, frame.right);
+					writeDouble(file, frame.bottom);
+					writeDouble(file, frame.top);
+					writeUnsigned(file, frame.page);
+					writeDouble(file, frame.xOffset);
+					writeDouble(file, frame.yOffset);
+					writeDouble(file, frame.width);
+					writeDouble(file, frame.height);
+				}
+				break;
+			}
+			case ENTRY_BACKGROUND:
+			{
+				const BackgroundEntry& background = backgrounds[entry.second];
+				writeString(file, background.name);
+				writeUnsigned(file, background.images.size());
+				for( auto image : background.images )
+				{
+					writeImage(file, *image);
+				}
+				writeUnsigned(file, background.indices.size());
+				for( auto index : background.indices )
+				{
+					writeUnsigned(file, index);
+				}
+				writeUnsigned(file, background.time);
+				writeUnsigned(file, background.tiling);
+				writeDouble(file, background.parallaxX);
+				writeDouble(file, background.parallaxY);
+				break;
+			}
+			case ENTRY_FONT:
+			{
+				const FontEntry& font = fonts[entry.second];
+				writeString(file, font.name);
+				writeString(file, font.fileName);
+				writeImage(file, *font.image);
+				writeUnsigned(file, font.charWidth);
+				writeUnsigned(file, font.charHeight);
+				writeUnsigned(file, font.characters.size());
+				for( auto& characters : font.characters )
+				{
+					writeUnsigned(file, static_cast<unsigned char>(characters.ch));
+					writeUnsigned(file, characters.x);
+					writeUnsigned(file, characters.y);
+					writeUnsigned(file, characters.number);
+				}
+				break;
+			}
+			case ENTRY_GROUP:
+			{
+				const GroupEntry& group = groups[entry.second];
+				writeString(file, group.name);
+				writeString(file, group.parent);
+				writeUnsigned(file, group.keys.size());
+				for( auto& key : group.keys )
+				{
+					writeString(file, key.key);
+					writeString(file, key.value);
+					writeString(file, key.animation);
+					writeString(file, key.index);
+				}
+				break;
+			}
+			case ENTRY_LEVELTHEME:
+			{
+				const LevelThemeEntry& levelTheme = levelThemes[entry.second];
+				writeString(file, levelTheme.name);
+				writeString(file, levelTheme.parent);
+				writeUnsigned(file, levelTheme.entities.size());
+				for( auto& entity : levelTheme.entities )
+				{
+					writeString(file, entity.first);
+					writeString(file, entity.second);
+				}
+				writeUnsigned(file, levelTheme.resources.size());
+				for( auto& resource : levelTheme.resources )
+				{
+					writeString(file, resource);
+				}
+				break;
+			}
+			case ENTRY_MUSIC:
+			case ENTRY_SOUND:
+			{
+				const AudioEntry& audio = (entry.first == ENTRY_MUSIC) ? music[entry.second] : sounds[entry.second];
+				writeString(file, audio.name);
+				writeString(file, audio.fileName);
+				break;
+			}
+		}
+	}
+
+	return file.good();
+}
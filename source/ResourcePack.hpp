@@ -0,0 +1,205 @@
+#ifndef RESOURCEPACK_HPP
+#define RESOURCEPACK_HPP
+
+#include <string>
+#include <vector>
+
+#include "Animation.hpp"
+#include "Background.hpp"
+
+class Image;
+
+/**
+ * Everything that the ResourceManager loads from resource files, after the
+ * XML has been parsed and the images decoded: the pages of the finished
+ * texture atlas, the frames of every animation, and the pixels and settings
+ * of every other resource. A pack is baked once from the resource files, and
+ * is then loaded with a single read instead of them.
+ *
+ * The pack remembers the size and modification time of every file it was
+ * baked from, so that a pack that is out of date can be detected.
+ */
+class ResourcePack
+{
+public:
+	/**
+	 * The types of resources, in a pack.
+	 */
+	enum EntryType
+	{
+		ENTRY_ANIMATION,
+		ENTRY_BACKGROUND,
+		ENTRY_FONT,
+		ENTRY_GROUP,
+		ENTRY_LEVELTHEME,
+		ENTRY_MUSIC,
+		ENTRY_SOUND
+	};
+
+	/**
+	 * An animation, with its frames already placed in the atlas.
+	 */
+	struct AnimationEntry
+	{
+		std::string name;
+		bool horizontalOrientation;
+		bool verticalOrientation;
+		std::vector<Animation::Frame> frames; /**< Every frame, repeated for its duration. */
+	};
+
+	/**
+	 * A music track or sound effect. Audio is still loaded from its own file.
+	 */
+	struct AudioEntry
+	{
+		std::string name;
+		std::string fileName;
+	};
+
+	/**
+	 * A background, with the pixels of each of its images.
+	 */
+	struct BackgroundEntry
+	{
+		std::string name;
+		std::vector<Image*> images;
+		std::vector<int> indices; /**< The image shown by each frame. */
+		int time; /**< The duration of each frame. */
+		BackgroundTiling tiling;
+		double parallaxX;
+		double parallaxY;
+	};
+
+	/**
+	 * A run of characters in the same row of a font image.
+	 */
+	struct FontCharacters
+	{
+		char ch; /**< The first character. */
+		int x;
+		int y;
+		int number; /**< The number of characters, or -1 for a single character. */
+	};
+
+	/**
+	 * A bitmap font, with the pixels of its image.
+	 */
+	struct FontEntry
+	{
+		std::string name;
+		std::string fileName; /**< The image the font was baked from. */
+		Image* image;
+		int charWidth;
+		int charHeight;
+		std::vector<FontCharacters> characters;
+	};
+
+	/**
+	 * A key of a resource group. It maps to either another resource, or to a
+	 * single frame of an animation.
+	 */
+	struct GroupKey
+	{
+		std::string key;
+		std::string value; /**< The resource, or empty if the key maps to a frame. */
+		std::string animation;
+		std::string index; /**< The frame of the animation, in hex. */
+	};
+
+	/**
+	 * A resource group.
+	 */
+	struct GroupEntry
+	{
+		std::string name;
+		std::string parent; /**< The parent group, or empty for none. */
+		std::vector<GroupKey> keys;
+	};
+
+	/**
+	 * A level theme.
+	 */
+	struct LevelThemeEntry
+	{
+		std::string name;
+		std::string parent; /**< The parent theme, or empty to inherit default_theme. */
+		std::vector< std::pair<std::string, std::string> > entities; /**< The id and resource group of each entity. */
+		std::vector<std::string> resources; /**< The backgrounds and music tracks of the theme. */
+	};
+
+	std::vector<AnimationEntry> animations;
+	std::vector<Image*> atlasPages; /**< The rows of each page of the texture atlas that are used. */
+	std::vector<BackgroundEntry> backgrounds;
+	std::vector< std::pair<EntryType, int> > entries; /**< Every resource, in the order it is created, with its index in the container for its type. */
+	std::vector<FontEntry> fonts;
+	std::vector<GroupEntry> groups;
+	std::vector<LevelThemeEntry> levelThemes;
+	std::vector<AudioEntry> music;
+	std::vector<AudioEntry> sounds;
+
+	/**
+	 * Create an empty pack.
+	 */
+	ResourcePack();
+
+	~ResourcePack();
+
+	/**
+	 * Add a resource to the end of the pack. Images in the entry are owned
+	 * by the pack afterwards.
+	 */
+	void addAnimation( const AnimationEntry& entry );
+	void addBackground( const BackgroundEntry& entry );
+	void addFont( const FontEntry& entry );
+	void addGroup( const GroupEntry& entry );
+	void addLevelTheme( const LevelThemeEntry& entry );
+	void addMusic( const AudioEntry& entry );
+	void addSound( const AudioEntry& entry );
+
+	/**
+	 * Remember a file that the pack is baked from, as it is now.
+	 */
+	void addSourceFile( const std::string& fileName );
+
+	/**
+	 * Check that every file the pack was baked from still has the same size
+	 * and modification time.
+	 *
+	 * @param staleFileName set to the first file that changed, if any.
+	 */
+	bool isFresh( std::string& staleFileName ) const;
+
+	/**
+	 * Load a pack from a file, replacing everything in this one.
+	 *
+	 * @return false if the file doesn't exist or isn't a valid pack.
+	 */
+	bool load( const std::string& fileName );
+
+	/**
+	 * Save the pack to a file.
+	 *
+	 * @return false if the file couldn't be written.
+	 */
+	bool save( const std::string& fileName ) const;
+
+private:
+	/**
+	 * A file the pack is baked from.
+	 */
+	struct SourceFile
+	{
+		std::string fileName;
+		unsigned long long size;
+		unsigned long long modificationTime; /**< In nanoseconds since the epoch. */
+	};
+
+	std::vector<SourceFile> sourceFiles;
+
+	/**
+	 * Free all images and remove every resource and source file.
+	 */
+	void clear();
+};
+
+#endif // RESOURCEPACK_HPP
@@ -1,3 +1,6 @@
+#include <climits>
+#include <cstdlib>
+
 #include "Settings.hpp"
 
 Settings::Settings()
@@ -10,6 +13,30 @@ Settings::Settings()
 	sound = true;
 	music = true;
 	debugMode = false;
+	headless = false;
+	recordReplays = false;
+	renderThread = false;
+	lowResolution = true;
+	tileMaps = true;
+	precisePacing = true;
+	resourcePack = "resources.pack";
+	updateThreads = 1;
+}
+
+void Settings::calculateScale()
+{
+	// Ideally, screenHeight / (16 * scale) should be as close to 14 as possible
+	int bestRatio = INT_MAX;
+	for( scale = 1; scale < 16; scale++ )
+	{
+		int ratio = std::abs(screenHeight / (16 * scale) - 14);
+		if( ratio > bestRatio )
+		{
+			scale--;
+			break;
+		}
+		bestRatio = ratio;
+	}
 }
 
 int Settings::getRenderedScreenHeight() const
@@ -1,6 +1,8 @@
 #ifndef SETTINGS_HPP
 #define SETTINGS_HPP
 
+#include <string>
+
 #define SETTINGS_FILE_NAME "settings.ini"
 
 /**
@@ -15,12 +17,26 @@ struct Settings
 	bool sound;       /**< Sound effects on/off. */
 	bool music;       /**< Music on/off. */
 	bool debugMode;   /**< Debug mode on/off. */
+	bool headless;    /**< Headless mode on/off. No window, OpenGL context, or audio are created. */
+	bool recordReplays; /**< Record a replay of each infinity mode level on/off. */
+	bool renderThread; /**< Present the game on its own thread, interpolating between simulation frames, on/off. */
+	bool lowResolution; /**< Draw at the rendered screen size and upscale to the window on/off. */
+	bool tileMaps; /**< Draw the static tiles of each layer as one quad, with a shader that looks them up, on/off. */
+	bool precisePacing; /**< Pace frames with a high resolution clock instead of SDL ticks on/off. */
+	std::string frameTimeLog; /**< The name of a CSV file to write the duration of every frame to, or empty for none. */
+	std::string resourcePack; /**< The name of a baked resource pack to load instead of the resource files, or empty for none. */
+	int updateThreads; /**< The number of threads the World update uses. 0 uses one per core. */
 
 	/**
 	 * Initializes with default settings.
 	 */
 	Settings();
 
+	/**
+	 * Calculate the scale automatically from the screen height.
+	 */
+	void calculateScale();
+
 	/**
 	 * Get the height of the screen in pixels with scale taken into consideration.
 	 */
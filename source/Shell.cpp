@@ -11,16 +11,19 @@ Shell::Shell(bool fireproof) :
 	kills(0),
 	player(nullptr)
 {
+	static const ResourceId BEETLE_SHELL_ANIMATION = ResourceManager::getResourceId("beetle_shell");
+	static const ResourceId SHELL_ANIMATION = ResourceManager::getResourceId("shell");
+
 	setFireproof(fireproof);
 	setWidth(WIDTH);
 	setHeight(HEIGHT);
 	if( fireproof )
 	{
-		setAnimation("beetle_shell");
+		setAnimation(BEETLE_SHELL_ANIMATION);
 	}
 	else
 	{
-		setAnimation("shell");
+		setAnimation(SHELL_ANIMATION);
 	}
 	setKickable(true);
 	setStompable(false);
@@ -133,6 +136,10 @@ void Shell::onStomp()
 
 void Shell::startMoving( Player* kicker )
 {
+	static const ResourceId BEETLE_SHELL_SPINNING_ANIMATION = ResourceManager::getResourceId("beetle_shell_spinning");
+	static const ResourceId KICK_SOUND = ResourceManager::getResourceId("kick");
+	static const ResourceId SHELL_SPINNING_ANIMATION = ResourceManager::getResourceId("shell_spinning");
+
 	if( getXVelocity() != 0.0 )
 	{
 		return;
@@ -150,13 +157,13 @@ void Shell::startMoving( Player* kicker )
 
 	if( isFireproof() )
 	{
-		setAnimation("beetle_shell_spinning");
+		setAnimation(BEETLE_SHELL_SPINNING_ANIMATION);
 	}
 	else
 	{
-		setAnimation("shell_spinning");
+		setAnimation(SHELL_SPINNING_ANIMATION);
 	}
-	playSound("kick");
+	playSound(KICK_SOUND);
 	player = kicker;
 
 	kickTimer = KICK_TIMER;
@@ -0,0 +1,280 @@
+#include <algorithm>
+#include <cmath>
+
+#include "Exception.hpp"
+#include "Image.hpp"
+#include "SoftwareRenderer.hpp"
+#include "Texture.hpp"
+#include "TileMap.hpp"
+
+static const float CLEAR_DEPTH = -10.0f; /**< The depth of the far plane, which matches the OpenGL projection. */
+
+/**
+ * Wrap a texel coordinate around the texture, like GL_REPEAT.
+ */
+static int wrapTexel( int texel, int size )
+{
+	texel %= size;
+	return texel < 0 ? texel + size : texel;
+}
+
+SoftwareRenderer::SoftwareRenderer( int width, int height ) :
+	height(height),
+	viewBottom(0.0),
+	viewLeft(0.0),
+	viewRight(width),
+	viewTop(height),
+	width(width)
+{
+	image = new Image(width, height);
+	depth.resize(width * height);
+	clear(Color::BLACK);
+}
+
+SoftwareRenderer::~SoftwareRenderer()
+{
+	delete image;
+}
+
+void SoftwareRenderer::clear( const Color& color )
+{
+	Color* pixels = image->getPixels();
+	std::fill(pixels, pixels + width * height, color);
+	clearDepth();
+}
+
+void SoftwareRenderer::clearDepth()
+{
+	std::fill(depth.begin(), depth.end(), CLEAR_DEPTH);
+}
+
+void SoftwareRenderer::draw( SpriteBatch::Primitive primitive, const Texture* texture, const TileMap* tileMap, const SpriteBatch::Vertex* vertices, int count, const SpriteBatch::Transform* transform )
+{
+	if( primitive == SpriteBatch::PRIMITIVE_LINES )
+	{
+		for( int i = 0; i + 1 < count; i += 2 )
+		{
+			rasterizeLine(vertices[i], vertices[i + 1], transform);
+		}
+		return;
+	}
+
+	if( primitive == SpriteBatch::PRIMITIVE_TILEMAP )
+	{
+		for( int i = 0; i + 3 < count; i += 4 )
+		{
+			rasterizeTileMap(tileMap, vertices[i], vertices[i + 2], transform);
+		}
+		return;
+	}
+
+	const Image* textureImage = nullptr;
+	if( texture != nullptr )
+	{
+		textureImage = texture->getImage();
+		if( textureImage == nullptr )
+		{
+			throw Exception("Textures can only be drawn by the software renderer in headless mode.");
+		}
+	}
+
+	// Each quad is x, y -> x + w, y -> x + w, y + h -> x, y + h
+	for( int i = 0; i + 3 < count; i += 4 )
+	{
+		rasterizeQuad(textureImage, vertices[i], vertices[i + 2], transform);
+	}
+}
+
+void SoftwareRenderer::drawPixel( int x, int y, float z, const Color& color )
+{
+	int index = (height - 1 - y) * width + x;
+	if( z < depth[index] )
+	{
+		return;
+	}
+
+	// Like OpenGL, transparent pixels still write their depth
+	depth[index] = z;
+
+	// The destination alpha is never visible on screen, so it is left alone
+	Color& pixel = image->getPixels()[index];
+	int alpha = color.a;
+	if( alpha == 255 )
+	{
+		pixel.r = color.r;
+		pixel.g = color.g;
+		pixel.b = color.b;
+	}
+	else if( alpha != 0 )
+	{
+		pixel.r = (color.r * alpha + pixel.r * (255 - alpha) + 127) / 255;
+		pixel.g = (color.g * alpha + pixel.g * (255 - alpha) + 127) / 255;
+		pixel.b = (color.b * alpha + pixel.b * (255 - alpha) + 127) / 255;
+	}
+}
+
+const Image& SoftwareRenderer::getImage() const
+{
+	return *image;
+}
+
+void SoftwareRenderer::getPixelCoordinates( const SpriteBatch::Vertex& vertex, const SpriteBatch::Transform* transform, double& x, double& y, float& z ) const
+{
+	x = vertex.x;
+	y = vertex.y;
+	z = vertex.z;
+	if( transform != nullptr )
+	{
+		x = transform->x + x * transform->scaleX;
+		y = transform->y + y * transform->scaleY;
+		z = static_cast<float>(transform->z + z);
+	}
+
+	x = (x - viewLeft) * width / (viewRight - viewLeft);
+	y = (y - viewBottom) * height / (viewTop - viewBottom);
+}
+
+void SoftwareRenderer::rasterizeLine( const SpriteBatch::Vertex& start, const SpriteBatch::Vertex& end, const SpriteBatch::Transform* transform )
+{
+	double x1, y1, x2, y2;
+	float z;
+	getPixelCoordinates(start, transform, x1, y1, z);
+	getPixelCoordinates(end, transform, x2, y2, z);
+
+	// Take one sample per pixel along the longer axis
+	int steps = std::ceil(std::max(std::abs(x2 - x1), std::abs(y2 - y1)));
+	for( int i = 0; i < steps; ++i )
+	{
+		double t = (i + 0.5) / steps;
+		int x = std::floor(x1 + (x2 - x1) * t);
+		int y = std::floor(y1 + (y2 - y1) * t);
+		if( x >= 0 && x < width && y >= 0 && y < height )
+		{
+			drawPixel(x, y, z, start.color);
+		}
+	}
+}
+
+void SoftwareRenderer::rasterizeQuad( const Image* texture, const SpriteBatch::Vertex& corner1, const SpriteBatch::Vertex& corner2, const SpriteBatch::Transform* transform )
+{
+	double x1, y1, x2, y2;
+	float z;
+	getPixelCoordinates(corner1, transform, x1, y1, z);
+	getPixelCoordinates(corner2, transform, x2, y2, z);
+	double u1 = corner1.u;
+	double u2 = corner2.u;
+	double v1 = corner1.v;
+	double v2 = corner2.v;
+	if( x2 < x1 )
+	{
+		std::swap(x1, x2);
+		std::swap(u1, u2);
+	}
+	if( y2 < y1 )
+	{
+		std::swap(y1, y2);
+		std::swap(v1, v2);
+	}
+
+	// Find the pixels whose centers are inside the quad
+	int left = std::max(static_cast<int>(std::ceil(x1 - 0.5)), 0);
+	int right = std::min(static_cast<int>(std::ceil(x2 - 0.5)), width);
+	int bottom = std::max(static_cast<int>(std::ceil(y1 - 0.5)), 0);
+	int top = std::min(static_cast<int>(std::ceil(y2 - 0.5)), height);
+	if( left >= right || bottom >= top )
+	{
+		return;
+	}
+
+	const Color& color = corner1.color;
+	if( texture == nullptr )
+	{
+		for( int y = bottom; y < top; ++y )
+		{
+			for( int x = left; x < right; ++x )
+			{
+				drawPixel(x, y, z, color);
+			}
+		}
+		return;
+	}
+
+	// Texture coordinates only change along one axis each, so the sampled columns can be reused for every row
+	int textureWidth = texture->getWidth();
+	int textureHeight = texture->getHeight();
+	const Color* texels = texture->getPixels();
+	texelColumns.resize(right - left);
+	for( int x = left; x < right; ++x )
+	{
+		double u = u1 + (x + 0.5 - x1) / (x2 - x1) * (u2 - u1);
+		texelColumns[x - left] = wrapTexel(std::floor(u * textureWidth), textureWidth);
+	}
+
+	for( int y = bottom; y < top; ++y )
+	{
+		double v = v1 + (y + 0.5 - y1) / (y2 - y1) * (v2 - v1);
+		const Color* texelRow = texels + wrapTexel(std::floor(v * textureHeight), textureHeight) * textureWidth;
+		for( int x = left; x < right; ++x )
+		{
+			const Color& texel = texelRow[texelColumns[x - left]];
+			Color pixel(
+				(texel.r * color.r + 127) / 255,
+				(texel.g * color.g + 127) / 255,
+				(texel.b * color.b + 127) / 255,
+				(texel.a * color.a + 127) / 255
+			);
+			drawPixel(x, y, z, pixel);
+		}
+	}
+}
+
+void SoftwareRenderer::rasterizeTileMap( const TileMap* tileMap, const SpriteBatch::Vertex& corner1, const SpriteBatch::Vertex& corner2, const SpriteBatch::Transform* transform )
+{
+	const Image* atlas = tileMap->getAtlas()->getImage();
+	if( atlas == nullptr )
+	{
+		throw Exception("Tile maps can only be drawn by the software renderer in headless mode.");
+	}
+
+	double x1, y1, x2, y2;
+	float z;
+	getPixelCoordinates(corner1, transform, x1, y1, z);
+	getPixelCoordinates(corner2, transform, x2, y2, z);
+	double u1 = corner1.u;
+	double u2 = corner2.u;
+	double v1 = corner1.v;
+	double v2 = corner2.v;
+
+	// Find the pixels whose centers are inside the quad
+	int left = std::max(static_cast<int>(std::ceil(x1 - 0.5)), 0);
+	int right = std::min(static_cast<int>(std::ceil(x2 - 0.5)), width);
+	int bottom = std::max(static_cast<int>(std::ceil(y1 - 0.5)), 0);
+	int top = std::min(static_cast<int>(std::ceil(y2 - 0.5)), height);
+	int frameNumber = TileMap::decodeFrameNumber(corner1.color);
+	for( int y = bottom; y < top; ++y )
+	{
+		double v = v1 + (y + 0.5 - y1) / (y2 - y1) * (v2 - v1);
+		for( int x = left; x < right; ++x )
+		{
+			double u = u1 + (x + 0.5 - x1) / (x2 - x1) * (u2 - u1);
+			int atlasX, atlasY;
+			if( tileMap->findAtlasPixel(u, v, frameNumber, atlasX, atlasY) )
+			{
+				drawPixel(x, y, z, atlas->getPixels()[atlasY * atlas->getWidth() + atlasX]);
+			}
+		}
+	}
+}
+
+void SoftwareRenderer::save( const std::string& fileName )
+{
+	image->save(fileName);
+}
+
+void SoftwareRenderer::setView( double left, double bottom, double right, double top )
+{
+	viewBottom = bottom;
+	viewLeft = left;
+	viewRight = right;
+	viewTop = top;
+}
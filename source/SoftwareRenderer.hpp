@@ -0,0 +1,115 @@
+#ifndef SOFTWARERENDERER_HPP
+#define SOFTWARERENDERER_HPP
+
+#include <string>
+#include <vector>
+
+#include "SpriteBatch.hpp"
+
+class Image;
+class TileMap;
+
+/**
+ * Rasterizes SpriteBatch geometry into an Image on the CPU, so frames can be
+ * rendered without a window or graphics card. It follows the same rules as
+ * the OpenGL renderer: nearest texture sampling, alpha blending, and a depth
+ * test that lets geometry through if it is at least as near as what was
+ * drawn before. The result only depends on what was drawn, so it is the
+ * same on every machine.
+ *
+ * Geometry is sent to the renderer by passing it to
+ * SpriteBatch::setSoftwareRenderer(). Textures must have their pixels in
+ * memory, which is only the case in headless mode.
+ */
+class SoftwareRenderer
+{
+public:
+	/**
+	 * Create a renderer with an image to draw into.
+	 *
+	 * @param width the width of the image, in pixels.
+	 * @param height the height of the image, in pixels.
+	 */
+	SoftwareRenderer( int width, int height );
+
+	~SoftwareRenderer();
+
+	/**
+	 * Clear the image to a color and reset the depth of every pixel.
+	 */
+	void clear( const Color& color );
+
+	/**
+	 * Clear the depth of every pixel, so that everything drawn afterwards is
+	 * drawn on top of the image.
+	 */
+	void clearDepth();
+
+	/**
+	 * Rasterize vertices sent from the SpriteBatch. Quads must be axis
+	 * aligned, which they always are since the batch only translates and
+	 * scales.
+	 *
+	 * @param tileMap the tile map drawn by tile map quads, or nullptr.
+	 * @param transform a transform to apply to the vertices first, or nullptr.
+	 */
+	void draw( SpriteBatch::Primitive primitive, const Texture* texture, const TileMap* tileMap, const SpriteBatch::Vertex* vertices, int count, const SpriteBatch::Transform* transform );
+
+	/**
+	 * Get the image that is drawn into.
+	 */
+	const Image& getImage() const;
+
+	/**
+	 * Save the image to a file.
+	 */
+	void save( const std::string& fileName );
+
+	/**
+	 * Set the area that is mapped onto the image, like glOrtho().
+	 */
+	void setView( double left, double bottom, double right, double top );
+
+private:
+	std::vector<float> depth; /**< The depth of each pixel. Larger values are nearer. */
+	int height;
+	Image* image;
+	std::vector<int> texelColumns; /**< The texture column sampled by each pixel column of the quad being drawn. */
+	double viewBottom;
+	double viewLeft;
+	double viewRight;
+	double viewTop;
+	int width;
+
+	/**
+	 * Draw a pixel if it passes the depth test, blending it with the image.
+	 *
+	 * @param x the x coordinate, from the left.
+	 * @param y the y coordinate, from the bottom.
+	 */
+	void drawPixel( int x, int y, float z, const Color& color );
+
+	/**
+	 * Get the coordinates of a vertex in pixels from the bottom left of the image.
+	 */
+	void getPixelCoordinates( const SpriteBatch::Vertex& vertex, const SpriteBatch::Transform* transform, double& x, double& y, float& z ) const;
+
+	/**
+	 * Rasterize a line by stepping through the pixels between its ends.
+	 */
+	void rasterizeLine( const SpriteBatch::Vertex& start, const SpriteBatch::Vertex& end, const SpriteBatch::Transform* transform );
+
+	/**
+	 * Rasterize an axis aligned quad, given two opposite corners. Pixels are
+	 * drawn if their center is inside the quad.
+	 */
+	void rasterizeQuad( const Image* texture, const SpriteBatch::Vertex& corner1, const SpriteBatch::Vertex& corner2, const SpriteBatch::Transform* transform );
+
+	/**
+	 * Rasterize an axis aligned tile map quad, given two opposite corners,
+	 * looking up each pixel like the tile map shader does.
+	 */
+	void rasterizeTileMap( const TileMap* tileMap, const SpriteBatch::Vertex& corner1, const SpriteBatch::Vertex& corner2, const SpriteBatch::Transform* transform );
+};
+
+#endif // SOFTWARERENDERER_HPP
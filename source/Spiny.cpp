@@ -1,7 +1,10 @@
+#include "ResourceManager.hpp"
 #include "Spiny.hpp"
 
 Spiny::Spiny()
 {
+	static const ResourceId SPINY_ANIMATION = ResourceManager::getResourceId("spiny");
+
 	setStompable(false);
 	setFireproof(true);
 
@@ -10,5 +13,5 @@ Spiny::Spiny()
 
 	setDefaultXVelocity( -1.0 * MOVEMENT_SPEED );
 
-	setAnimation("spiny");
+	setAnimation(SPINY_ANIMATION);
 }
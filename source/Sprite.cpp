@@ -5,7 +5,12 @@
 
 Sprite::Sprite() :
 	size(1.0, 1.0),
+	activityPolicy(ACTIVITY_DEFAULT),
+	occupiedCellsMin(0, 0),
+	occupiedCellsMax(-1, -1),
 	slope(nullptr),
+	sweepIndex(-1),
+	worldIndex(-1),
 	exitedSlopeThisFrame(false),
 	dead(false),
 	flying(false),
@@ -14,6 +19,7 @@ Sprite::Sprite() :
 	deathBoundaryEnabled(true),
 	gravityEnabled(true),
 	holdingEnabled(false),
+	independentUpdateEnabled(false),
 	motionEnabled(true),
 	spriteCollisionsEnabled(true),
 	tileCollisionsEnabled(true),
@@ -151,6 +157,20 @@ void Sprite::kill()
 	}
 }
 
+void Sprite::setActivityPolicy( ActivityPolicy policy )
+{
+	// The world keeps track of the sprites that can't go dormant
+	if( worldIndex != -1 )
+	{
+		getWorld().removeRoamingSprite(this);
+	}
+	activityPolicy = policy;
+	if( worldIndex != -1 )
+	{
+		getWorld().insertRoamingSprite(this);
+	}
+}
+
 void Sprite::setBottom( double y )
 {
 	setY( y );
@@ -212,6 +232,11 @@ void Sprite::setHoldingEnabled( bool enabled )
 	holdingEnabled = enabled;
 }
 
+void Sprite::setIndependentUpdateEnabled( bool enabled )
+{
+	independentUpdateEnabled = enabled;
+}
+
 void Sprite::setLayer( int layer )
 {
 	this->layer = layer * 2 + 1;
@@ -1,8 +1,6 @@
 #ifndef SPRITE_HPP
 #define SPRITE_HPP
 
-#include <list>
-
 #include "Enums.hpp"
 #include "Entity.hpp"
 #include "Vector2.hpp"
@@ -11,6 +9,17 @@ class Player;
 class Tile;
 class World;
 
+/**
+ * How a Sprite is scheduled for updates, depending on how far it is from the view.
+ */
+enum ActivityPolicy
+{
+	ACTIVITY_DEFAULT, /**< Moves at a reduced rate when just outside of the view and sleeps when far from it. Its callbacks still run every frame. */
+	ACTIVITY_SLEEP,   /**< Updated every frame when near the view and sleeps when far from it. */
+	ACTIVITY_DESPAWN, /**< Updated every frame when near the view and destroyed when far from it. */
+	ACTIVITY_ALWAYS   /**< Updated every frame regardless of distance. */
+};
+
 /**
  * An Entity that moves.
  */
@@ -256,6 +265,11 @@ protected:
 	 */
 	virtual void onRelease() {}
 
+	/**
+	 * Set how the Sprite is scheduled for updates when it is away from the view.
+	 */
+	void setActivityPolicy( ActivityPolicy policy );
+
 	/**
 	 * Set whether the sprite is currently flying (off the ground).
 	 */
@@ -266,6 +280,15 @@ protected:
 	 */
 	void setHoldingEnabled( bool enabled );
 
+	/**
+	 * Enable/disable independent updates. Only enable this for sprites whose
+	 * updates never read or modify anything outside of themselves, such as
+	 * particles. While its collisions are disabled, such a Sprite is
+	 * scheduled and updates its motion in parallel with the others, instead
+	 * of in list order.
+	 */
+	void setIndependentUpdateEnabled( bool enabled );
+
 	/**
 	 * Enable/disable Sprite movement.
 	 */
@@ -289,8 +312,12 @@ private:
 
 	Vector2<double> maximumSpeed;
 
-	std::list< Vector2<int> > occupiedCells; /**< Cells that the Sprite is on. */
+	ActivityPolicy activityPolicy; /**< How the Sprite is scheduled for updates. */
+	Vector2<int> occupiedCellsMin; /**< The bottom left Cell that the Sprite is on. */
+	Vector2<int> occupiedCellsMax; /**< The top right Cell that the Sprite is on. The range is empty when it is not on any Cell. */
 	Tile* slope; /**< The slope the sprite is on (if any). */
+	int sweepIndex; /**< The index of the Sprite in the World's sweep list, or -1 if it is not in a World. */
+	int worldIndex; /**< The index of the Sprite in the World's sprite list, or -1 if it is not in a World. */
 	bool exitedSlopeThisFrame; /**< Whether the sprite just exited a slope tile on the current frame. */
 
 	bool dead; /**< Whether the Sprite is dead and should be destroyed. */
@@ -301,6 +328,7 @@ private:
 	bool deathBoundaryEnabled;
 	bool gravityEnabled;
 	bool holdingEnabled; /**< Whether the Sprite can be held by a player. */
+	bool independentUpdateEnabled; /**< Whether the Sprite's updates only affect itself. */
 	bool motionEnabled; /**< Whether the Sprite will undergo motion. */
 	bool spriteCollisionsEnabled;
 	bool tileCollisionsEnabled;
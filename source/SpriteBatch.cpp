@@ -0,0 +1,327 @@
+#include <SDL2/SDL_opengl.h>
+
+#include "SoftwareRenderer.hpp"
+#include "SpriteBatch.hpp"
+#include "Texture.hpp"
+#include "TileMap.hpp"
+
+SpriteBatch::SpriteBatch() :
+	drawCalls(0),
+	frameDrawCalls(0),
+	frameVertices(0),
+	mesh(nullptr),
+	primitive(PRIMITIVE_QUADS),
+	softwareRenderer(nullptr),
+	texture(nullptr),
+	tileMap(nullptr),
+	verticesDrawn(0)
+{
+	loadIdentity();
+}
+
+void SpriteBatch::addVertex( double x, double y, double u, double v, const Color& color )
+{
+	Vertex vertex;
+	vertex.x = static_cast<float>(transform.x + x * transform.scaleX);
+	vertex.y = static_cast<float>(transform.y + y * transform.scaleY);
+	vertex.z = static_cast<float>(transform.z);
+	vertex.u = static_cast<float>(u);
+	vertex.v = static_cast<float>(v);
+	vertex.color = color;
+	if( mesh != nullptr )
+	{
+		mesh->vertices.push_back(vertex);
+		mesh->segments.back().count++;
+	}
+	else
+	{
+		vertices.push_back(vertex);
+	}
+}
+
+void SpriteBatch::beginMesh( Mesh& mesh )
+{
+	meshStack.push_back(this->mesh);
+	this->mesh = &mesh;
+}
+
+void SpriteBatch::drawArrays( Primitive primitive, const Texture* texture, const TileMap* tileMap, const Vertex* vertices, int count, const Transform* transform )
+{
+	drawCalls++;
+	verticesDrawn += count;
+
+	if( softwareRenderer != nullptr )
+	{
+		softwareRenderer->draw(primitive, texture, tileMap, vertices, count, transform);
+		return;
+	}
+
+	if( tileMap != nullptr && !tileMap->bind() )
+	{
+		return;
+	}
+
+	if( transform != nullptr )
+	{
+		glPushMatrix();
+		glTranslated(transform->x, transform->y, transform->z);
+		glScaled(transform->scaleX, transform->scaleY, 1.0);
+	}
+
+	if( texture != nullptr )
+	{
+		glEnable(GL_TEXTURE_2D);
+		texture->bind();
+	}
+	else if( tileMap == nullptr )
+	{
+		glDisable(GL_TEXTURE_2D);
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glEnableClientState(GL_COLOR_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(Vertex), &vertices[0].x);
+	glTexCoordPointer(2, GL_FLOAT, sizeof(Vertex), &vertices[0].u);
+	glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(Vertex), &vertices[0].color.r);
+	glDrawArrays(primitive == PRIMITIVE_LINES ? GL_LINES : GL_QUADS, 0, count);
+	glDisableClientState(GL_COLOR_ARRAY);
+	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
+
+	if( tileMap != nullptr )
+	{
+		TileMap::unbind();
+	}
+
+	// The current color is undefined after drawing with a color array
+	glEnable(GL_TEXTURE_2D);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+
+	if( transform != nullptr )
+	{
+		glPopMatrix();
+	}
+}
+
+void SpriteBatch::drawLine( double x1, double y1, double x2, double y2, const Color& color )
+{
+	setState(PRIMITIVE_LINES, nullptr);
+	addVertex(x1, y1, 0.0, 0.0, color);
+	addVertex(x2, y2, 0.0, 0.0, color);
+}
+
+void SpriteBatch::drawMesh( const Mesh& mesh )
+{
+	if( mesh.isEmpty() )
+	{
+		return;
+	}
+
+	// Copy the geometry into the mesh being recorded, with the transform applied
+	if( this->mesh != nullptr )
+	{
+		for( auto& segment : mesh.segments )
+		{
+			setState(segment.primitive, segment.texture, segment.tileMap);
+			for( int i = segment.first; i < segment.first + segment.count; ++i )
+			{
+				Vertex vertex = mesh.vertices[i];
+				vertex.x = static_cast<float>(transform.x + vertex.x * transform.scaleX);
+				vertex.y = static_cast<float>(transform.y + vertex.y * transform.scaleY);
+				vertex.z = static_cast<float>(transform.z + vertex.z);
+				this->mesh->vertices.push_back(vertex);
+				this->mesh->segments.back().count++;
+			}
+		}
+		return;
+	}
+
+	// The mesh was built without this transform, so it is applied when drawing
+	flush();
+	for( auto& segment : mesh.segments )
+	{
+		drawArrays(segment.primitive, segment.texture, segment.tileMap, &mesh.vertices[segment.first], segment.count, &transform);
+	}
+}
+
+void SpriteBatch::drawOutline( double x, double y, double width, double height, const Color& color )
+{
+	drawLine(x, y, x + width, y, color);
+	drawLine(x + width, y, x + width, y + height, color);
+	drawLine(x + width, y + height, x, y + height, color);
+	drawLine(x, y + height, x, y, color);
+}
+
+void SpriteBatch::drawQuad( double x, double y, double width, double height, const Color& color )
+{
+	setState(PRIMITIVE_QUADS, nullptr);
+	addVertex(x, y, 0.0, 0.0, color);
+	addVertex(x + width, y, 0.0, 0.0, color);
+	addVertex(x + width, y + height, 0.0, 0.0, color);
+	addVertex(x, y + height, 0.0, 0.0, color);
+}
+
+void SpriteBatch::drawQuad( const Texture* texture, double x, double y, double width, double height, double left, double bottom, double right, double top, const Color& color )
+{
+	setState(PRIMITIVE_QUADS, texture);
+	addVertex(x, y, left, bottom, color);
+	addVertex(x + width, y, right, bottom, color);
+	addVertex(x + width, y + height, right, top, color);
+	addVertex(x, y + height, left, top, color);
+}
+
+void SpriteBatch::drawTileMap( const TileMap* tileMap, double x, double y, double width, double height, int frameNumber )
+{
+	// The frame number is kept in the color, so that every quad can show a different frame
+	Color color = TileMap::encodeFrameNumber(frameNumber);
+	setState(PRIMITIVE_TILEMAP, nullptr, tileMap);
+	addVertex(x, y, x, y, color);
+	addVertex(x + width, y, x + width, y, color);
+	addVertex(x + width, y + height, x + width, y + height, color);
+	addVertex(x, y + height, x, y + height, color);
+}
+
+void SpriteBatch::endMesh()
+{
+	if( meshStack.empty() )
+	{
+		mesh = nullptr;
+		return;
+	}
+
+	mesh = meshStack.back();
+	meshStack.pop_back();
+}
+
+void SpriteBatch::finishFrame()
+{
+	flush();
+	loadIdentity();
+	transformStack.clear();
+	frameDrawCalls = drawCalls;
+	frameVertices = verticesDrawn;
+	drawCalls = 0;
+	verticesDrawn = 0;
+}
+
+void SpriteBatch::flush()
+{
+	if( vertices.empty() )
+	{
+		return;
+	}
+
+	drawArrays(primitive, texture, tileMap, &vertices[0], vertices.size());
+	vertices.clear();
+}
+
+int SpriteBatch::getDrawCallCount() const
+{
+	return frameDrawCalls;
+}
+
+int SpriteBatch::getVertexCount() const
+{
+	return frameVertices;
+}
+
+void SpriteBatch::loadIdentity()
+{
+	transform.scaleX = 1.0;
+	transform.scaleY = 1.0;
+	transform.x = 0.0;
+	transform.y = 0.0;
+	transform.z = 0.0;
+}
+
+void SpriteBatch::popTransform()
+{
+	transform = transformStack.back();
+	transformStack.pop_back();
+}
+
+void SpriteBatch::pushTransform()
+{
+	transformStack.push_back(transform);
+}
+
+void SpriteBatch::scale( double x, double y )
+{
+	transform.scaleX *= x;
+	transform.scaleY *= y;
+}
+
+void SpriteBatch::setSoftwareRenderer( SoftwareRenderer* renderer )
+{
+	flush();
+	softwareRenderer = renderer;
+}
+
+void SpriteBatch::setState( Primitive primitive, const Texture* texture, const TileMap* tileMap )
+{
+	if( mesh != nullptr )
+	{
+		if( mesh->segments.empty() || mesh->segments.back().primitive != primitive || mesh->segments.back().texture != texture ||
+			mesh->segments.back().tileMap != tileMap )
+		{
+			Mesh::Segment segment;
+			segment.primitive = primitive;
+			segment.texture = texture;
+			segment.tileMap = tileMap;
+			segment.first = mesh->vertices.size();
+			segment.count = 0;
+			mesh->segments.push_back(segment);
+		}
+		return;
+	}
+
+	if( primitive != this->primitive || texture != this->texture || tileMap != this->tileMap )
+	{
+		flush();
+		this->primitive = primitive;
+		this->texture = texture;
+		this->tileMap = tileMap;
+	}
+}
+
+void SpriteBatch::translate( double x, double y, double z )
+{
+	transform.x += x * transform.scaleX;
+	transform.y += y * transform.scaleY;
+	transform.z += z;
+}
+
+void SpriteBatch::Mesh::clear()
+{
+	segments.clear();
+	vertices.clear();
+}
+
+int SpriteBatch::Mesh::getVertexCount() const
+{
+	return vertices.size();
+}
+
+bool SpriteBatch::Mesh::isEmpty() const
+{
+	return vertices.empty();
+}
+
+void SpriteBatch::Mesh::translateTextureCoordinates( int first, int count, double u, double v )
+{
+	for( int i = first; i < first + count; ++i )
+	{
+		vertices[i].u = static_cast<float>(vertices[i].u + u);
+		vertices[i].v = static_cast<float>(vertices[i].v + v);
+	}
+}
+
+void SpriteBatch::Mesh::translateVertices( int first, int count, double x, double y )
+{
+	for( int i = first; i < first + count; ++i )
+	{
+		vertices[i].x = static_cast<float>(vertices[i].x + x);
+		vertices[i].y = static_cast<float>(vertices[i].y + y);
+	}
+}
@@ -0,0 +1,278 @@
+#ifndef SPRITEBATCH_HPP
+#define SPRITEBATCH_HPP
+
+#include <vector>
+
+#include "Color.hpp"
+
+class SoftwareRenderer;
+class Texture;
+class TileMap;
+
+/**
+ * Collects quads and lines into vertex arrays and draws them with as few
+ * OpenGL calls as possible. Transforms are applied on the CPU, on top of
+ * whatever OpenGL matrices are set when the batch is flushed, so the batch
+ * must be flushed before those matrices change.
+ *
+ * Vertices are drawn in the order they were added. A new draw call is only
+ * started when the texture, tile map or primitive type changes.
+ *
+ * The batch can also draw into a SoftwareRenderer instead of OpenGL, which
+ * is how frames are rendered without a window or graphics card.
+ */
+class SpriteBatch
+{
+public:
+	class Mesh;
+
+	/**
+	 * The type of primitive stored in the batch.
+	 */
+	enum Primitive
+	{
+		PRIMITIVE_LINES,
+		PRIMITIVE_QUADS,
+		PRIMITIVE_TILEMAP /**< Quads whose texture coordinates are cells of a TileMap. */
+	};
+
+	/**
+	 * A scale followed by a translation.
+	 */
+	struct Transform
+	{
+		double scaleX;
+		double scaleY;
+		double x;
+		double y;
+		double z;
+	};
+
+	/**
+	 * A vertex in the layout used by the OpenGL vertex arrays.
+	 */
+	struct Vertex
+	{
+		float x;
+		float y;
+		float z;
+		float u;
+		float v;
+		Color color;
+	};
+
+	SpriteBatch();
+
+	/**
+	 * Start adding everything drawn to a mesh instead of the batch, until
+	 * endMesh() is called. The current transform is applied as usual. Meshes
+	 * can be recorded while another one is being recorded.
+	 */
+	void beginMesh( Mesh& mesh );
+
+	/**
+	 * Add a line to the batch. Lines are only used for debugging overlays.
+	 */
+	void drawLine( double x1, double y1, double x2, double y2, const Color& color );
+
+	/**
+	 * Draw a mesh with the current transform. This takes one draw call for
+	 * every texture and primitive type in the mesh. While another mesh is
+	 * being recorded, the geometry is copied into it instead.
+	 */
+	void drawMesh( const Mesh& mesh );
+
+	/**
+	 * Add the outline of a rectangle to the batch, as lines.
+	 */
+	void drawOutline( double x, double y, double width, double height, const Color& color );
+
+	/**
+	 * Add an untextured quad to the batch.
+	 *
+	 * @param x the left coordinate of the quad.
+	 * @param y the bottom coordinate of the quad.
+	 * @param width the width of the quad.
+	 * @param height the height of the quad.
+	 * @param color the color of the quad.
+	 */
+	void drawQuad( double x, double y, double width, double height, const Color& color );
+
+	/**
+	 * Add a textured quad to the batch. Swap the texture coordinates to mirror it.
+	 *
+	 * @param texture the texture to draw the quad with.
+	 * @param x the left coordinate of the quad.
+	 * @param y the bottom coordinate of the quad.
+	 * @param width the width of the quad.
+	 * @param height the height of the quad.
+	 * @param left the texture coordinate of the left edge.
+	 * @param bottom the texture coordinate of the bottom edge.
+	 * @param right the texture coordinate of the right edge.
+	 * @param top the texture coordinate of the top edge.
+	 * @param color the color the texture is tinted with.
+	 */
+	void drawQuad( const Texture* texture, double x, double y, double width, double height, double left, double bottom, double right, double top, const Color& color = Color(255, 255, 255, 255) );
+
+	/**
+	 * Add a quad that shows the cells of a tile map under it, one unit per
+	 * cell. The quad is drawn in a single draw call by the tile map shader.
+	 *
+	 * @param tileMap the tile map to draw.
+	 * @param x the left cell of the quad.
+	 * @param y the bottom cell of the quad.
+	 * @param width the width of the quad, in cells.
+	 * @param height the height of the quad, in cells.
+	 * @param frameNumber the frame number that animated cells are shown at.
+	 */
+	void drawTileMap( const TileMap* tileMap, double x, double y, double width, double height, int frameNumber );
+
+	/**
+	 * Stop adding to the mesh passed to the last call to beginMesh(), and go
+	 * back to adding to the mesh that was being recorded before it, if any.
+	 */
+	void endMesh();
+
+	/**
+	 * Flush the batch, reset the transform, and update the statistics for the
+	 * frame that just ended.
+	 */
+	void finishFrame();
+
+	/**
+	 * Draw everything in the batch.
+	 */
+	void flush();
+
+	/**
+	 * Get the number of draw calls made during the last frame.
+	 */
+	int getDrawCallCount() const;
+
+	/**
+	 * Get the number of vertices drawn during the last frame.
+	 */
+	int getVertexCount() const;
+
+	/**
+	 * Reset the current transform.
+	 */
+	void loadIdentity();
+
+	/**
+	 * Restore the transform saved by the last call to pushTransform().
+	 */
+	void popTransform();
+
+	/**
+	 * Save the current transform.
+	 */
+	void pushTransform();
+
+	/**
+	 * Scale everything drawn after this call.
+	 */
+	void scale( double x, double y );
+
+	/**
+	 * Draw into a SoftwareRenderer instead of OpenGL. This flushes the batch.
+	 *
+	 * @param renderer the renderer to draw into, or nullptr to draw with OpenGL again.
+	 */
+	void setSoftwareRenderer( SoftwareRenderer* renderer );
+
+	/**
+	 * Move everything drawn after this call.
+	 */
+	void translate( double x, double y, double z = 0.0 );
+
+private:
+	int drawCalls; /**< The number of draw calls made so far during the current frame. */
+	int frameDrawCalls; /**< The number of draw calls made during the last frame. */
+	int frameVertices; /**< The number of vertices drawn during the last frame. */
+	Mesh* mesh; /**< The mesh being added to, if any. */
+	std::vector<Mesh*> meshStack; /**< The meshes that were being added to before the current one. */
+	Primitive primitive;
+	SoftwareRenderer* softwareRenderer; /**< The renderer drawn into instead of OpenGL, if any. */
+	const Texture* texture; /**< The texture of the quads in the batch, or nullptr if they are untextured. */
+	const TileMap* tileMap; /**< The tile map drawn by the quads in the batch, if they are tile map quads. */
+	Transform transform;
+	std::vector<Transform> transformStack;
+	std::vector<Vertex> vertices;
+	int verticesDrawn; /**< The number of vertices drawn so far during the current frame. */
+
+	/**
+	 * Add a vertex to the batch, applying the current transform.
+	 */
+	void addVertex( double x, double y, double u, double v, const Color& color );
+
+	/**
+	 * Draw vertices from an array with a single draw call.
+	 *
+	 * @param transform a transform applied to vertices that were recorded in a mesh.
+	 */
+	void drawArrays( Primitive primitive, const Texture* texture, const TileMap* tileMap, const Vertex* vertices, int count, const Transform* transform = nullptr );
+
+	/**
+	 * Flush the batch if it holds a different texture, tile map or primitive type.
+	 */
+	void setState( Primitive primitive, const Texture* texture, const TileMap* tileMap = nullptr );
+};
+
+/**
+ * Geometry that is recorded from the SpriteBatch once and then drawn many
+ * times without being rebuilt.
+ */
+class SpriteBatch::Mesh
+{
+	friend class SpriteBatch;
+public:
+	/**
+	 * Remove all geometry from the mesh.
+	 */
+	void clear();
+
+	/**
+	 * Get the number of vertices in the mesh.
+	 */
+	int getVertexCount() const;
+
+	/**
+	 * Check if the mesh has no geometry.
+	 */
+	bool isEmpty() const;
+
+	/**
+	 * Move a range of vertices.
+	 *
+	 * @param first the index of the first vertex to move.
+	 * @param count the number of vertices to move.
+	 */
+	void translateVertices( int first, int count, double x, double y );
+
+	/**
+	 * Move the texture coordinates of a range of vertices.
+	 *
+	 * @param first the index of the first vertex to change.
+	 * @param count the number of vertices to change.
+	 */
+	void translateTextureCoordinates( int first, int count, double u, double v );
+
+private:
+	/**
+	 * A run of vertices that share a texture, tile map and primitive type.
+	 */
+	struct Segment
+	{
+		Primitive primitive;
+		const Texture* texture;
+		const TileMap* tileMap;
+		int first;
+		int count;
+	};
+
+	std::vector<Segment> segments;
+	std::vector<Vertex> vertices;
+};
+
+#endif // SPRITEBATCH_HPP
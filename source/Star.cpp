@@ -1,8 +1,11 @@
+#include "ResourceManager.hpp"
 #include "Star.hpp"
 
 Star::Star()
 {
-	setAnimation("star");
+	static const ResourceId STAR_ANIMATION = ResourceManager::getResourceId("star");
+
+	setAnimation(STAR_ANIMATION);
 	setXVelocity(MOVEMENT_SPEED);
 	setGravityEnabled(false);
 	setYAcceleration(GRAVITY);
@@ -1,11 +1,26 @@
-#include <GL/gl.h>
-
 #include "Font.hpp"
 #include "Globals.hpp"
+#include "Image.hpp"
 #include "Text.hpp"
+#include "TextMeshCache.hpp"
+#include "Texture.hpp"
+
+static const int GLYPH_COLUMNS = 16; /**< The number of glyphs in each row of a glyph texture. */
+
+/**
+ * A font made from bitmap data, drawn with one textured quad per character.
+ */
+struct GlyphFont
+{
+	int charWidth;
+	int charHeight;
+	Texture* texture;
+	TextMeshCache meshes; /**< Laid out strings, so they aren't rebuilt every frame. */
+};
 
 static unsigned char borderedFontData[FONT_GLYPHS][FONT_HEIGHT + 2][FONT_WIDTH + 2];
-static bool borderedFontDataInitialized = false;
+static GlyphFont borderedFont = { FONT_WIDTH + 2, FONT_HEIGHT + 2, nullptr, {} };
+static GlyphFont font = { FONT_WIDTH, FONT_HEIGHT, nullptr, {} };
 
 static void createBorderedFontData()
 {
@@ -44,84 +59,91 @@ static void createBorderedFontData()
 	}
 }
 
-static void drawText(const std::string& text, int charWidth, int charHeight, const unsigned char* data)
+/**
+ * Create a texture with every glyph of a font, in rows of GLYPH_COLUMNS.
+ * Pixels set to 1 in the data are white, 2 are black, and 0 are transparent.
+ */
+static Texture* createGlyphTexture( int charWidth, int charHeight, const unsigned char* data )
 {
-	glDisable(GL_TEXTURE_2D);
-	int x = 0;
-	int y = 0;
-	glBegin(GL_QUADS);
-	for( std::size_t i = 0; i < text.size(); ++i )
+	Image image(GLYPH_COLUMNS * charWidth, FONT_GLYPHS / GLYPH_COLUMNS * charHeight);
+	for( int i = 0; i < FONT_GLYPHS; ++i )
 	{
-		unsigned char ch = text[i];
-		if( ch > 0x7f )
+		int left = (i % GLYPH_COLUMNS) * charWidth;
+		int top = (i / GLYPH_COLUMNS) * charHeight;
+		for( int y = 0; y < charHeight; ++y )
 		{
-			ch = 0x7f;
-		}
-
-		if( ch == '\n' ) // newline
-		{
-			y++;
-			x = 0;
-			continue;
-		}
-
-		// Draw the right character
-		for( int cx = 0; cx < charWidth; ++cx )
-		{
-			for( int cy = 0; cy < charHeight; ++cy )
+			for( int x = 0; x < charWidth; ++x )
 			{
-				unsigned char p = data[ch * charWidth * charHeight + (charHeight - 1 - cy) * charWidth + cx];
-				if( p != 0 )
+				unsigned char p = data[i * charWidth * charHeight + y * charWidth + x];
+				Color color(0, 0, 0, 0);
+				if( p == 1 )
 				{
-					if( p == 1 )
-					{
-						glColor4ub(0xff, 0xff, 0xff, 0xff);
-					}
-					else
-					{
-						glColor4ub(0, 0, 0, 0xff);
-					}
-					glVertex2i(x * (charWidth + 1) + cx, y * -1 * (charHeight + 1) + cy);
-					glVertex2i(x * (charWidth + 1) + cx + 1, y * -1 * (charHeight + 1) + cy);
-					glVertex2i(x * (charWidth + 1) + cx + 1, y * -1 * (charHeight + 1) + cy + 1);
-					glVertex2i(x * (charWidth + 1) + cx, y * -1 * (charHeight + 1) + cy + 1);
+					color = Color(0xff, 0xff, 0xff, 0xff);
+				}
+				else if( p == 2 )
+				{
+					color = Color(0, 0, 0, 0xff);
 				}
+				image.setPixel(left + x, top + y, color);
 			}
 		}
-		x++;
 	}
-	glEnd();
-	glEnable(GL_TEXTURE_2D);
+
+	return new Texture(image);
 }
 
-void drawBorderedText(const std::string& text)
+static void drawText(const std::string& text, GlyphFont& glyphFont)
 {
-	if( !borderedFontDataInitialized )
+	// Glyphs are in rows of GLYPH_COLUMNS, and every character has one
+	int charWidth = glyphFont.charWidth;
+	int charHeight = glyphFont.charHeight;
+	glyphFont.meshes.drawText(text, glyphFont.texture, charWidth, charHeight, 1, [charWidth, charHeight]( unsigned char ch, int& x, int& y )
 	{
-		createBorderedFontData();
-		borderedFontDataInitialized = true;
-	}
+		x = (ch % GLYPH_COLUMNS) * charWidth;
+		y = (ch / GLYPH_COLUMNS) * charHeight;
+		return true;
+	});
+}
 
-	drawText(text, FONT_WIDTH + 2, FONT_HEIGHT + 2, &borderedFontData[0][0][0]);
+void createTextTextures()
+{
+	createBorderedFontData();
+	borderedFont.texture = createGlyphTexture(borderedFont.charWidth, borderedFont.charHeight, &borderedFontData[0][0][0]);
+	font.texture = createGlyphTexture(font.charWidth, font.charHeight, &fontData[0][0][0]);
+}
+
+void drawBorderedText(const std::string& text)
+{
+	drawText(text, borderedFont);
 }
 
 void drawBorderedTextScaled(const std::string& text)
 {
-	glPushMatrix();
-	glScalef(1.0 / UNIT_SIZE, 1.0 / UNIT_SIZE, 1.0);
+	SPRITE_BATCH.pushTransform();
+	SPRITE_BATCH.scale(1.0 / UNIT_SIZE, 1.0 / UNIT_SIZE);
 	drawBorderedText(text);
-	glPopMatrix();
+	SPRITE_BATCH.popTransform();
 }
 
 void drawText(const std::string& text)
 {
-	drawText(text, FONT_WIDTH, FONT_HEIGHT, &fontData[0][0][0]);
+	drawText(text, font);
 }
 
 void drawTextScaled( const std::string& text )
 {
-	glPushMatrix();
-	glScalef(1.0 / UNIT_SIZE, 1.0 / UNIT_SIZE, 1.0);
+	SPRITE_BATCH.pushTransform();
+	SPRITE_BATCH.scale(1.0 / UNIT_SIZE, 1.0 / UNIT_SIZE);
 	drawText(text);
-	glPopMatrix();
+	SPRITE_BATCH.popTransform();
+}
+
+void freeTextTextures()
+{
+	for( GlyphFont* glyphFont : { &borderedFont, &font } )
+	{
+		delete glyphFont->texture;
+		glyphFont->texture = nullptr;
+		glyphFont->meshes.clear();
+	}
 }
@@ -9,6 +9,12 @@
 
 #include "Font.hpp"
 
+/**
+ * Create the glyph textures that text is drawn with. This must be called
+ * once the OpenGL context exists, before any text is drawn.
+ */
+void createTextTextures();
+
 /**
  * Draw bordered text.
  */
@@ -29,4 +35,9 @@ void drawText(const std::string& text);
  */
 void drawTextScaled( const std::string& text );
 
+/**
+ * Free the glyph textures created by createTextTextures().
+ */
+void freeTextTextures();
+
 #endif // TEXT_HPP
@@ -0,0 +1,73 @@
+#include "Globals.hpp"
+#include "TextMeshCache.hpp"
+#include "Texture.hpp"
+
+static const std::size_t TEXT_CACHE_SIZE = 64; /**< The number of laid out strings kept before the cache is emptied. */
+
+void TextMeshCache::clear()
+{
+	meshes.clear();
+}
+
+void TextMeshCache::drawText( const std::string& text, const Texture* texture, int charWidth, int charHeight, int spacing, const GlyphLookup& findGlyph )
+{
+	SpriteBatch& batch = SPRITE_BATCH;
+
+	// Lay out the string the first time it is drawn
+	auto it = meshes.find(text);
+	if( it == meshes.end() )
+	{
+		if( meshes.size() >= TEXT_CACHE_SIZE )
+		{
+			meshes.clear();
+		}
+		it = meshes.insert(std::make_pair(text, SpriteBatch::Mesh())).first;
+
+		double textureWidth = texture->getWidth();
+		double textureHeight = texture->getHeight();
+
+		batch.pushTransform();
+		batch.loadIdentity();
+		batch.beginMesh(it->second);
+		int x = 0;
+		int y = 0;
+		for( std::size_t i = 0; i < text.size(); ++i )
+		{
+			unsigned char ch = text[i];
+			if( ch > 0x7f )
+			{
+				ch = 0x7f;
+			}
+
+			if( ch == '\n' ) // newline
+			{
+				y++;
+				x = 0;
+				continue;
+			}
+
+			// Draw the right character
+			int left;
+			int top;
+			if( findGlyph(ch, left, top) )
+			{
+				batch.drawQuad(
+					texture,
+					x * (charWidth + spacing),
+					y * -1 * (charHeight + spacing),
+					charWidth,
+					charHeight,
+					left / textureWidth + 1e-6,
+					(top + charHeight) / textureHeight - 1e-6,
+					(left + charWidth) / textureWidth - 1e-6,
+					top / textureHeight + 1e-6
+				);
+			}
+			x++;
+		}
+		batch.endMesh();
+		batch.popTransform();
+	}
+
+	batch.drawMesh(it->second);
+}
@@ -0,0 +1,52 @@
+#ifndef TEXTMESHCACHE_HPP
+#define TEXTMESHCACHE_HPP
+
+#include <functional>
+#include <map>
+#include <string>
+
+#include "SpriteBatch.hpp"
+
+class Texture;
+
+/**
+ * Lays out strings of fixed width characters as meshes with one textured
+ * quad per character, and keeps the meshes so that text which is drawn
+ * every frame isn't rebuilt. Fonts only differ in where their glyphs are,
+ * which is looked up by a function passed in when drawing.
+ */
+class TextMeshCache
+{
+public:
+	/**
+	 * Find the glyph of a character on the texture of a font.
+	 *
+	 * @param ch the character, with anything above 0x7f replaced by 0x7f.
+	 * @param x set to the left coordinate of the glyph on the texture.
+	 * @param y set to the top coordinate of the glyph on the texture.
+	 * @return false if nothing is drawn for the character. It still takes up space.
+	 */
+	typedef std::function<bool( unsigned char ch, int& x, int& y )> GlyphLookup;
+
+	/**
+	 * Discard every laid out string.
+	 */
+	void clear();
+
+	/**
+	 * Draw a string, laying it out the first time it is drawn.
+	 *
+	 * @param text the text to draw. Each newline starts a new line.
+	 * @param texture the texture with the glyphs of the font.
+	 * @param charWidth the width of each character, in pixels.
+	 * @param charHeight the height of each character, in pixels.
+	 * @param spacing the space left between characters and between lines, in pixels.
+	 * @param findGlyph finds the glyph of a character on the texture.
+	 */
+	void drawText( const std::string& text, const Texture* texture, int charWidth, int charHeight, int spacing, const GlyphLookup& findGlyph );
+
+private:
+	std::map<std::string, SpriteBatch::Mesh> meshes; /**< Laid out strings. */
+};
+
+#endif // TEXTMESHCACHE_HPP
@@ -1,6 +1,8 @@
 #include "Text.hpp"
 #include "TextParticle.hpp"
 
+DEFINE_POOLED_ALLOCATION(TextParticle)
+
 TextParticle::TextParticle( const std::string& text, double duration ) :
 	Particle( nullptr, duration ),
 	text(text)
@@ -1,6 +1,7 @@
 #ifndef TEXTPARTICLE_HPP
 #define TEXTPARTICLE_HPP
 
+#include "ObjectPool.hpp"
 #include "Particle.hpp"
 
 /**
@@ -18,6 +19,8 @@ public:
 	 */
 	TextParticle( const std::string& text, double duration );
 
+	DECLARE_POOLED_ALLOCATION()
+
 private:
 	std::string text;
 
@@ -1,9 +1,21 @@
 #include <GL/gl.h>
 
+#include "Globals.hpp"
 #include "Texture.hpp"
 
-Texture::Texture( const Image& image )
+Texture::Texture( const Image& image ) :
+	height(image.getHeight()),
+	id(0),
+	image(nullptr),
+	width(image.getWidth())
 {
+	if( SETTINGS.headless )
+	{
+		this->image = new Image(image.getWidth(), image.getHeight());
+		this->image->blit(image, 0, 0);
+		return;
+	}
+
 	// Create a texture unit
 	glGenTextures(1, &id);
 
@@ -11,6 +23,9 @@ Texture::Texture( const Image& image )
 	glBindTexture(GL_TEXTURE_2D, id);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	// Repeat, so that backgrounds can be tiled by wrapping the texture coordinates
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
 
 	unsigned numberOfBytes = 4 * image.getWidth() * image.getHeight();
 	unsigned char* bytes = new unsigned char[numberOfBytes];
@@ -35,6 +50,12 @@ Texture::Texture( const Image& image )
 
 Texture::~Texture()
 {
+	if( image != nullptr )
+	{
+		delete image;
+		return;
+	}
+
 	glDeleteTextures(1, &id);
 }
 
@@ -42,3 +63,18 @@ void Texture::bind() const
 {
 	glBindTexture( GL_TEXTURE_2D, id );
 }
+
+int Texture::getHeight() const
+{
+	return height;
+}
+
+const Image* Texture::getImage() const
+{
+	return image;
+}
+
+int Texture::getWidth() const
+{
+	return width;
+}
@@ -4,7 +4,8 @@
 #include "Image.hpp"
 
 /**
- * A texture stored in graphics memory.
+ * A texture stored in graphics memory. In headless mode there is no OpenGL
+ * context, so the pixels are kept in memory for the SoftwareRenderer instead.
  */
 class Texture
 {
@@ -21,8 +22,27 @@ public:
 	 */
 	void bind() const;
 
+	/**
+	 * Get the height of the texture, in pixels.
+	 */
+	int getHeight() const;
+
+	/**
+	 * Get the pixels of the texture, or nullptr if they are only stored in
+	 * graphics memory.
+	 */
+	const Image* getImage() const;
+
+	/**
+	 * Get the width of the texture, in pixels.
+	 */
+	int getWidth() const;
+
 private:
+	int height;
 	unsigned int id;
+	Image* image;
+	int width;
 };
 
 #endif // TEXTURE_HPP
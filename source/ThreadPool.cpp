@@ -0,0 +1,100 @@
+#include "ThreadPool.hpp"
+
+ThreadPool::ThreadPool( int threadCount ) :
+	generation(0),
+	nextIndex(0),
+	quitting(false),
+	runningWorkers(0),
+	task(nullptr),
+	taskCount(0)
+{
+	for( int i = 1; i < threadCount; ++i )
+	{
+		workers.push_back(std::thread(&ThreadPool::workerMain, this));
+	}
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quitting = true;
+	}
+	startCondition.notify_all();
+
+	for( auto& worker : workers )
+	{
+		worker.join();
+	}
+}
+
+int ThreadPool::getThreadCount() const
+{
+	return workers.size() + 1;
+}
+
+void ThreadPool::parallelFor( int count, const std::function<void(int)>& task )
+{
+	if( workers.empty() || count <= 1 )
+	{
+		for( int i = 0; i < count; ++i )
+		{
+			task(i);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		this->task = &task;
+		taskCount = count;
+		nextIndex = 0;
+		runningWorkers = workers.size();
+		generation++;
+	}
+	startCondition.notify_all();
+
+	// Help out, then wait for the workers to finish whatever they picked up
+	runTasks();
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finishedCondition.wait(lock, [this]{ return runningWorkers == 0; });
+	this->task = nullptr;
+}
+
+void ThreadPool::runTasks()
+{
+	for( int i = nextIndex++; i < taskCount; i = nextIndex++ )
+	{
+		(*task)(i);
+	}
+}
+
+void ThreadPool::workerMain()
+{
+	int lastGeneration = 0;
+	while( true )
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			startCondition.wait(lock, [&]{ return quitting || generation != lastGeneration; });
+			if( quitting )
+			{
+				return;
+			}
+			lastGeneration = generation;
+		}
+
+		runTasks();
+
+		bool finished;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finished = (--runningWorkers == 0);
+		}
+		if( finished )
+		{
+			finishedCondition.notify_one();
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that run the iterations of a loop in
+ * parallel. The calling thread takes part in the work, so a pool with a
+ * thread count of one runs everything on the calling thread.
+ */
+class ThreadPool
+{
+public:
+	/**
+	 * Create a thread pool.
+	 *
+	 * @param threadCount the total number of threads to run work on,
+	 * including the calling thread.
+	 */
+	ThreadPool( int threadCount );
+
+	/**
+	 * Stop and join all of the worker threads.
+	 */
+	~ThreadPool();
+
+	/**
+	 * Get the total number of threads that work is run on.
+	 */
+	int getThreadCount() const;
+
+	/**
+	 * Run a task for every index in [0, count), returning once all of them
+	 * have finished. Tasks may run in any order and on any thread, so they
+	 * must not depend on each other.
+	 */
+	void parallelFor( int count, const std::function<void(int)>& task );
+
+private:
+	std::condition_variable finishedCondition;
+	int generation; /**< Incremented every time a new loop is started. */
+	std::mutex mutex;
+	std::atomic<int> nextIndex;
+	bool quitting;
+	int runningWorkers;
+	std::condition_variable startCondition;
+	const std::function<void(int)>* task;
+	int taskCount;
+	std::vector<std::thread> workers;
+
+	void runTasks();
+	void workerMain();
+};
+
+#endif // THREADPOOL_HPP
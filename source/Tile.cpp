@@ -8,7 +8,10 @@ Tile::Tile(TileCollisionBehavior type, bool tilesetEnabled) :
 	width(1),
 	height(1),
 	collisionBehavior(type),
-	tilesetEnabled(tilesetEnabled)
+	tilesetEnabled(tilesetEnabled),
+	renderCacheEnabled(true),
+	renderCached(false),
+	updateEnabled(false)
 {
 	setLayer(0);
 }
@@ -53,6 +56,27 @@ int Tile::getHeightInt() const
 
 const Animation* Tile::getTilesetAnimation( int x, int y ) const
 {
+	// The names are only looked up once, since this is called for every tile that is drawn
+	static const ResourceId TILE = ResourceManager::getResourceId("tile");
+	static const ResourceId TILE_CORNER_NE = ResourceManager::getResourceId("tile_corner_ne");
+	static const ResourceId TILE_CORNER_NW = ResourceManager::getResourceId("tile_corner_nw");
+	static const ResourceId TILE_CORNER_SE = ResourceManager::getResourceId("tile_corner_se");
+	static const ResourceId TILE_CORNER_SW = ResourceManager::getResourceId("tile_corner_sw");
+	static const ResourceId TILE_E = ResourceManager::getResourceId("tile_e");
+	static const ResourceId TILE_N = ResourceManager::getResourceId("tile_n");
+	static const ResourceId TILE_NE = ResourceManager::getResourceId("tile_ne");
+	static const ResourceId TILE_NW = ResourceManager::getResourceId("tile_nw");
+	static const ResourceId TILE_S = ResourceManager::getResourceId("tile_s");
+	static const ResourceId TILE_SE = ResourceManager::getResourceId("tile_se");
+	static const ResourceId TILE_SLOPE_DOWN = ResourceManager::getResourceId("tile_slope_down");
+	static const ResourceId TILE_SLOPE_DOWN_LEFT = ResourceManager::getResourceId("tile_slope_down_left");
+	static const ResourceId TILE_SLOPE_DOWN_RIGHT = ResourceManager::getResourceId("tile_slope_down_right");
+	static const ResourceId TILE_SLOPE_UP = ResourceManager::getResourceId("tile_slope_up");
+	static const ResourceId TILE_SLOPE_UP_LEFT = ResourceManager::getResourceId("tile_slope_up_left");
+	static const ResourceId TILE_SLOPE_UP_RIGHT = ResourceManager::getResourceId("tile_slope_up_right");
+	static const ResourceId TILE_SW = ResourceManager::getResourceId("tile_sw");
+	static const ResourceId TILE_W = ResourceManager::getResourceId("tile_w");
+
 	const Animation* animation = nullptr;
 
 	// Are we a slope?
@@ -64,22 +88,22 @@ const Animation* Tile::getTilesetAnimation( int x, int y ) const
 			{
 				if( x == 0 )
 				{
-					animation = getAnimation( "tile_slope_down_left" );
+					animation = getAnimation( TILE_SLOPE_DOWN_LEFT );
 				}
 				else
 				{
-					animation = getAnimation( "tile_slope_down_right" );
+					animation = getAnimation( TILE_SLOPE_DOWN_RIGHT );
 				}
 			}
 			else
 			{
 				if( x == 0 )
 				{
-					animation = getAnimation( "tile_slope_up_left" );
+					animation = getAnimation( TILE_SLOPE_UP_LEFT );
 				}
 				else
 				{
-					animation = getAnimation( "tile_slope_up_right" );
+					animation = getAnimation( TILE_SLOPE_UP_RIGHT );
 				}
 			}
 		}
@@ -87,11 +111,11 @@ const Animation* Tile::getTilesetAnimation( int x, int y ) const
 		{
 			if( collisionBehavior == TILE_SLOPE_DOWN )
 			{
-				animation = getAnimation( "tile_slope_down" );
+				animation = getAnimation( TILE_SLOPE_DOWN );
 			}
 			else
 			{
-				animation = getAnimation( "tile_slope_up" );
+				animation = getAnimation( TILE_SLOPE_UP );
 			}
 		}
 	}
@@ -102,73 +126,73 @@ const Animation* Tile::getTilesetAnimation( int x, int y ) const
 		{
 			if( y == height - 1 )
 			{
-				animation = getAnimation( "tile_nw" );
+				animation = getAnimation( TILE_NW );
 				if( animation == nullptr )
 				{
-					animation = getAnimation( "tile_w" );
+					animation = getAnimation( TILE_W );
 					if( animation == nullptr )
 					{
-						animation = getAnimation( "tile_n" );
+						animation = getAnimation( TILE_N );
 					}
 				}
 			}
 			else if( y == 0 )
 			{
-				animation = getAnimation( "tile_sw" );
+				animation = getAnimation( TILE_SW );
 				if( animation == nullptr )
 				{
-					animation = getAnimation( "tile_w" );
+					animation = getAnimation( TILE_W );
 					if( animation == nullptr )
 					{
-						animation = getAnimation( "tile_s" );
+						animation = getAnimation( TILE_S );
 					}
 				}
 			}
 			else
 			{
-				animation = getAnimation( "tile_w" );
+				animation = getAnimation( TILE_W );
 			}
 		}
 		else if( x == width - 1 && width > 1 )
 		{
 			if( y == height - 1 )
 			{
-				animation = getAnimation( "tile_ne" );
+				animation = getAnimation( TILE_NE );
 				if( animation == nullptr )
 				{
-					animation = getAnimation( "tile_e" );
+					animation = getAnimation( TILE_E );
 					if( animation == nullptr )
 					{
-						animation = getAnimation( "tile_n" );
+						animation = getAnimation( TILE_N );
 					}
 				}
 			}
 			else if( y == 0 )
 			{
-				animation = getAnimation( "tile_se" );
+				animation = getAnimation( TILE_SE );
 				if( animation == nullptr )
 				{
-					animation = getAnimation( "tile_e" );
+					animation = getAnimation( TILE_E );
 					if( animation == nullptr )
 					{
-						animation = getAnimation( "tile_s" );
+						animation = getAnimation( TILE_S );
 					}
 				}
 			}
 			else
 			{
-				animation = getAnimation( "tile_e" );
+				animation = getAnimation( TILE_E );
 			}
 		}
 		else
 		{
 			if( y == height - 1 )
 			{
-				animation = getAnimation( "tile_n" );
+				animation = getAnimation( TILE_N );
 			}
 			else if( y == 0 )
 			{
-				animation = getAnimation( "tile_s" );
+				animation = getAnimation( TILE_S );
 			}
 		}
 	}
@@ -190,43 +214,43 @@ const Animation* Tile::getTilesetAnimation( int x, int y ) const
 		// Rectangular edges
 		if( east && !north && !west && south )
 		{
-			animation = getAnimation( "tile_nw" );
+			animation = getAnimation( TILE_NW );
 		}
 		else if( east && !north && west && south )
 		{
-			animation = getAnimation( "tile_n" );
+			animation = getAnimation( TILE_N );
 		}
 		else if( !east && !north && west && south )
 		{
-			animation = getAnimation( "tile_ne" );
+			animation = getAnimation( TILE_NE );
 		}
 		else if( !east && north && west && south )
 		{
-			animation = getAnimation( "tile_e" );
+			animation = getAnimation( TILE_E );
 		}
 		else if( !east && north && west && !south )
 		{
-			animation = getAnimation( "tile_se" );
+			animation = getAnimation( TILE_SE );
 			if( animation == nullptr )
 			{
-				animation = getAnimation( "tile_e" );
+				animation = getAnimation( TILE_E );
 			}
 		}
 		else if( east && north && west && !south )
 		{
-			animation = getAnimation( "tile_s" );
+			animation = getAnimation( TILE_S );
 		}
 		else if( east && north && !west && !south )
 		{
-			animation = getAnimation( "tile_sw" );
+			animation = getAnimation( TILE_SW );
 			if( animation == nullptr )
 			{
-				animation = getAnimation( "tile_w" );
+				animation = getAnimation( TILE_W );
 			}
 		}
 		else if( east && north && !west && south )
 		{
-			animation = getAnimation( "tile_w" );
+			animation = getAnimation( TILE_W );
 		}
 		// Corners
 		else if( east && north && west && south )
@@ -243,19 +267,19 @@ const Animation* Tile::getTilesetAnimation( int x, int y ) const
 
 			if( !northWest && northEast && southEast && southWest )
 			{
-				animation = getAnimation( "tile_corner_nw" );
+				animation = getAnimation( TILE_CORNER_NW );
 			}
 			else if( northWest && !northEast && southEast && southWest )
 			{
-				animation = getAnimation( "tile_corner_ne" );
+				animation = getAnimation( TILE_CORNER_NE );
 			}
 			else if( northWest && northEast && !southEast && southWest )
 			{
-				animation = getAnimation( "tile_corner_se" );
+				animation = getAnimation( TILE_CORNER_SE );
 			}
 			else if( northWest && northEast && southEast && !southWest )
 			{
-				animation = getAnimation( "tile_corner_sw" );
+				animation = getAnimation( TILE_CORNER_SW );
 			}
 		}
 	}
@@ -263,7 +287,7 @@ const Animation* Tile::getTilesetAnimation( int x, int y ) const
 	// If none of the rules worked, just return the default tile animation
 	if( animation == nullptr )
 	{
-		animation = getAnimation( "tile" );
+		animation = getAnimation( TILE );
 	}
 
 	return animation;
@@ -314,6 +338,16 @@ void Tile::setLayer( int layer )
 	this->layer = layer * 2;
 }
 
+void Tile::setRenderCacheEnabled( bool enabled )
+{
+	renderCacheEnabled = enabled;
+}
+
+void Tile::setUpdateEnabled( bool enabled )
+{
+	updateEnabled = enabled;
+}
+
 void Tile::setWidth(int width)
 {
 	this->width = width;
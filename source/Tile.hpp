@@ -106,6 +106,23 @@ protected:
 	virtual void onCollision(Sprite& sprite, Edge edge) {}
 	virtual void onInit() {}
 
+	/**
+	 * Called once per frame while the Tile is in view, if updates are enabled.
+	 */
+	virtual void onUpdate() {}
+
+	/**
+	 * Enable/disable drawing the Tile from cached geometry. Tiles that change
+	 * how they look after they are added to the World must disable this.
+	 */
+	void setRenderCacheEnabled( bool enabled );
+
+	/**
+	 * Enable/disable calls to onUpdate() for the Tile. This must be set
+	 * before the Tile is added to the World.
+	 */
+	void setUpdateEnabled( bool enabled );
+
 private:
 	int x;
 	int y;
@@ -113,6 +130,9 @@ private:
 	int height;
 	TileCollisionBehavior collisionBehavior;
 	bool tilesetEnabled;
+	bool renderCacheEnabled; /**< Whether the Tile may be drawn from cached geometry. */
+	bool renderCached; /**< Whether the Tile is currently drawn from its chunk's cached geometry or a tile map. */
+	bool updateEnabled; /**< Whether onUpdate() is called for the Tile. */
 };
 
 #endif // TILE_HPP
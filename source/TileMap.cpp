@@ -0,0 +1,479 @@
+#include <algorithm>
+#include <cmath>
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_opengl.h>
+
+#include "Animation.hpp"
+#include "Exception.hpp"
+#include "Globals.hpp"
+#include "Texture.hpp"
+#include "TileMap.hpp"
+
+static const int CELL_TEXTURE_WIDTH = 1024; /**< The width of the cell texture. Cells are wrapped into rows, so the map can be wider than the largest texture. */
+static const int ENTRY_TABLE_WIDTH = TileMap::MAX_ANIMATION_LENGTH + 1; /**< The width of the entry table: the number of frames, then one texel per frame. */
+static const int MAX_ENTRIES = 0xffff; /**< The most entries a cell can refer to. */
+static const int MIRRORED = 0x8000; /**< Set in a coordinate of the atlas position of a frame that is mirrored along it. Atlas pages are smaller than this. */
+
+// Shader functions, which have to be loaded at run time
+static PFNGLACTIVETEXTUREPROC glActiveTexturePointer = nullptr;
+static PFNGLATTACHSHADERPROC glAttachShaderPointer = nullptr;
+static PFNGLCOMPILESHADERPROC glCompileShaderPointer = nullptr;
+static PFNGLCREATEPROGRAMPROC glCreateProgramPointer = nullptr;
+static PFNGLCREATESHADERPROC glCreateShaderPointer = nullptr;
+static PFNGLDELETEPROGRAMPROC glDeleteProgramPointer = nullptr;
+static PFNGLDELETESHADERPROC glDeleteShaderPointer = nullptr;
+static PFNGLGETPROGRAMIVPROC glGetProgramivPointer = nullptr;
+static PFNGLGETSHADERINFOLOGPROC glGetShaderInfoLogPointer = nullptr;
+static PFNGLGETSHADERIVPROC glGetShaderivPointer = nullptr;
+static PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocationPointer = nullptr;
+static PFNGLLINKPROGRAMPROC glLinkProgramPointer = nullptr;
+static PFNGLSHADERSOURCEPROC glShaderSourcePointer = nullptr;
+static PFNGLUNIFORM1FPROC glUniform1fPointer = nullptr;
+static PFNGLUNIFORM1IPROC glUniform1iPointer = nullptr;
+static PFNGLUNIFORM2FPROC glUniform2fPointer = nullptr;
+static PFNGLUSEPROGRAMPROC glUseProgramPointer = nullptr;
+
+static GLuint program = 0; /**< The tile map shader program, or 0 if it hasn't been created. */
+static GLint atlasSizeLocation = -1;
+static GLint cellTextureSizeLocation = -1;
+static GLint entryTextureSizeLocation = -1;
+static GLint mapSizeLocation = -1;
+
+/**
+ * Passes the position in cells and the color, which holds the frame number,
+ * to the fragment shader.
+ */
+static const char* VERTEX_SHADER_SOURCE =
+	"#version 110\n"
+	"varying vec2 position;\n"
+	"varying vec4 frameColor;\n"
+	"void main()\n"
+	"{\n"
+	"	gl_Position = ftransform();\n"
+	"	position = gl_MultiTexCoord0.xy;\n"
+	"	frameColor = gl_Color;\n"
+	"}\n";
+
+/**
+ * Looks up the cell under the pixel, then the frame of its animation, and
+ * samples the atlas. This must match TileMap::findAtlasPixel().
+ */
+static const char* FRAGMENT_SHADER_SOURCE =
+	"#version 110\n"
+	"uniform sampler2D atlas;\n"
+	"uniform vec2 atlasSize;\n"
+	"uniform sampler2D cells;\n"
+	"uniform vec2 cellTextureSize;\n"
+	"uniform sampler2D entries;\n"
+	"uniform vec2 entryTextureSize;\n"
+	"uniform vec2 mapSize;\n"
+	"uniform float tileSize;\n"
+	"varying vec2 position;\n"
+	"varying vec4 frameColor;\n"
+	"const float MIRRORED = 32768.0;\n"
+	"float decode( vec2 bytes )\n"
+	"{\n"
+	"	return floor(bytes.x * 255.0 + 0.5) + floor(bytes.y * 255.0 + 0.5) * 256.0;\n"
+	"}\n"
+	"void main()\n"
+	"{\n"
+	"	vec2 cell = floor(position);\n"
+	"	if( cell.x < 0.0 || cell.y < 0.0 || cell.x >= mapSize.x || cell.y >= mapSize.y )\n"
+	"	{\n"
+	"		discard;\n"
+	"	}\n"
+	"	float index = cell.y * mapSize.x + cell.x;\n"
+	"	vec2 cellTexel = vec2(mod(index, cellTextureSize.x), floor(index / cellTextureSize.x));\n"
+	"	float entry = decode(texture2D(cells, (cellTexel + 0.5) / cellTextureSize).rg);\n"
+	"	if( entry == 0.0 )\n"
+	"	{\n"
+	"		discard;\n"
+	"	}\n"
+	"	float row = (entry - 0.5) / entryTextureSize.y;\n"
+	"	float frameCount = decode(texture2D(entries, vec2(0.5 / entryTextureSize.x, row)).rg);\n"
+	"	float frameNumber = decode(frameColor.rg) + floor(frameColor.b * 255.0 + 0.5) * 65536.0;\n"
+	"	float frame = mod(frameNumber, frameCount);\n"
+	"	if( frame >= frameCount - 0.5 )\n"
+	"	{\n"
+	"		frame -= frameCount;\n"
+	"	}\n"
+	"	if( frame < -0.5 )\n"
+	"	{\n"
+	"		frame += frameCount;\n"
+	"	}\n"
+	"	vec4 origin = texture2D(entries, vec2((floor(frame + 0.5) + 1.5) / entryTextureSize.x, row));\n"
+	"	vec2 originTexel = vec2(decode(origin.rg), decode(origin.ba));\n"
+	"	vec2 mirrored = step(MIRRORED, originTexel);\n"
+	"	originTexel -= mirrored * MIRRORED;\n"
+	"	vec2 pixel = floor(fract(position) * tileSize);\n"
+	"	pixel = mix(pixel, tileSize - 1.0 - pixel, mirrored);\n"
+	"	vec2 texel = vec2(originTexel.x + pixel.x, originTexel.y + tileSize - 1.0 - pixel.y);\n"
+	"	gl_FragColor = texture2D(atlas, (texel + 0.5) / atlasSize);\n"
+	"}\n";
+
+/**
+ * Compile a shader, logging any errors.
+ *
+ * @return the shader, or 0 if it failed to compile.
+ */
+static GLuint compileShader( GLenum type, const char* source )
+{
+	GLuint shader = glCreateShaderPointer(type);
+	glShaderSourcePointer(shader, 1, &source, nullptr);
+	glCompileShaderPointer(shader);
+
+	GLint compiled = GL_FALSE;
+	glGetShaderivPointer(shader, GL_COMPILE_STATUS, &compiled);
+	if( compiled != GL_TRUE )
+	{
+		char log[1024];
+		glGetShaderInfoLogPointer(shader, sizeof(log), nullptr, log);
+		LOG << "Failed to compile the tile map shader:\n" << log << "\n";
+		glDeleteShaderPointer(shader);
+		return 0;
+	}
+
+	return shader;
+}
+
+/**
+ * Create a texture for data that is looked up by the shader.
+ */
+static GLuint createDataTexture( int width, int height, const Color* texels )
+{
+	GLuint texture = 0;
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, &texels[0].r);
+	return texture;
+}
+
+TileMap::TileMap( const Texture* atlas, int width, int height ) :
+	atlas(atlas),
+	atlasHeight(atlas->getHeight()),
+	atlasWidth(atlas->getWidth()),
+	cellsDirtyBottom(0),
+	cellsDirtyTop(0),
+	cellTexture(0),
+	cellTextureRows(0),
+	entryTableDirty(false),
+	entryTexture(0),
+	height(0),
+	width(0)
+{
+	resize(width, height);
+}
+
+TileMap::~TileMap()
+{
+	if( cellTexture != 0 )
+	{
+		glDeleteTextures(1, &cellTexture);
+	}
+	if( entryTexture != 0 )
+	{
+		glDeleteTextures(1, &entryTexture);
+	}
+}
+
+bool TileMap::bind() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	if( program == 0 || entries.empty() || cells.empty() )
+	{
+		return false;
+	}
+
+	// Upload the cells that changed, or all of them if the map was resized
+	int cellRows = cells.size() / CELL_TEXTURE_WIDTH;
+	if( cellTextureRows != cellRows )
+	{
+		if( cellTexture != 0 )
+		{
+			glDeleteTextures(1, &cellTexture);
+		}
+		cellTexture = createDataTexture(CELL_TEXTURE_WIDTH, cellRows, &cells[0]);
+		cellTextureRows = cellRows;
+	}
+	else if( cellsDirtyBottom < cellsDirtyTop )
+	{
+		glBindTexture(GL_TEXTURE_2D, cellTexture);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, cellsDirtyBottom, CELL_TEXTURE_WIDTH, cellsDirtyTop - cellsDirtyBottom, GL_RGBA, GL_UNSIGNED_BYTE, &cells[cellsDirtyBottom * CELL_TEXTURE_WIDTH].r);
+	}
+	cellsDirtyBottom = cellRows;
+	cellsDirtyTop = 0;
+
+	// The table only grows when an animation is first used, so it is uploaded whole
+	if( entryTableDirty )
+	{
+		if( entryTexture != 0 )
+		{
+			glDeleteTextures(1, &entryTexture);
+		}
+		entryTexture = createDataTexture(ENTRY_TABLE_WIDTH, entries.size(), &entryTable[0]);
+		entryTableDirty = false;
+	}
+
+	glUseProgramPointer(program);
+	glUniform2fPointer(atlasSizeLocation, atlasWidth, atlasHeight);
+	glUniform2fPointer(cellTextureSizeLocation, CELL_TEXTURE_WIDTH, cellRows);
+	glUniform2fPointer(entryTextureSizeLocation, ENTRY_TABLE_WIDTH, entries.size());
+	glUniform2fPointer(mapSizeLocation, width, height);
+
+	glActiveTexturePointer(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, cellTexture);
+	glActiveTexturePointer(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_2D, entryTexture);
+	glActiveTexturePointer(GL_TEXTURE0);
+	atlas->bind();
+	return true;
+}
+
+bool TileMap::canDrawAnimation( const Animation* animation )
+{
+	if( animation->getLength() < 1 || animation->getLength() > MAX_ANIMATION_LENGTH )
+	{
+		return false;
+	}
+
+	for( int i = 0; i < animation->getLength(); ++i )
+	{
+		const Animation::Frame& frame = animation->getFrameBySequence(i);
+		if( frame.width != 1.0 || frame.height != 1.0 || frame.xOffset != 0.0 || frame.yOffset != 0.0 ||
+			frame.page != animation->getFrameBySequence(0).page )
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TileMap::createShader()
+{
+	glActiveTexturePointer = (PFNGLACTIVETEXTUREPROC)SDL_GL_GetProcAddress("glActiveTexture");
+	glAttachShaderPointer = (PFNGLATTACHSHADERPROC)SDL_GL_GetProcAddress("glAttachShader");
+	glCompileShaderPointer = (PFNGLCOMPILESHADERPROC)SDL_GL_GetProcAddress("glCompileShader");
+	glCreateProgramPointer = (PFNGLCREATEPROGRAMPROC)SDL_GL_GetProcAddress("glCreateProgram");
+	glCreateShaderPointer = (PFNGLCREATESHADERPROC)SDL_GL_GetProcAddress("glCreateShader");
+	glDeleteProgramPointer = (PFNGLDELETEPROGRAMPROC)SDL_GL_GetProcAddress("glDeleteProgram");
+	glDeleteShaderPointer = (PFNGLDELETESHADERPROC)SDL_GL_GetProcAddress("glDeleteShader");
+	glGetProgramivPointer = (PFNGLGETPROGRAMIVPROC)SDL_GL_GetProcAddress("glGetProgramiv");
+	glGetShaderInfoLogPointer = (PFNGLGETSHADERINFOLOGPROC)SDL_GL_GetProcAddress("glGetShaderInfoLog");
+	glGetShaderivPointer = (PFNGLGETSHADERIVPROC)SDL_GL_GetProcAddress("glGetShaderiv");
+	glGetUniformLocationPointer = (PFNGLGETUNIFORMLOCATIONPROC)SDL_GL_GetProcAddress("glGetUniformLocation");
+	glLinkProgramPointer = (PFNGLLINKPROGRAMPROC)SDL_GL_GetProcAddress("glLinkProgram");
+	glShaderSourcePointer = (PFNGLSHADERSOURCEPROC)SDL_GL_GetProcAddress("glShaderSource");
+	glUniform1fPointer = (PFNGLUNIFORM1FPROC)SDL_GL_GetProcAddress("glUniform1f");
+	glUniform1iPointer = (PFNGLUNIFORM1IPROC)SDL_GL_GetProcAddress("glUniform1i");
+	glUniform2fPointer = (PFNGLUNIFORM2FPROC)SDL_GL_GetProcAddress("glUniform2f");
+	glUseProgramPointer = (PFNGLUSEPROGRAMPROC)SDL_GL_GetProcAddress("glUseProgram");
+	if( glActiveTexturePointer == nullptr || glAttachShaderPointer == nullptr || glCompileShaderPointer == nullptr ||
+		glCreateProgramPointer == nullptr || glCreateShaderPointer == nullptr || glDeleteProgramPointer == nullptr ||
+		glDeleteShaderPointer == nullptr || glGetProgramivPointer == nullptr || glGetShaderInfoLogPointer == nullptr ||
+		glGetShaderivPointer == nullptr || glGetUniformLocationPointer == nullptr || glLinkProgramPointer == nullptr ||
+		glShaderSourcePointer == nullptr || glUniform1fPointer == nullptr || glUniform1iPointer == nullptr ||
+		glUniform2fPointer == nullptr || glUseProgramPointer == nullptr )
+	{
+		return false;
+	}
+
+	GLuint vertexShader = compileShader(GL_VERTEX_SHADER, VERTEX_SHADER_SOURCE);
+	GLuint fragmentShader = compileShader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER_SOURCE);
+	if( vertexShader != 0 && fragmentShader != 0 )
+	{
+		program = glCreateProgramPointer();
+		glAttachShaderPointer(program, vertexShader);
+		glAttachShaderPointer(program, fragmentShader);
+		glLinkProgramPointer(program);
+
+		GLint linked = GL_FALSE;
+		glGetProgramivPointer(program, GL_LINK_STATUS, &linked);
+		if( linked != GL_TRUE )
+		{
+			LOG << "Failed to link the tile map shader.\n";
+			glDeleteProgramPointer(program);
+			program = 0;
+		}
+	}
+
+	// The program keeps the shaders until it is deleted
+	if( vertexShader != 0 )
+	{
+		glDeleteShaderPointer(vertexShader);
+	}
+	if( fragmentShader != 0 )
+	{
+		glDeleteShaderPointer(fragmentShader);
+	}
+	if( program == 0 )
+	{
+		return false;
+	}
+
+	atlasSizeLocation = glGetUniformLocationPointer(program, "atlasSize");
+	cellTextureSizeLocation = glGetUniformLocationPointer(program, "cellTextureSize");
+	entryTextureSizeLocation = glGetUniformLocationPointer(program, "entryTextureSize");
+	mapSizeLocation = glGetUniformLocationPointer(program, "mapSize");
+
+	// The textures are always on the same units, and tiles are always a unit in size
+	glUseProgramPointer(program);
+	glUniform1iPointer(glGetUniformLocationPointer(program, "atlas"), 0);
+	glUniform1iPointer(glGetUniformLocationPointer(program, "cells"), 1);
+	glUniform1iPointer(glGetUniformLocationPointer(program, "entries"), 2);
+	glUniform1fPointer(glGetUniformLocationPointer(program, "tileSize"), UNIT_SIZE);
+	glUseProgramPointer(0);
+	return true;
+}
+
+int TileMap::decodeFrameNumber( const Color& color )
+{
+	return color.r | (color.g << 8) | (color.b << 16);
+}
+
+Color TileMap::encodeFrameNumber( int frameNumber )
+{
+	return Color(frameNumber & 0xff, (frameNumber >> 8) & 0xff, (frameNumber >> 16) & 0xff, 0xff);
+}
+
+bool TileMap::findAtlasPixel( double x, double y, int frameNumber, int& atlasX, int& atlasY ) const
+{
+	int cellX = static_cast<int>(std::floor(x));
+	int cellY = static_cast<int>(std::floor(y));
+	if( cellX < 0 || cellY < 0 || cellX >= width || cellY >= height )
+	{
+		return false;
+	}
+
+	const Color& cell = cells[cellY * width + cellX];
+	int entry = cell.r | (cell.g << 8);
+	if( entry == 0 )
+	{
+		return false;
+	}
+
+	const Color* row = &entryTable[(entry - 1) * ENTRY_TABLE_WIDTH];
+	int frameCount = row[0].r | (row[0].g << 8);
+	const Color& origin = row[1 + frameNumber % frameCount];
+	int originX = origin.r | (origin.g << 8);
+	int originY = origin.b | (origin.a << 8);
+	int pixelX = static_cast<int>(std::floor((x - cellX) * UNIT_SIZE));
+	int pixelY = static_cast<int>(std::floor((y - cellY) * UNIT_SIZE));
+	if( originX & MIRRORED )
+	{
+		originX &= ~MIRRORED;
+		pixelX = UNIT_SIZE - 1 - pixelX;
+	}
+	if( originY & MIRRORED )
+	{
+		originY &= ~MIRRORED;
+		pixelY = UNIT_SIZE - 1 - pixelY;
+	}
+	atlasX = originX + pixelX;
+	atlasY = originY + UNIT_SIZE - 1 - pixelY;
+	return true;
+}
+
+void TileMap::freeShader()
+{
+	if( program != 0 )
+	{
+		glDeleteProgramPointer(program);
+		program = 0;
+	}
+}
+
+const Texture* TileMap::getAtlas() const
+{
+	return atlas;
+}
+
+bool TileMap::isSupported()
+{
+	if( SETTINGS.headless )
+	{
+		return SETTINGS.tileMaps;
+	}
+
+	return program != 0;
+}
+
+void TileMap::resize( int width, int height )
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	this->width = width;
+	this->height = height;
+
+	int rows = (width * height + CELL_TEXTURE_WIDTH - 1) / CELL_TEXTURE_WIDTH;
+	cells.assign(rows * CELL_TEXTURE_WIDTH, Color(0, 0, 0, 0));
+	cellsDirtyBottom = 0;
+	cellsDirtyTop = rows;
+}
+
+void TileMap::setCell( int x, int y, const Animation* animation )
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	int entry = 0;
+	if( animation != nullptr )
+	{
+		auto it = entries.find(animation);
+		if( it != entries.end() )
+		{
+			entry = it->second;
+		}
+		else
+		{
+			if( (int)entries.size() == MAX_ENTRIES )
+			{
+				throw Exception("Too many animations in a tile map.");
+			}
+
+			// Add a row to the table with the frame count, and the position of each frame
+			entry = entries.size() + 1;
+			entries[animation] = entry;
+			entryTable.resize(entries.size() * ENTRY_TABLE_WIDTH, Color(0, 0, 0, 0));
+			Color* row = &entryTable[(entry - 1) * ENTRY_TABLE_WIDTH];
+			int frameCount = animation->getLength();
+			row[0] = Color(frameCount & 0xff, frameCount >> 8, 0, 0);
+			for( int i = 0; i < frameCount; ++i )
+			{
+				const Animation::Frame& frame = animation->getFrameBySequence(i);
+				int frameX = static_cast<int>(std::floor(std::min(frame.left, frame.right) * atlasWidth + 0.5));
+				int frameY = static_cast<int>(std::floor(std::min(frame.top, frame.bottom) * atlasHeight + 0.5));
+				if( frame.left > frame.right )
+				{
+					frameX |= MIRRORED;
+				}
+				if( frame.top > frame.bottom )
+				{
+					frameY |= MIRRORED;
+				}
+				row[1 + i] = Color(frameX & 0xff, frameX >> 8, frameY & 0xff, frameY >> 8);
+			}
+			entryTableDirty = true;
+		}
+	}
+
+	int index = y * width + x;
+	Color value(entry & 0xff, entry >> 8, 0, 0);
+	Color& cell = cells[index];
+	if( cell.r == value.r && cell.g == value.g )
+	{
+		return;
+	}
+	cell = value;
+
+	int row = index / CELL_TEXTURE_WIDTH;
+	cellsDirtyBottom = std::min(cellsDirtyBottom, row);
+	cellsDirtyTop = std::max(cellsDirtyTop, row + 1);
+}
+
+void TileMap::unbind()
+{
+	glUseProgramPointer(0);
+}
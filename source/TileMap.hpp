@@ -0,0 +1,143 @@
+#ifndef TILEMAP_HPP
+#define TILEMAP_HPP
+
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "Color.hpp"
+
+class Animation;
+class Texture;
+
+/**
+ * A layer of tiles that is drawn as a single quad, whatever the number of
+ * tiles in it. Each cell of the map holds an entry in a small table of
+ * animations, and both are kept in textures. A fragment shader looks up the
+ * cell under each pixel, picks the frame of its animation for the current
+ * frame number, and samples the texture atlas there.
+ *
+ * Only animations whose frames are a whole unit, with no offset, and all on
+ * the same page of the texture atlas can be drawn by a tile map. Everything
+ * else is still drawn as quads. A tile map draws from a single page, so a
+ * layer has a tile map for each page that its tiles are on.
+ *
+ * The cells can be changed on one thread while the map is drawn on another.
+ * The changes are uploaded the next time the map is drawn, so a frame that
+ * is presented late shows the latest cells.
+ */
+class TileMap
+{
+public:
+	static const int MAX_ANIMATION_LENGTH = 255; /**< The most frames an animation can have and still be drawn by a tile map. */
+
+	/**
+	 * Create an empty tile map.
+	 *
+	 * @param atlas the page of the texture atlas that every frame is on.
+	 * @param width the width of the map, in cells.
+	 * @param height the height of the map, in cells.
+	 */
+	TileMap( const Texture* atlas, int width, int height );
+
+	~TileMap();
+
+	/**
+	 * Bind the shader and the textures of the tile map for drawing, after
+	 * uploading any cells that changed. Only for OpenGL.
+	 *
+	 * @return false if nothing should be drawn.
+	 */
+	bool bind() const;
+
+	/**
+	 * Check if an animation can be drawn by a tile map.
+	 */
+	static bool canDrawAnimation( const Animation* animation );
+
+	/**
+	 * Compile the tile map shader. This needs an OpenGL context.
+	 *
+	 * @return false if shaders aren't supported, in which case tile maps
+	 * can't be drawn with OpenGL.
+	 */
+	static bool createShader();
+
+	/**
+	 * Get the frame number stored in the color of a tile map vertex.
+	 */
+	static int decodeFrameNumber( const Color& color );
+
+	/**
+	 * Get the color that stores a frame number in a tile map vertex. The
+	 * frame number wraps around after 2^24 frames.
+	 */
+	static Color encodeFrameNumber( int frameNumber );
+
+	/**
+	 * Find the pixel of the texture atlas that is shown at a point of the
+	 * map, the same way the shader does. This doesn't lock the cells, so it
+	 * must be called on the thread that changes them.
+	 *
+	 * @param x the x coordinate of the point, in cells.
+	 * @param y the y coordinate of the point, in cells.
+	 * @param frameNumber the frame number the animations are shown at.
+	 * @param atlasX set to the x coordinate of the pixel, from the left.
+	 * @param atlasY set to the y coordinate of the pixel, from the top.
+	 * @return false if nothing is drawn at the point.
+	 */
+	bool findAtlasPixel( double x, double y, int frameNumber, int& atlasX, int& atlasY ) const;
+
+	/**
+	 * Free the tile map shader.
+	 */
+	static void freeShader();
+
+	/**
+	 * Get the page of the texture atlas that the frames are on.
+	 */
+	const Texture* getAtlas() const;
+
+	/**
+	 * Check if tile maps can be drawn. They are always drawn by the software
+	 * renderer in headless mode, and need a shader otherwise.
+	 */
+	static bool isSupported();
+
+	/**
+	 * Change the size of the map. This empties every cell.
+	 */
+	void resize( int width, int height );
+
+	/**
+	 * Set the animation shown in a cell.
+	 *
+	 * @param animation the animation, which must be drawable by a tile map,
+	 * or nullptr to empty the cell.
+	 */
+	void setCell( int x, int y, const Animation* animation );
+
+	/**
+	 * Go back to drawing without the shader after bind().
+	 */
+	static void unbind();
+
+private:
+	const Texture* atlas;
+	int atlasHeight;
+	int atlasWidth;
+	std::vector<Color> cells; /**< The entry of each cell plus one, or 0 for empty cells, wrapped into rows of the cell texture. */
+	mutable int cellsDirtyBottom; /**< The first row of the cell texture that changed. */
+	mutable int cellsDirtyTop; /**< One past the last row of the cell texture that changed. */
+	mutable unsigned int cellTexture;
+	mutable int cellTextureRows; /**< The number of rows the cell texture was created with. */
+	std::map<const Animation*, int> entries; /**< The entry of each animation in the table. */
+	std::vector<Color> entryTable; /**< A row for each entry, with the number of frames and then the atlas position of each frame, marked if the frame is mirrored. */
+	mutable bool entryTableDirty;
+	mutable unsigned int entryTexture;
+	int height;
+	mutable std::mutex mutex;
+	int width;
+};
+
+#endif // TILEMAP_HPP
@@ -53,16 +53,14 @@ void TransitionState::update()
 	// Rendering
 	renderClearScreen();
 	renderSetUnitsToPixels();
-	RESOURCE_MANAGER.bindTextureAtlas();
 	const Animation* text = GET_ANIMATION("mario_start_text");
 	Animation::Frame f = text->getFrame(progress);
-	glTranslatef(
+	SPRITE_BATCH.translate(
 		SETTINGS.getRenderedScreenWidth() / 2.0 - f.width / 2.0 * UNIT_SIZE,
-		SETTINGS.getRenderedScreenHeight() - SETTINGS.getRenderedScreenHeight() / 2.0 * clamp(progress / 30.0, 0.0, 1.0) - (f.height / 2.0 * UNIT_SIZE),
-		0.0f
+		SETTINGS.getRenderedScreenHeight() - SETTINGS.getRenderedScreenHeight() / 2.0 * clamp(progress / 30.0, 0.0, 1.0) - (f.height / 2.0 * UNIT_SIZE)
 	);
 	text->renderFrame(f);
-	SDL_GL_SwapWindow((SDL_Window*)window);
+	renderSwapBuffers();
 
 	// Check if we are done
 	if( ++progress > 60 )
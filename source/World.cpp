@@ -2,8 +2,8 @@
 #include <cassert>
 #include <cmath>
 #include <cstdio>
+#include <thread>
 
-#include <GL/gl.h>
 #include <SDL2/SDL.h>
 
 #include "Background.hpp"
@@ -17,14 +17,49 @@
 #include "Particle.hpp"
 #include "Player.hpp"
 #include "Random.hpp"
+#include "RenderSnapshot.hpp"
 #include "Rendering.hpp"
 #include "Sprite.hpp"
 #include "Text.hpp"
 #include "Texture.hpp"
+#include "ThreadPool.hpp"
 #include "Tile.hpp"
+#include "TileMap.hpp"
 #include "World.hpp"
 
 static const double BOUNDARY_SIZE = 10.0; /**< The boundary size surrounding the world that kills sprites when they go out of bounds. */
+static const double ACTIVE_DISTANCE = 4.0; /**< The distance outside of the view within which sprites are updated every frame. */
+static const double DORMANT_DISTANCE = 16.0; /**< The distance outside of the view beyond which sprites are not updated. */
+static const int REDUCED_UPDATE_INTERVAL = 2; /**< The number of frames between updates for sprites that are updated at a reduced rate. */
+static const unsigned char CELL_SLOPE = 1 << 4; /**< Cell edge mask flag for cells that contain a slope tile. */
+static const int SPRITE_MOTION_BATCH_SIZE = 64; /**< The number of sprites integrated by each parallel task. */
+static const int SPRITE_REACH = 4; /**< The number of cells past its own that a sprite can touch other sprites in during a frame. */
+static const int TILE_CANDIDATE_MARGIN = 2; /**< The number of cells around a sprite that tile candidates are gathered from. */
+static const int TILE_CHUNK_SIZE = 16; /**< The width and height of a tile chunk, in cells. */
+
+static thread_local bool resolvingCollisions = false; /**< Whether the thread is testing a sprite for collisions. */
+
+/**
+ * Get the last cell coordinate that is strictly less than a coordinate.
+ */
+static int getLastCellBefore( double coordinate )
+{
+	return static_cast<int>(std::ceil(coordinate)) - 1;
+}
+
+/**
+ * Add the bytes of a value to an FNV-1a hash.
+ */
+template <typename T>
+static void hashValue( unsigned int& hash, const T& value )
+{
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+	for( std::size_t i = 0; i < sizeof(T); ++i )
+	{
+		hash ^= bytes[i];
+		hash *= 16777619u;
+	}
+}
 
 /**
  * Check if two boxes intersect.
@@ -54,7 +89,8 @@ static bool intersects( const Vector2<double>& p1,
 World::Cell::Cell() :
 	tile(nullptr),
 	spawn(nullptr),
-	underwater(false)
+	underwater(false),
+	edges(0)
 {
 }
 
@@ -63,29 +99,95 @@ World::Cell::~Cell()
 	delete spawn;
 }
 
+World::TileChunk::TileChunk() :
+	bottom(0),
+	dirty(true),
+	left(0),
+	right(-1),
+	top(-1)
+{
+}
+
 World::World() :
+	activityViewWidth(0.0),
+	activityViewX(0.0),
+	activityViewSet(false),
 	background(nullptr),
+	collisionAllocations(0),
 	delta(GAME_DELTA),
 	frameNumber(0),
-	player(nullptr)
+	player(nullptr),
+	removedSprites(0),
+	removedSweepSprites(0),
+	renderCount(0),
+	spriteBroadphase(BROADPHASE_SWEEP),
+	spritePairTests(0),
+	sweepMaxWidth(0),
+	threadPool(nullptr),
+	tileChunkColumns(0),
+	tileChunkRows(0),
+	tileVersion(0)
 {
 	random = new Random;
 	random->seedTime();
+
+	int threadCount = SETTINGS.updateThreads;
+	if( threadCount <= 0 )
+	{
+		threadCount = std::thread::hardware_concurrency();
+	}
+	if( threadCount > 1 )
+	{
+		threadPool = new ThreadPool(threadCount);
+	}
 }
 
 World::~World()
 {
 	unloadLevel();
 
+	for( auto& tileMap : tileMaps )
+	{
+		delete tileMap.second;
+	}
+
 	delete random;
+	delete threadPool;
+}
+
+void World::addCollision( Sprite* sprite )
+{
+	if( std::find(collisionSprites.begin(), collisionSprites.end(), sprite) == collisionSprites.end() )
+	{
+		if( collisionSprites.size() == collisionSprites.capacity() )
+		{
+			collisionAllocations++;
+		}
+		collisionSprites.push_back(sprite);
+	}
+}
+
+void World::addCollision( Tile* tile )
+{
+	if( std::find(collisionTiles.begin(), collisionTiles.end(), tile) == collisionTiles.end() )
+	{
+		if( collisionTiles.size() == collisionTiles.capacity() )
+		{
+			collisionAllocations++;
+		}
+		collisionTiles.push_back(tile);
+	}
 }
 
 void World::addSprite(Sprite* sprite)
 {
 	sprite->world = this;
 	sprite->firstFrame = frameNumber;
+	sprite->worldIndex = sprites.size();
 	sprites.push_back(sprite);
 	insertSprite(sprite);
+	insertSweepSprite(sprite);
+	insertRoamingSprite(sprite);
 }
 
 void World::addSprite(double x, double y, Sprite* sprite)
@@ -95,6 +197,278 @@ void World::addSprite(double x, double y, Sprite* sprite)
 	addSprite(sprite);
 }
 
+bool World::collideSprite( Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled, const SpriteMotion* motion )
+{
+	// Now, do collision testing
+	if( !sprite->held && (spriteCollisionsEnabled || tileCollisionsEnabled) )
+	{
+		resolvingCollisions = true;
+
+		// Do x axis testing
+		bool stopX = doSpriteCollisionXAxisTest(sprite, oldPosition, tileCollisionsEnabled, spriteCollisionsEnabled, motion);
+
+		// Do y axis testing
+		bool stopY = doSpriteCollisionYAxisTest(sprite, oldPosition, tileCollisionsEnabled, spriteCollisionsEnabled, motion);
+
+		resolvingCollisions = false;
+
+		// Stop if we need to
+		if( stopX )
+		{
+			sprite->velocity.x = 0;
+		}
+		if( stopY )
+		{
+			sprite->velocity.y = 0;
+		}
+	}
+
+	// Check if the sprite is out of bounds
+	if( sprite->deathBoundaryEnabled &&
+		(sprite->position.x < -1 * BOUNDARY_SIZE || sprite->position.x > width + BOUNDARY_SIZE ||
+		sprite->position.y < -1 * BOUNDARY_SIZE || sprite->position.y > height + BOUNDARY_SIZE) )
+	{
+		// Kill it
+		sprite->kill();
+		return false;
+	}
+	// Invisible side boundaries for the player
+	else if( dynamic_cast<Player*>(sprite) != nullptr )
+	{
+		if( sprite->getLeft() < 0 )
+		{
+			sprite->position.x = 0;
+			sprite->velocity.x = 0;
+		}
+		else if( sprite->getRight() > width )
+		{
+			sprite->position.x = width - sprite->size.x;
+			sprite->velocity.x = 0;
+		}
+	}
+
+	return true;
+}
+
+void World::compactSprites()
+{
+	if( removedSprites == 0 )
+	{
+		return;
+	}
+
+	std::size_t count = 0;
+	for( auto sprite : sprites )
+	{
+		if( sprite != nullptr )
+		{
+			sprite->worldIndex = count;
+			sprites[count++] = sprite;
+		}
+	}
+	sprites.resize(count);
+	removedSprites = 0;
+}
+
+void World::compactSweepSprites()
+{
+	if( removedSweepSprites == 0 )
+	{
+		return;
+	}
+
+	std::size_t count = 0;
+	for( auto sprite : sweepSprites )
+	{
+		if( sprite != nullptr )
+		{
+			sprite->sweepIndex = count;
+			sweepSprites[count++] = sprite;
+		}
+	}
+	sweepSprites.resize(count);
+	removedSweepSprites = 0;
+}
+
+void World::buildTileChunk( int chunkX, int chunkY )
+{
+	TileChunk& chunk = tileChunks[chunkY * tileChunkColumns + chunkX];
+	for( auto& layer : chunk.layers )
+	{
+		layer.second.clear();
+	}
+	chunk.left = width;
+	chunk.bottom = height;
+	chunk.right = -1;
+	chunk.top = -1;
+
+	// Store the cells that the tile map shader can draw in the tile map of their layer
+	bool tileMapsEnabled = TileMap::isSupported();
+	std::map<Tile*, bool> mappableTiles;
+	if( tileMapsEnabled )
+	{
+		for( int x = chunkX * TILE_CHUNK_SIZE; x < std::min((chunkX + 1) * TILE_CHUNK_SIZE, width); ++x )
+		{
+			for( int y = chunkY * TILE_CHUNK_SIZE; y < std::min((chunkY + 1) * TILE_CHUNK_SIZE, height); ++y )
+			{
+				Tile* tile = getCell(x, y)->tile;
+				const Animation* animation = nullptr;
+				if( tile != nullptr )
+				{
+					auto mappable = mappableTiles.find(tile);
+					if( mappable == mappableTiles.end() )
+					{
+						mappable = mappableTiles.insert(std::make_pair(tile, isTileMappable(tile))).first;
+					}
+					if( mappable->second )
+					{
+						animation = tile->tilesetEnabled ? tile->getTilesetAnimation(x - tile->x, y - tile->y) : tile->activeAnimation;
+					}
+				}
+
+				// Each tile map draws from one page of the atlas
+				std::pair<int, int> key;
+				if( animation != nullptr )
+				{
+					key = std::make_pair(tile->layer, animation->getFrameBySequence(0).page);
+				}
+				for( auto& tileMap : tileMaps )
+				{
+					tileMap.second->setCell(x, y, animation != nullptr && tileMap.first == key ? animation : nullptr);
+				}
+				if( animation != nullptr && tileMaps.find(key) == tileMaps.end() )
+				{
+					TileMap* tileMap = new TileMap(RESOURCE_MANAGER.getTextureAtlas(key.second), width, height);
+					tileMap->setCell(x, y, animation);
+					tileMaps[key] = tileMap;
+				}
+			}
+		}
+	}
+
+	// Record each other cacheable tile once, from the chunk that holds its bottom left cell
+	SpriteBatch& batch = SPRITE_BATCH;
+	batch.pushTransform();
+	batch.loadIdentity();
+	for( int x = chunkX * TILE_CHUNK_SIZE; x < std::min((chunkX + 1) * TILE_CHUNK_SIZE, width); ++x )
+	{
+		for( int y = chunkY * TILE_CHUNK_SIZE; y < std::min((chunkY + 1) * TILE_CHUNK_SIZE, height); ++y )
+		{
+			Tile* tile = getCell(x, y)->tile;
+			if( tile == nullptr || std::max(tile->x, 0) != x || std::max(tile->y, 0) != y )
+			{
+				continue;
+			}
+
+			bool mapped = tileMapsEnabled && mappableTiles[tile];
+			tile->renderCached = mapped || isTileCacheable(tile);
+			if( !tile->renderCached )
+			{
+				continue;
+			}
+
+			tileChunkLayers.insert(tile->layer);
+			if( mapped )
+			{
+				continue;
+			}
+
+			batch.beginMesh(chunk.layers[tile->layer]);
+			batch.pushTransform();
+			batch.translate(tile->x, tile->y, tile->layer);
+			renderFrame( tile, tile->activeAnimation, tile->getActiveAnimationFrame(frameNumber), false );
+			if( tile->tilesetEnabled )
+			{
+				renderTileset(tile);
+			}
+			batch.popTransform();
+			batch.endMesh();
+
+			chunk.left = std::min(chunk.left, tile->x);
+			chunk.bottom = std::min(chunk.bottom, tile->y);
+			chunk.right = std::max(chunk.right, tile->x + tile->width - 1);
+			chunk.top = std::max(chunk.top, tile->y + tile->height - 1);
+		}
+	}
+	batch.popTransform();
+
+	chunk.dirty = false;
+}
+
+bool World::computeCellEdgeState( int x, int y, Edge edge ) const
+{
+	int dx = 0;
+	int dy = 0;
+	Edge otherEdge = getOppositeEdge(edge);
+	switch( edge )
+	{
+		case EDGE_BOTTOM:
+			dy--;
+			break;
+
+		case EDGE_LEFT:
+			dx--;
+			break;
+
+		case EDGE_RIGHT:
+			dx++;
+			break;
+
+		case EDGE_TOP:
+			dy++;
+			break;
+	}
+
+	bool edge1 = false;
+	bool edge2 = false;
+
+	const Cell* cell = getCell(x, y);
+	const Cell* cell2 = getCell(x + dx, y + dy);
+	Tile* tile = nullptr;
+	Tile* tile2 = nullptr;
+	if( cell != nullptr )
+	{
+		tile = cell->tile;
+	}
+	if( cell2 != nullptr )
+	{
+		tile2 = cell2->tile;
+	}
+
+	bool slope = false; // Slopes are a special case
+	bool tileIsSlope = false;
+	if( tile != tile2 ) // Edges within the same tile are never solid
+	{
+		if( tile != nullptr )
+		{
+			edge1 = tile->getEdgeState(edge);
+			if( tile->collisionBehavior == TILE_SLOPE_DOWN || tile->collisionBehavior == TILE_SLOPE_UP )
+			{
+				if( edge1 )
+				{
+					slope = true;
+				}
+				tileIsSlope = true;
+			}
+		}
+		if( tile2 != nullptr )
+		{
+			edge2 = tile2->getEdgeState(otherEdge);
+			if( tile2->collisionBehavior == TILE_SLOPE_DOWN || tile2->collisionBehavior == TILE_SLOPE_UP )
+			{
+				if( edge2 )
+				{
+					slope = true;
+				}
+			}
+		}
+	}
+
+	return (edge1 != edge2 &&
+		!slope &&
+		!(tileIsSlope && edge == EDGE_BOTTOM) ); // Exemption for top edge below slopes
+}
+
 void World::destroyDeadTiles()
 {
 	for( auto t : deadTiles )
@@ -116,7 +490,7 @@ void World::destroyTile( Tile* tile )
 	deadTiles.insert(tile);
 }
 
-bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled)
+bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled, const SpriteMotion* motion)
 {
 	Vector2<double>& velocity = sprite->velocity;
 	Vector2<double>& position = sprite->position;
@@ -124,13 +498,55 @@ bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& ol
 	bool stop = false;
 
 	// Lists of tiles and sprites that the sprite collides with
-	std::set<Tile*> collisionTiles;
-	std::set<Sprite*> collisionSprites;
-
-	// Do regular axis checking
-	for( double y = std::floor(oldPosition.y); y < oldPosition.y + size.y - std::fabs(oldPosition.y) * DOUBLE_EPSILON; ++y )
+	collisionTiles.clear();
+	collisionSprites.clear();
+
+	// Do regular axis checking. The tiles gathered at the start of the
+	// update can be used instead of the grid if they are still current and
+	// cover every cell the loop below could visit, which is between the old
+	// and new positions, give or take a cell.
+	int bottom = static_cast<int>(std::floor(oldPosition.y));
+	int top = getLastCellBefore(oldPosition.y + size.y - std::fabs(oldPosition.y) * DOUBLE_EPSILON);
+	bool useTileCandidates = tileCollisionsEnabled && motion != nullptr && motion->tileVersion == tileVersion &&
+		!(spriteCollisionsEnabled && spriteBroadphase == BROADPHASE_GRID) &&
+		bottom >= motion->tileCellsMin.y && top <= motion->tileCellsMax.y &&
+		static_cast<int>(std::floor(std::min(position.x, oldPosition.x))) - 1 >= motion->tileCellsMin.x &&
+		getLastCellBefore(std::max(position.x, oldPosition.x) + size.x) + 1 <= motion->tileCellsMax.x;
+	if( useTileCandidates )
+	{
+		// Visit the candidates in the same order as the cells, skipping the
+		// ones the loop would not reach
+		int row = bottom - 1;
+		int rowLeft = 0;
+		bool rowEnded = false;
+		for( auto& candidate : motion->tileCandidates )
+		{
+			if( candidate.y < bottom || candidate.y > top )
+			{
+				continue;
+			}
+			if( candidate.y != row )
+			{
+				row = candidate.y;
+				rowLeft = static_cast<int>(std::floor(position.x));
+				rowEnded = false;
+			}
+			if( rowEnded || candidate.x < rowLeft )
+			{
+				continue;
+			}
+			if( candidate.x > getLastCellBefore(position.x + size.x - std::fabs(position.x) * DOUBLE_EPSILON) )
+			{
+				rowEnded = true;
+				continue;
+			}
+			testTileCollisionX(sprite, oldPosition, candidate, stop);
+		}
+	}
+	for( int y = bottom; y <= top && !useTileCandidates; ++y )
 	{
-		for( double x = std::floor(position.x); x < position.x + size.x - std::fabs(position.x) * DOUBLE_EPSILON; ++x )
+		// The range is recomputed for every cell, since position.x changes when a tile stops the sprite
+		for( int x = static_cast<int>(std::floor(position.x)); x <= getLastCellBefore(position.x + size.x - std::fabs(position.x) * DOUBLE_EPSILON); ++x )
 		{
 			Cell* cell = getCell(x, y);
 			if( cell == nullptr )
@@ -138,39 +554,14 @@ bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& ol
 				continue;
 			}
 
-			if( tileCollisionsEnabled )
+			// Check collisions with tiles
+			if( tileCollisionsEnabled && cell->tile != nullptr )
 			{
-				// Check collisions with tiles
-				if( cell->tile != nullptr )
-				{
-					Tile* tile = cell->tile;
-					if( velocity.x > 0 &&
-						position.x + size.x > tile->x - std::fabs(tile->x) * DOUBLE_EPSILON &&
-						oldPosition.x + size.x <= tile->x + EPSILON * EPSILON )
-					{
-						if( getCellEdgeState(x, y, EDGE_LEFT) == true )
-						{
-							position.x = tile->x - size.x;
-							stop = true;
-						}
-						collisionTiles.insert(tile);
-					}
-					else if( velocity.x < 0 &&
-						position.x - std::fabs(position.x) * DOUBLE_EPSILON < tile->x + tile->width &&
-						oldPosition.x + EPSILON * EPSILON >= tile->x + tile->width )
-					{
-						if( getCellEdgeState(x, y, EDGE_RIGHT) == true )
-						{
-							position.x = tile->x + tile->width;
-							stop = true;
-						}
-						collisionTiles.insert(tile);
-					}
-				}
+				testTileCollisionX(sprite, oldPosition, TileCandidate{cell->tile, x, y}, stop);
 			}
 
 			// Check collisions with sprites
-			if( spriteCollisionsEnabled )
+			if( spriteCollisionsEnabled && spriteBroadphase == BROADPHASE_GRID )
 			{
 				for( auto sprite2 : cell->sprites )
 				{
@@ -179,15 +570,16 @@ bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& ol
 						continue;
 					}
 
+					spritePairTests++;
 					if( intersects(Vector2<double>(position.x, oldPosition.y), size, sprite2->position, sprite2->size) )
 					{
 						if( velocity.x > 0 )
 						{
-							collisionSprites.insert(sprite2);
+							addCollision(sprite2);
 						}
 						else if( velocity.x < 0 )
 						{
-							collisionSprites.insert(sprite2);
+							addCollision(sprite2);
 						}
 					}
 				}
@@ -195,6 +587,27 @@ bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& ol
 		}
 	}
 
+	// Check collisions with sprites once the x position is final, testing each nearby sprite once
+	if( spriteCollisionsEnabled && spriteBroadphase == BROADPHASE_SWEEP && velocity.x != 0 )
+	{
+		Vector2<int> cellsMin(static_cast<int>(std::floor(position.x)), static_cast<int>(std::floor(oldPosition.y)));
+		Vector2<int> cellsMax(getLastCellBefore(position.x + size.x - std::fabs(position.x) * DOUBLE_EPSILON), top);
+		findSweepSprites(cellsMin, cellsMax);
+		for( auto sprite2 : sweepCandidates )
+		{
+			if( sprite2 == sprite )
+			{
+				continue;
+			}
+
+			spritePairTests++;
+			if( intersects(Vector2<double>(position.x, oldPosition.y), size, sprite2->position, sprite2->size) )
+			{
+				addCollision(sprite2);
+			}
+		}
+	}
+
 	double centerX = position.x + size.x / 2.0;
 	double oldCenterX = oldPosition.x + size.x / 2.0;
 	bool onSlope = false;
@@ -205,14 +618,14 @@ bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& ol
 		// Check for slopes (ugly, please comment more)
 		if( /*velocity.y < 0*/ true ) ///@todo is this needed? not having it fixes issues when jumping up through slopes when we don't check y velocity.
 		{
-			for( double y = std::floor(oldPosition.y - 1); y < oldPosition.y + size.y; ++y )
+			int top = getLastCellBefore(oldPosition.y + size.y);
+			for( int y = static_cast<int>(std::floor(oldPosition.y - 1)); y <= top; ++y )
 			{
-				Cell* cell = getCell(std::floor(centerX), y);
-				if( cell != nullptr && cell->tile != nullptr &&
-					(cell->tile->collisionBehavior == TILE_SLOPE_DOWN || cell->tile->collisionBehavior == TILE_SLOPE_UP) )
+				Cell* cell = getCell(static_cast<int>(std::floor(centerX)), y);
+				if( cell != nullptr && (cell->edges & CELL_SLOPE) )
 				{
 					Tile* tile = cell->tile;
-					double height, oldHeight;
+					double height = 0.0, oldHeight = 0.0;
 					if( tile->collisionBehavior == TILE_SLOPE_DOWN )
 					{
 						height = tile->y + tile->height - (double)tile->height * (centerX - (double)tile->x) / (double)tile->width;
@@ -343,7 +756,7 @@ bool World::doSpriteCollisionXAxisTest(Sprite* sprite, const Vector2<double>& ol
 	}
 }
 
-bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled)
+bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled, const SpriteMotion* motion)
 {
 	Vector2<double>& velocity = sprite->velocity;
 	Vector2<double>& position = sprite->position;
@@ -360,14 +773,14 @@ bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& ol
 	{
 		if( velocity.y < 0 )
 		{
-			for( double y = std::floor(position.y - 1); y < position.y + size.y; ++y )
+			int top = getLastCellBefore(position.y + size.y);
+			for( int y = static_cast<int>(std::floor(position.y - 1)); y <= top; ++y )
 			{
-				Cell* cell = getCell(std::floor(centerX), y);
-				if( cell != nullptr && cell->tile != nullptr &&
-					(cell->tile->collisionBehavior == TILE_SLOPE_DOWN || cell->tile->collisionBehavior == TILE_SLOPE_UP) )
+				Cell* cell = getCell(static_cast<int>(std::floor(centerX)), y);
+				if( cell != nullptr && (cell->edges & CELL_SLOPE) )
 				{
 					Tile* tile = cell->tile;
-					double height, oldHeight;
+					double height = 0.0, oldHeight = 0.0;
 					if( tile->collisionBehavior == TILE_SLOPE_DOWN )
 					{
 						height = tile->y + tile->height - (double)tile->height * (centerX - (double)tile->x) / (double)tile->width;
@@ -395,13 +808,36 @@ bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& ol
 	}
 
 	// Lists of tiles and sprites that the sprite collides with
-	std::set<Tile*> collisionTiles;
-	std::set<Sprite*> collisionSprites;
-
-	// Do regular axis checking
-	for( double x = std::floor(position.x); x < position.x + size.x - std::fabs(position.x) * DOUBLE_EPSILON; ++x )
+	collisionTiles.clear();
+	collisionSprites.clear();
+
+	// Do regular axis checking, with the tiles gathered at the start of the
+	// update if they cover the cells
+	int left = static_cast<int>(std::floor(position.x));
+	int bottom = static_cast<int>(std::floor(position.y));
+	int right = getLastCellBefore(position.x + size.x - std::fabs(position.x) * DOUBLE_EPSILON);
+	int top = getLastCellBefore(position.y + size.y - std::fabs(position.y) * DOUBLE_EPSILON);
+	bool useTileCandidates = tileCollisionsEnabled && motion != nullptr && motion->tileVersion == tileVersion &&
+		!(spriteCollisionsEnabled && spriteBroadphase == BROADPHASE_GRID) &&
+		left >= motion->tileCellsMin.x && right <= motion->tileCellsMax.x &&
+		bottom >= motion->tileCellsMin.y && top <= motion->tileCellsMax.y;
+	if( useTileCandidates )
 	{
-		for( double y = std::floor(position.y); y < position.y + size.y - std::fabs(position.y) * DOUBLE_EPSILON; ++y )
+		// The candidates are sorted by row, but the cells are visited by column
+		for( int x = left; x <= right; ++x )
+		{
+			for( auto& candidate : motion->tileCandidates )
+			{
+				if( candidate.x == x && candidate.y >= bottom && candidate.y <= top )
+				{
+					testTileCollisionY(sprite, oldPosition, candidate, slope, newY, stop);
+				}
+			}
+		}
+	}
+	for( int x = left; x <= right && !useTileCandidates; ++x )
+	{
+		for( int y = bottom; y <= top; ++y )
 		{
 			Cell* cell = getCell(x, y);
 			if( cell == nullptr )
@@ -409,43 +845,13 @@ bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& ol
 				continue;
 			}
 
-			if( tileCollisionsEnabled )
+			// Check collisions with tiles
+			if( tileCollisionsEnabled && cell->tile != nullptr )
 			{
-				// Check collisions with tiles
-				if( cell->tile != nullptr )
-				{
-					Tile* tile = cell->tile;
-					if( velocity.y > 0 &&
-						position.y + size.y > tile->y - std::fabs(tile->y) * DOUBLE_EPSILON &&
-						oldPosition.y + size.y <= tile->y + std::fabs(tile->y) * DOUBLE_EPSILON )
-					{
-						if( getCellEdgeState(x, y, EDGE_BOTTOM) == true )
-						{
-							//position.y = tile->y - size.y;
-							newY = tile->y - size.y;
-							stop = true;
-						}
-						collisionTiles.insert(tile);
-					}
-					else if( velocity.y < 0 &&
-						position.y - std::fabs(position.y) * DOUBLE_EPSILON < tile->y + tile->height &&
-						oldPosition.y + std::fabs(oldPosition.y) * DOUBLE_EPSILON >= tile->y + tile->height )
-					{
-						if( getCellEdgeState(x, y, EDGE_TOP) == true )
-						{
-							// Override - this allows "sinking" into slopes from adjacent tiles
-							if( !slope )
-							{
-								newY = tile->y + tile->height;
-								stop = true;
-							}
-						}
-						collisionTiles.insert(tile);
-					}
-				}
+				testTileCollisionY(sprite, oldPosition, TileCandidate{cell->tile, x, y}, slope, newY, stop);
 			}
 
-			if( spriteCollisionsEnabled )
+			if( spriteCollisionsEnabled && spriteBroadphase == BROADPHASE_GRID )
 			{
 				// Check collisions with sprites
 				for( auto sprite2 : cell->sprites )
@@ -455,15 +861,16 @@ bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& ol
 						continue;
 					}
 
+					spritePairTests++;
 					if( intersects(position, size, sprite2->position, sprite2->size) )
 					{
 						if( velocity.y > 0 )
 						{
-							collisionSprites.insert(sprite2);
+							addCollision(sprite2);
 						}
 						else if( velocity.y < 0 )
 						{
-							collisionSprites.insert(sprite2);
+							addCollision(sprite2);
 						}
 					}
 				}
@@ -471,6 +878,25 @@ bool World::doSpriteCollisionYAxisTest(Sprite* sprite, const Vector2<double>& ol
 		}
 	}
 
+	// Check collisions with sprites, testing each nearby sprite once
+	if( spriteCollisionsEnabled && spriteBroadphase == BROADPHASE_SWEEP && velocity.y != 0 )
+	{
+		findSweepSprites(Vector2<int>(left, bottom), Vector2<int>(right, top));
+		for( auto sprite2 : sweepCandidates )
+		{
+			if( sprite2 == sprite )
+			{
+				continue;
+			}
+
+			spritePairTests++;
+			if( intersects(position, size, sprite2->position, sprite2->size) )
+			{
+				addCollision(sprite2);
+			}
+		}
+	}
+
 	// Update the flying flag
 	bool oldFlyingState = sprite->flying;
 	if( (stop && sprite->velocity.y <= 0.0) || sprite->exitedSlopeThisFrame )
@@ -542,19 +968,29 @@ void World::endLevel( int exit )
 void World::eraseSprite(Sprite* sprite)
 {
 	// Remove the sprite from all cells it is (was) on
-	for( auto v : sprite->occupiedCells )
+	for( int x = sprite->occupiedCellsMin.x; x <= sprite->occupiedCellsMax.x; ++x )
 	{
-		Cell* cell = getCell(v.x, v.y);
-		if( cell != nullptr )
+		for( int y = sprite->occupiedCellsMin.y; y <= sprite->occupiedCellsMax.y; ++y )
 		{
-			cell->sprites.erase(sprite);
+			Cell* cell = getCell(x, y);
+			if( cell != nullptr )
+			{
+				auto it = std::find(cell->sprites.begin(), cell->sprites.end(), sprite);
+				if( it != cell->sprites.end() )
+				{
+					cell->sprites.erase(it);
+				}
+			}
 		}
 	}
-	sprite->occupiedCells.clear();
+	sprite->occupiedCellsMin = Vector2<int>(0, 0);
+	sprite->occupiedCellsMax = Vector2<int>(-1, -1);
 }
 
 void World::eraseTile(Tile* tile)
 {
+	invalidateTileChunks(tile->x - 1, tile->y - 1, tile->x + tile->width, tile->y + tile->height);
+
 	// Remove the tile from all cells it is on
 	for( int x = tile->x; x < tile->x + tile->width; ++x )
 	{
@@ -567,6 +1003,103 @@ void World::eraseTile(Tile* tile)
 			}
 		}
 	}
+	updateCellEdges(tile->x, tile->y, tile->x + tile->width - 1, tile->y + tile->height - 1);
+
+	if( tile->updateEnabled )
+	{
+		auto it = std::find(updatedTiles.begin(), updatedTiles.end(), tile);
+		if( it != updatedTiles.end() )
+		{
+			updatedTiles.erase(it);
+		}
+	}
+}
+
+void World::findSweepSprites( const Vector2<int>& cellsMin, const Vector2<int>& cellsMax )
+{
+	sweepCandidates.clear();
+	compactSweepSprites();
+
+	// Only cells inside of the world hold sprites, so clip the range to match the grid
+	int left = std::max(cellsMin.x, 0);
+	int bottom = std::max(cellsMin.y, 0);
+	int right = std::min(cellsMax.x, width - 1);
+	int top = std::min(cellsMax.y, height - 1);
+	if( left > right || bottom > top )
+	{
+		return;
+	}
+
+	// No sprite that starts left of this can reach the range, since none are wider than sweepMaxWidth
+	auto it = std::lower_bound(sweepSprites.begin(), sweepSprites.end(), left - sweepMaxWidth,
+		[](const Sprite* sprite, int x){ return sprite->occupiedCellsMin.x < x; });
+	for( ; it != sweepSprites.end() && (*it)->occupiedCellsMin.x <= right; ++it )
+	{
+		Sprite* sprite = *it;
+		if( sprite->occupiedCellsMax.x >= left &&
+			sprite->occupiedCellsMin.y <= top && sprite->occupiedCellsMax.y >= bottom )
+		{
+			if( sweepCandidates.size() == sweepCandidates.capacity() )
+			{
+				collisionAllocations++;
+			}
+			sweepCandidates.push_back(sprite);
+		}
+	}
+}
+
+void World::findVisitedSprites()
+{
+	visitedSprites.clear();
+	if( !activityViewSet )
+	{
+		for( std::size_t i = 0; i < sprites.size(); ++i )
+		{
+			if( sprites[i] != nullptr )
+			{
+				visitedSprites.push_back(i);
+			}
+		}
+		return;
+	}
+
+	// Sprites near the view may be awake, and they can touch sprites that
+	// are a little further away, even if those are dormant
+	int reach = sweepMaxWidth + SPRITE_REACH;
+	double halfWidth = activityViewWidth / 2.0 + DORMANT_DISTANCE;
+	visitSweepSprites(static_cast<int>(std::floor(activityViewX - halfWidth)) - reach, static_cast<int>(std::ceil(activityViewX + halfWidth)) + reach);
+
+	// Roaming sprites are visited wherever they are, and the ones that
+	// always update can touch the sprites around them
+	for( auto sprite : roamingSprites )
+	{
+		visitedSprites.push_back(sprite->worldIndex);
+		if( sprite->activityPolicy == ACTIVITY_ALWAYS )
+		{
+			visitSweepSprites(sprite->occupiedCellsMin.x - reach, sprite->occupiedCellsMax.x + reach);
+		}
+	}
+
+	// Visit each sprite once, in list order
+	std::sort(visitedSprites.begin(), visitedSprites.end());
+	visitedSprites.erase(std::unique(visitedSprites.begin(), visitedSprites.end()), visitedSprites.end());
+}
+
+void World::finishSpriteUpdate( Sprite* sprite )
+{
+	// Move the sprite in the grid, but only if it now covers different cells
+	Vector2<int> cellsMin;
+	Vector2<int> cellsMax;
+	getSpriteCells(sprite, cellsMin, cellsMax);
+	if( !(cellsMin == sprite->occupiedCellsMin && cellsMax == sprite->occupiedCellsMax) )
+	{
+		eraseSprite(sprite);
+		insertSprite(sprite);
+		sortSweepSprite(sprite);
+	}
+
+	// Post update (after movement)
+	sprite->onPostUpdate();
 }
 
 void World::freezeTime()
@@ -574,6 +1107,29 @@ void World::freezeTime()
 	timeFrozen = true;
 }
 
+void World::gatherTileCandidates( const Sprite* sprite, SpriteMotion& motion ) const
+{
+	const Vector2<double>& position = sprite->position;
+	motion.tileCellsMin.x = static_cast<int>(std::floor(position.x)) - TILE_CANDIDATE_MARGIN;
+	motion.tileCellsMin.y = static_cast<int>(std::floor(position.y)) - TILE_CANDIDATE_MARGIN;
+	motion.tileCellsMax.x = getLastCellBefore(position.x + sprite->size.x) + TILE_CANDIDATE_MARGIN;
+	motion.tileCellsMax.y = getLastCellBefore(position.y + sprite->size.y) + TILE_CANDIDATE_MARGIN;
+	motion.tileVersion = tileVersion;
+
+	motion.tileCandidates.clear();
+	for( int y = std::max(motion.tileCellsMin.y, 0); y <= std::min(motion.tileCellsMax.y, height - 1); ++y )
+	{
+		for( int x = std::max(motion.tileCellsMin.x, 0); x <= std::min(motion.tileCellsMax.x, width - 1); ++x )
+		{
+			const Cell* cell = getCell(x, y);
+			if( cell->tile != nullptr )
+			{
+				motion.tileCandidates.push_back(TileCandidate{cell->tile, x, y});
+			}
+		}
+	}
+}
+
 World::Cell* World::getCell(int x, int y)
 {
 	if( x < 0 || x >= width || y < 0 || y >= height )
@@ -594,78 +1150,20 @@ const World::Cell* World::getCell( int x, int y ) const
 	return &cells[y * width + x];
 }
 
-bool World::getCellEdgeState(int x, int y, Edge edge)
+bool World::getCellEdgeState(int x, int y, Edge edge) const
 {
-	int dx = 0;
-	int dy = 0;
-	Edge otherEdge = getOppositeEdge(edge);
-	switch( edge )
-	{
-		case EDGE_BOTTOM:
-			dy--;
-			break;
-
-		case EDGE_LEFT:
-			dx--;
-			break;
-
-		case EDGE_RIGHT:
-			dx++;
-			break;
-
-		case EDGE_TOP:
-			dy++;
-			break;
-	}
-
-	bool edge1 = false;
-	bool edge2 = false;
-
-	Cell* cell = getCell(x, y);
-	Cell* cell2 = getCell(x + dx, y + dy);
-	Tile* tile = nullptr;
-	Tile* tile2 = nullptr;
-	if( cell != nullptr )
-	{
-		tile = cell->tile;
-	}
-	if( cell2 != nullptr )
+	const Cell* cell = getCell(x, y);
+	if( cell == nullptr )
 	{
-		tile2 = cell2->tile;
+		return computeCellEdgeState(x, y, edge);
 	}
 
-	bool slope = false; // Slopes are a special case
-	bool tileIsSlope = false;
-	if( tile != tile2 ) // Edges within the same tile are never solid
-	{
-		if( tile != nullptr )
-		{
-			edge1 = tile->getEdgeState(edge);
-			if( tile->collisionBehavior == TILE_SLOPE_DOWN || tile->collisionBehavior == TILE_SLOPE_UP )
-			{
-				if( edge1 )
-				{
-					slope = true;
-				}
-				tileIsSlope = true;
-			}
-		}
-		if( tile2 != nullptr )
-		{
-			edge2 = tile2->getEdgeState(otherEdge);
-			if( tile2->collisionBehavior == TILE_SLOPE_DOWN || tile2->collisionBehavior == TILE_SLOPE_UP )
-			{
-				if( edge2 )
-				{
-					slope = true;
-				}
-			}
-		}
-	}
+	return (cell->edges & (1 << edge)) != 0;
+}
 
-	return (edge1 != edge2 &&
-		!slope &&
-		!(tileIsSlope && edge == EDGE_BOTTOM) ); // Exemption for top edge below slopes
+int World::getCollisionAllocationCount() const
+{
+	return collisionAllocations;
 }
 
 double World::getDelta() const
@@ -693,7 +1191,21 @@ Random& World::getRandom()
 	return *random;
 }
 
-const std::set<Sprite*>* World::getSprites( int x, int y ) const
+void World::getSpriteCells( const Sprite* sprite, Vector2<int>& cellsMin, Vector2<int>& cellsMax ) const
+{
+	// Cells that only touch the right or top edge of the sprite are not covered by it
+	cellsMin.x = static_cast<int>(std::floor(sprite->position.x));
+	cellsMin.y = static_cast<int>(std::floor(sprite->position.y));
+	cellsMax.x = static_cast<int>(std::ceil(sprite->position.x + sprite->size.x)) - 1;
+	cellsMax.y = static_cast<int>(std::ceil(sprite->position.y + sprite->size.y)) - 1;
+}
+
+int World::getSpritePairTestCount() const
+{
+	return spritePairTests;
+}
+
+const std::vector<Sprite*>* World::getSprites( int x, int y ) const
 {
 	const Cell* cell = getCell(x, y);
 	if( cell != nullptr )
@@ -706,9 +1218,9 @@ const std::set<Sprite*>* World::getSprites( int x, int y ) const
 	}
 }
 
-std::set<Sprite*> World::getSpritesInBox( double left, double bottom, double width, double height )
+std::vector<Sprite*> World::getSpritesInBox( double left, double bottom, double width, double height )
 {
-	std::set<Sprite*> spriteSet;
+	std::vector<Sprite*> boxSprites;
 	Vector2<double> position(left, bottom);
 	Vector2<double> box(width, height);
 	for( int x = static_cast<int>(std::floor(left)); x <= static_cast<int>(std::floor(left + width)); x++ )
@@ -720,15 +1232,45 @@ std::set<Sprite*> World::getSpritesInBox( double left, double bottom, double wid
 			{
 				for( auto t : *s )
 				{
-					if( intersects(position, box, t->position, t->size) )
+					if( intersects(position, box, t->position, t->size) &&
+						std::find(boxSprites.begin(), boxSprites.end(), t) == boxSprites.end() )
 					{
-						spriteSet.insert(t);
+						boxSprites.push_back(t);
 					}
 				}
 			}
 		}
 	}
-	return spriteSet;
+	return boxSprites;
+}
+
+unsigned int World::getStateHash() const
+{
+	// FNV-1a hash of the state that affects gameplay. Particles are left out,
+	// since they are cosmetic and their lifetime depends on when they are rendered.
+	unsigned int hash = 2166136261u;
+	hashValue(hash, frameNumber);
+	hashValue(hash, time);
+	hashValue(hash, status.statusType);
+	for( auto sprite : sprites )
+	{
+		if( sprite == nullptr || dynamic_cast<Particle*>(sprite) != nullptr )
+		{
+			continue;
+		}
+		hashValue(hash, sprite->position.x);
+		hashValue(hash, sprite->position.y);
+		hashValue(hash, sprite->velocity.x);
+		hashValue(hash, sprite->velocity.y);
+		hashValue(hash, sprite->dead);
+		hashValue(hash, sprite->flying);
+	}
+	if( player != nullptr )
+	{
+		// The score and coins carry over between levels, so only the powerup state is hashed
+		hashValue(hash, player->getState());
+	}
+	return hash;
 }
 
 WorldStatus World::getStatus() const
@@ -748,21 +1290,21 @@ const Tile* World::getTile( int x, int y ) const
 	return tile;
 }
 
-std::set<Tile*> World::getTilesInBox( double left, double bottom, double width, double height )
+std::vector<Tile*> World::getTilesInBox( double left, double bottom, double width, double height )
 {
-	std::set<Tile*> tileSet;
+	std::vector<Tile*> boxTiles;
 	for( int x = static_cast<int>(std::floor(left)); x <= static_cast<int>(std::floor(left + width)); x++ )
 	{
 		for( int y = static_cast<int>(std::floor(bottom)); y <= static_cast<int>(std::floor(bottom + height)); y++ )
 		{
 			auto t = const_cast<Tile*>(getTile(x, y));
-			if( t != nullptr )
+			if( t != nullptr && std::find(boxTiles.begin(), boxTiles.end(), t) == boxTiles.end() )
 			{
-				tileSet.insert(t);
+				boxTiles.push_back(t);
 			}
 		}
 	}
-	return tileSet;
+	return boxTiles;
 }
 
 int World::getTime() const
@@ -785,37 +1327,262 @@ void World::handleCollision(Sprite* sprite1, Sprite* sprite2, Edge edge)
 	/// @todo move the dead check to the calling function for optimization
 	if( !sprite1->dead && sprite2->spriteCollisionsEnabled && !sprite2->dead )
 	{
-		// Activate event handlers
+		// Activate event handlers. They are game logic rather than collision
+		// testing, so their allocations aren't counted as the testing's.
+		bool resolving = resolvingCollisions;
+		resolvingCollisions = false;
 		sprite1->onCollision(*sprite2, edge);
 		sprite2->onCollision(*sprite1, getOppositeEdge(edge));
+		resolvingCollisions = resolving;
 	}
 }
 
 void World::handleCollision(Sprite* sprite, Tile* tile, Edge edge)
 {
-	// Activate event handlers
+	// Activate event handlers, without counting their allocations
+	bool resolving = resolvingCollisions;
+	resolvingCollisions = false;
 	sprite->onCollision(*tile, edge);
 	tile->onCollision(*sprite, getOppositeEdge(edge));
+	resolvingCollisions = resolving;
 }
 
 void World::insertSprite(Sprite* sprite)
 {
 	// Add the sprite to all cells it is on
-	sprite->occupiedCells.clear();
-	for( double x = std::floor(sprite->position.x); x < sprite->position.x + sprite->size.x; x++ )
+	getSpriteCells(sprite, sprite->occupiedCellsMin, sprite->occupiedCellsMax);
+	for( int x = sprite->occupiedCellsMin.x; x <= sprite->occupiedCellsMax.x; ++x )
 	{
-		for( double y = std::floor(sprite->position.y); y < sprite->position.y + sprite->size.y; y++ )
+		for( int y = sprite->occupiedCellsMin.y; y <= sprite->occupiedCellsMax.y; ++y )
 		{
-			int a = std::floor(x);
-			int b = std::floor(y);
-			Cell* cell = getCell(a, b);
+			Cell* cell = getCell(x, y);
 			if( cell != nullptr )
 			{
-				cell->sprites.insert(sprite);
-				sprite->occupiedCells.push_back(Vector2<int>(a, b));
+				cell->sprites.push_back(sprite);
+			}
+		}
+	}
+}
+
+void World::insertRoamingSprite( Sprite* sprite )
+{
+	// Sprites that always update or despawn when far away can't be left dormant
+	if( sprite->activityPolicy == ACTIVITY_ALWAYS || sprite->activityPolicy == ACTIVITY_DESPAWN )
+	{
+		roamingSprites.push_back(sprite);
+	}
+}
+
+void World::insertSweepSprite( Sprite* sprite )
+{
+	compactSweepSprites();
+	sprite->sweepIndex = sweepSprites.size();
+	sweepSprites.push_back(sprite);
+	sortSweepSprite(sprite);
+}
+
+void World::integrateSprite( Sprite* sprite, double step )
+{
+	Vector2<double> acceleration = sprite->acceleration;
+	if( sprite->gravityEnabled )
+	{
+		acceleration += Vector2<double>(0, Sprite::DEFAULT_GRAVITY);
+	}
+
+	// Update velocity
+	sprite->velocity += (acceleration * step);
+
+	// Cap velocity. Collisions can't stop a sprite that moves more than one
+	// cell per step, so that cap applies even below the maximum speed, and
+	// sprites moving by a longer step at a reduced rate are capped lower.
+	if( sprite->maximumSpeed.x != 0 && std::fabs(sprite->velocity.x) > sprite->maximumSpeed.x )
+	{
+		sprite->velocity.x = sign(sprite->velocity.x) * sprite->maximumSpeed.x;
+	}
+	if( std::fabs(sprite->velocity.x) > 1.0 / step )
+	{
+		sprite->velocity.x = sign(sprite->velocity.x) / step;
+	}
+	if( sprite->maximumSpeed.y != 0 && std::fabs(sprite->velocity.y) > sprite->maximumSpeed.y )
+	{
+		sprite->velocity.y = sign(sprite->velocity.y) * sprite->maximumSpeed.y;
+	}
+	if( std::fabs(sprite->velocity.y) > 1.0 / step )
+	{
+		sprite->velocity.y = sign(sprite->velocity.y) / step;
+	}
+
+	// Update position
+	sprite->position += sprite->velocity * step;
+}
+
+void World::integrateSpriteMotions( int visitedCount )
+{
+	if( (int)spriteMotions.size() < visitedCount )
+	{
+		spriteMotions.resize(visitedCount);
+	}
+
+	auto integrate = [this, visitedCount]( int batch )
+	{
+		int end = std::min(visitedCount, (batch + 1) * SPRITE_MOTION_BATCH_SIZE);
+		for( int i = batch * SPRITE_MOTION_BATCH_SIZE; i < end; ++i )
+		{
+			Sprite* sprite = sprites[visitedSprites[i]];
+			SpriteMotion& motion = spriteMotions[i];
+			motion.step = 0.0;
+			motion.tileVersion = tileVersion - 1;
+			motion.updated = false;
+			if( sprite == nullptr )
+			{
+				motion.independent = false;
+				continue;
+			}
+
+			motion.independent = sprite->independentUpdateEnabled && !sprite->held && !sprite->spriteCollisionsEnabled && !sprite->tileCollisionsEnabled;
+			if( !motion.independent )
+			{
+				// The sprite is moved later, in list order, but the tiles it
+				// may hit can be found now from where it starts
+				if( sprite->tileCollisionsEnabled && !sprite->held )
+				{
+					gatherTileCandidates(sprite, motion);
+				}
+				continue;
+			}
+
+			motion.updated = scheduleSprite(sprite, motion.step);
+			if( motion.updated && sprite->motionEnabled )
+			{
+				sprite->onPreUpdate();
+				if( motion.step > 0.0 )
+				{
+					integrateSprite(sprite, motion.step);
+				}
+			}
+		}
+	};
+
+	int batchCount = (visitedCount + SPRITE_MOTION_BATCH_SIZE - 1) / SPRITE_MOTION_BATCH_SIZE;
+	if( threadPool != nullptr )
+	{
+		threadPool->parallelFor(batchCount, integrate);
+	}
+	else
+	{
+		for( int batch = 0; batch < batchCount; ++batch )
+		{
+			integrate(batch);
+		}
+	}
+}
+
+void World::invalidateTileChunks( int left, int bottom, int right, int top )
+{
+	if( tileChunks.empty() )
+	{
+		return;
+	}
+
+	left = std::max(left, 0) / TILE_CHUNK_SIZE;
+	bottom = std::max(bottom, 0) / TILE_CHUNK_SIZE;
+	right = std::min(right / TILE_CHUNK_SIZE, tileChunkColumns - 1);
+	top = std::min(top / TILE_CHUNK_SIZE, tileChunkRows - 1);
+	for( int x = left; x <= right; ++x )
+	{
+		for( int y = bottom; y <= top; ++y )
+		{
+			tileChunks[y * tileChunkColumns + x].dirty = true;
+		}
+	}
+}
+
+bool World::isTileCacheable( Tile* tile ) const
+{
+	if( !tile->renderCacheEnabled || tile->playingAnimation ||
+		tile->offset.x != 0.0 || tile->offset.y != 0.0 ||
+		tile->redMask != 1.0f || tile->greenMask != 1.0f || tile->blueMask != 1.0f || tile->alpha != 1.0f )
+	{
+		return false;
+	}
+	if( tile->activeAnimation != nullptr && tile->activeAnimation->getLength() > 1 )
+	{
+		return false;
+	}
+
+	if( tile->tilesetEnabled )
+	{
+		for( int x = 0; x < tile->width; x++ )
+		{
+			for( int y = 0; y < tile->height; y++ )
+			{
+				const Animation* animation = tile->getTilesetAnimation( x, y );
+				if( animation != nullptr && animation->getLength() > 1 )
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+bool World::isTileMappable( Tile* tile ) const
+{
+	if( !tile->renderCacheEnabled || tile->playingAnimation || tile->animationPaused ||
+		tile->offset.x != 0.0 || tile->offset.y != 0.0 ||
+		tile->redMask != 1.0f || tile->greenMask != 1.0f || tile->blueMask != 1.0f || tile->alpha != 1.0f )
+	{
+		return false;
+	}
+
+	// Each cell can only hold one frame
+	for( int x = std::max(tile->x, 0); x < std::min(tile->x + tile->width, width); x++ )
+	{
+		for( int y = std::max(tile->y, 0); y < std::min(tile->y + tile->height, height); y++ )
+		{
+			if( getCell(x, y)->tile != tile )
+			{
+				return false;
 			}
 		}
 	}
+
+	if( !tile->tilesetEnabled )
+	{
+		return tile->width == 1 && tile->height == 1 && tile->activeAnimation != nullptr &&
+			tile->activeAnimation->getHorizontalOrientation() == tile->horizontalOrientation &&
+			tile->activeAnimation->getVerticalOrientation() == tile->verticalOrientation &&
+			TileMap::canDrawAnimation(tile->activeAnimation);
+	}
+
+	// The active animation is drawn on top of the tileset
+	if( tile->activeAnimation != nullptr && tile->activeAnimation->getLength() > 0 )
+	{
+		return false;
+	}
+	for( int x = 0; x < tile->width; x++ )
+	{
+		for( int y = 0; y < tile->height; y++ )
+		{
+			const Animation* animation = tile->getTilesetAnimation( x, y );
+			if( animation != nullptr &&
+				(animation->getHorizontalOrientation() != tile->horizontalOrientation ||
+				animation->getVerticalOrientation() != tile->verticalOrientation ||
+				!TileMap::canDrawAnimation(animation)) )
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool World::isResolvingCollisions()
+{
+	return resolvingCollisions;
 }
 
 bool World::isUnderwater( double x, double y ) const
@@ -843,6 +1610,16 @@ void World::loadLevel( const Level* level )
 	cells.clear();
 	cells.resize(level->width * level->height);
 
+	// Split the level into tile chunks, which are built the first time the level is rendered
+	tileChunkColumns = (width + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	tileChunkRows = (height + TILE_CHUNK_SIZE - 1) / TILE_CHUNK_SIZE;
+	tileChunks.clear();
+	tileChunks.resize(tileChunkColumns * tileChunkRows);
+	for( auto& tileMap : tileMaps )
+	{
+		tileMap.second->resize(width, height);
+	}
+
 	// Load the entities in the Level
 	int id = 0;
 	for( auto tile : level->tiles )
@@ -873,6 +1650,33 @@ void World::loadLevel( const Level* level )
 	status.statusType = WORLD_RUNNING;
 }
 
+bool World::moveSprite( Sprite* sprite, double step, const SpriteMotion* motion )
+{
+	// Save old kinematic quantities to compare them if the Sprite changes them
+	Vector2<double> oldPosition = sprite->position;
+	bool tileCollisionsEnabled = sprite->tileCollisionsEnabled;
+	bool spriteCollisionsEnabled = sprite->spriteCollisionsEnabled;
+
+	// Motion update
+	if( sprite->motionEnabled )
+	{
+		// Have the sprite update its motion (acceleration, forces, etc.)
+		sprite->onPreUpdate();
+		if( step > 0.0 )
+		{
+			integrateSprite(sprite, step);
+		}
+	}
+
+	// The sprite's physics are skipped on this frame
+	if( step <= 0.0 )
+	{
+		return true;
+	}
+
+	return collideSprite(sprite, oldPosition, tileCollisionsEnabled, spriteCollisionsEnabled, motion);
+}
+
 void World::playBackgroundMusic() const
 {
 	if( backgroundMusic != nullptr )
@@ -881,83 +1685,105 @@ void World::playBackgroundMusic() const
 	}
 }
 
+void World::queueEntity( Entity* entity )
+{
+	if( entity->renderStamp == renderCount )
+	{
+		return;
+	}
+
+	entity->renderStamp = renderCount;
+	renderQueue[entity->layer].push_back(entity);
+}
+
 void World::removeSprite(Sprite* sprite)
 {
 	eraseSprite(sprite);
-	sprites.remove(sprite);
+	removeSweepSprite(sprite);
+	removeRoamingSprite(sprite);
+
+	// Leave an empty slot so the order of the other sprites doesn't change
+	if( sprite->worldIndex != -1 )
+	{
+		sprites[sprite->worldIndex] = nullptr;
+		sprite->worldIndex = -1;
+		removedSprites++;
+	}
 	sprite->world = nullptr;
 	sprite->slope = nullptr;
 }
 
-void World::render(double viewX, double viewY, double viewWidth, double viewHeight)
+void World::removeRoamingSprite( Sprite* sprite )
+{
+	auto it = std::find(roamingSprites.begin(), roamingSprites.end(), sprite);
+	if( it != roamingSprites.end() )
+	{
+		roamingSprites.erase(it);
+	}
+}
+
+void World::removeSweepSprite( Sprite* sprite )
 {
+	if( sprite->sweepIndex == -1 )
+	{
+		return;
+	}
+
+	sweepSprites[sprite->sweepIndex] = nullptr;
+	sprite->sweepIndex = -1;
+	removedSweepSprites++;
+}
+
+void World::render(double viewX, double viewY, double viewWidth, double viewHeight, RenderSnapshot* snapshot)
+{
+	SpriteBatch& batch = SPRITE_BATCH;
+
 	// Clamp view coordinates
 	renderClampView(viewX, viewY, viewWidth, viewHeight, width, height);
 
 	// Render the background
 	if( background != nullptr )
 	{
-		background->getTexture().bind();
-		const Animation::Frame& frame = background->getAnimation().getFrame(frameNumber);
-
-		int frameWidth = (int)(frame.width * UNIT_SIZE);
-		int frameHeight = (int)(frame.height * UNIT_SIZE);
-
-		// Determine the background tilings that the view encompasses
-		int xMin = std::floor((viewX - viewWidth / 2.0) * UNIT_SIZE);
-		int xMax = std::ceil((viewX + viewWidth / 2.0) * UNIT_SIZE) + frameWidth;
-		int yMin = std::floor((viewY - viewHeight / 2.0) * UNIT_SIZE);
-		int yMax = std::ceil((viewY + viewHeight / 2.0) * UNIT_SIZE) + frameHeight;
+		background->render(frameNumber, viewX - viewWidth / 2.0, viewY - viewHeight / 2.0, viewWidth, viewHeight, snapshot);
+	}
 
-		for( int x = xMin; x <= xMax; x += frameWidth )
+	// Add any sprites that come into view
+	spawnSprites(viewX, viewY, viewWidth, viewHeight);
+
+	// Rebuild the cached tile geometry that changed, and find the chunks in view.
+	// Tiles are drawn one by one in debug mode so that their outlines are shown.
+	bool tileChunksEnabled = !SETTINGS.debugMode;
+	int viewLeft = std::floor(viewX - viewWidth / 2.0);
+	int viewRight = std::ceil(viewX + viewWidth / 2.0);
+	int viewBottom = std::floor(viewY - viewHeight / 2.0);
+	int viewTop = std::ceil(viewY + viewHeight / 2.0);
+	visibleTileChunks.clear();
+	if( tileChunksEnabled )
+	{
+		for( int chunkX = 0; chunkX < tileChunkColumns; ++chunkX )
 		{
-			for( int y = yMin; y <= yMax; y += frameHeight )
+			for( int chunkY = 0; chunkY < tileChunkRows; ++chunkY )
 			{
-				glPushMatrix();
-
-				double translationX = x / (double)UNIT_SIZE - xMin / (double)UNIT_SIZE - (xMin / UNIT_SIZE) % frameWidth / (double)UNIT_SIZE;
-				double translationY = y / (double)UNIT_SIZE - yMin / (double)UNIT_SIZE - (yMin / UNIT_SIZE) % frameHeight / (double)UNIT_SIZE;
-				glTranslatef( translationX, translationY, -10.0 );
-
-				if( SETTINGS.debugMode )
+				TileChunk& chunk = tileChunks[chunkY * tileChunkColumns + chunkX];
+				if( chunk.dirty )
 				{
-					glEnable(GL_TEXTURE_2D);
+					buildTileChunk(chunkX, chunkY);
 				}
-
-				glColor4ub(0xff, 0xff, 0xff, 0xff);
-				glBegin(GL_QUADS);
-					glTexCoord2d(frame.left, frame.bottom);
-					glVertex2d(0.0, 0.0);
-					glTexCoord2d(frame.right, frame.bottom);
-					glVertex2d(frame.width, 0.0);
-					glTexCoord2d(frame.right, frame.top);
-					glVertex2d(frame.width, frame.height);
-					glTexCoord2d(frame.left, frame.top);
-					glVertex2d(0.0, frame.height);
-				glEnd();
-
-				if( SETTINGS.debugMode )
+				if( chunk.left <= viewRight && chunk.right >= viewLeft && chunk.bottom <= viewTop && chunk.top >= viewBottom )
 				{
-					glColor4ub(0, 0, 0, 0x7f);
-					glDisable(GL_TEXTURE_2D);
-					glBegin(GL_LINE_LOOP);
-						glVertex2d(0.0, 0.0);
-						glVertex2d(frame.width, 0.0);
-						glVertex2d(frame.width, frame.height);
-						glVertex2d(0.0, frame.height);
-					glEnd();
+					visibleTileChunks.push_back(&chunk);
 				}
-
-				glPopMatrix();
 			}
 		}
 	}
 
-	// Bind the texture atlas
-	RESOURCE_MANAGER.bindTextureAtlas();
-
-	// Build a set of all entities to render
-	std::set<Entity*> entitiesToRender;
+	// Queue every entity in view by layer. Buckets keep their memory between frames, and
+	// entities on the same layer are drawn in the order they were found in the cells.
+	renderCount++;
+	for( auto& bucket : renderQueue )
+	{
+		bucket.second.clear();
+	}
 	for( int x = std::floor(viewX - viewWidth / 2.0); x <= std::ceil(viewX + viewWidth / 2.0); ++x )
 	{
 		for( int y = std::floor(viewY - viewHeight / 2.0); y <= std::ceil(viewY + viewHeight / 2.0); ++y )
@@ -968,21 +1794,17 @@ void World::render(double viewX, double viewY, double viewWidth, double viewHeig
 				continue;
 			}
 
-			// If the cell has a sprite to spawn on it, add it to the world
-			if( cell->spawn != nullptr )
+			if( cell->tile != nullptr && !(tileChunksEnabled && cell->tile->renderCached) )
 			{
-				addSprite(cell->spawn);
-				cell->spawn = nullptr;
+				queueEntity(cell->tile);
 			}
 
-			if( cell->tile != nullptr )
+			// Add all sprites to be rendered
+			for( auto sprite : cell->sprites )
 			{
-				entitiesToRender.insert(cell->tile);
+				queueEntity(sprite);
 			}
 
-			// Add all sprites to be rendered
-			entitiesToRender.insert( cell->sprites.begin(), cell->sprites.end() );
-
 			if( SETTINGS.debugMode )
 			{
 				// Show water
@@ -990,53 +1812,56 @@ void World::render(double viewX, double viewY, double viewWidth, double viewHeig
 				{
 					double transX = x - (viewX - viewWidth / 2.0);
 					double transY = y - (viewY - viewHeight / 2.0);
-					glPushMatrix();
-					glTranslatef(transX, transY, -5.0);
-					glDisable(GL_TEXTURE_2D);
-					glColor4f(0.0f, 0.0f, 1.0f, 0.5f);
-					glBegin(GL_QUADS);
-						glVertex2i(0, 0);
-						glVertex2i(1, 0);
-						glVertex2i(1, 1);
-						glVertex2i(0, 1);
-					glEnd();
-					glColor4f(0.0f, 0.0f, 1.0f, 1.0f);
-					glBegin(GL_LINE_LOOP);
-						glVertex2i(0, 0);
-						glVertex2i(1, 0);
-						glVertex2i(1, 1);
-						glVertex2i(0, 1);
-					glEnd();
-					glPopMatrix();
+					batch.pushTransform();
+					batch.translate(transX, transY, -5.0);
+					batch.drawQuad(0.0, 0.0, 1.0, 1.0, Color(0x00, 0x00, 0xff, 0x7f));
+					batch.drawOutline(0.0, 0.0, 1.0, 1.0, Color(0x00, 0x00, 0xff, 0xff));
+					batch.popTransform();
 				}
 			}
 		}
 	}
 
-	// Sort entities by layer
-	std::vector<Entity*> entities;
-	entities.insert(entities.end(), entitiesToRender.begin(), entitiesToRender.end());
-	std::sort( entities.begin(), entities.end(), [](Entity* a, Entity* b){return ((a->layer < b->layer) || (a->layer == b->layer && a < b));});
-
-	// Render all entities
-	std::stringstream str;
-	for( auto entity : entities )
+	// Render all entities, drawing the cached tiles on each layer before the entities on it.
+	// In debug mode the tile maps aren't kept up to date and every tile is queued instead.
+	auto tileChunkLayer = tileChunksEnabled ? tileChunkLayers.begin() : tileChunkLayers.end();
+	for( auto& bucket : renderQueue )
+	{
+		for( ; tileChunkLayer != tileChunkLayers.end() && *tileChunkLayer <= bucket.first; ++tileChunkLayer )
+		{
+			renderTileChunks(*tileChunkLayer, viewX, viewY, viewWidth, viewHeight, snapshot);
+		}
+		for( auto entity : bucket.second )
+		{
+			renderEntity(entity, viewX, viewY, viewWidth, viewHeight, snapshot);
+		}
+	}
+	for( ; tileChunkLayer != tileChunkLayers.end(); ++tileChunkLayer )
 	{
-		renderEntity(entity, viewX, viewY, viewWidth, viewHeight);
+		renderTileChunks(*tileChunkLayer, viewX, viewY, viewWidth, viewHeight, snapshot);
 	}
+
+	// Draw everything before the caller changes any OpenGL state
+	batch.flush();
 }
 
-void World::renderEntity(Entity* entity, double viewX, double viewY, double viewWidth, double viewHeight)
+void World::renderEntity(Entity* entity, double viewX, double viewY, double viewWidth, double viewHeight, RenderSnapshot* snapshot)
 {
-	glPushMatrix();
+	SpriteBatch& batch = SPRITE_BATCH;
+
+	batch.pushTransform();
 	double transX = entity->getX() - (viewX - viewWidth / 2.0);
 	double transY = entity->getY() - (viewY - viewHeight / 2.0);
+	if( snapshot != nullptr )
+	{
+		snapshot->beginMotion(entity->renderId, transX, transY);
+	}
 
 	// Render to the nearest pixel
 	transX = std::floor( (double)UNIT_SIZE * transX ) / (double)UNIT_SIZE;
 	transY = std::floor( (double)UNIT_SIZE * transY ) / (double)UNIT_SIZE;
 
-	glTranslatef( transX, transY, entity->layer);
+	batch.translate( transX, transY, entity->layer);
 
 	// Draw the frame for the entity
 	const Animation::Frame* frame = entity->getActiveAnimationFrame(frameNumber);
@@ -1046,100 +1871,62 @@ void World::renderEntity(Entity* entity, double viewX, double viewY, double view
 	Tile* tile = dynamic_cast<Tile*>(entity);
 	if( tile != nullptr && tile->tilesetEnabled )
 	{
-		for( int x = 0; x < tile->width; x++ )
-		{
-			for( int y = 0; y < tile->height; y++ )
-			{
-				glPushMatrix();
-				glTranslatef( x, y, 0 );
-				const Animation* animation = tile->getTilesetAnimation( x, y );
-				if( animation != nullptr )
-				{
-					renderFrame( entity, animation, &animation->getFrame(frameNumber), true );
-				}
-				glPopMatrix();
-			}
-		}
+		renderTileset(tile);
 	}
 
 	if( SETTINGS.debugMode )
 	{
-		glDisable(GL_TEXTURE_2D);
-
-		glColor4ub(0xff, 0xff, 0xff, 0x7f);
-		glBegin(GL_LINE_LOOP);
-			glVertex2d(0.0, 0.0);
-			glVertex2d(entity->getWidth(), 0.0);
-			glVertex2d(entity->getWidth(), entity->getHeight());
-			glVertex2d(0.0, entity->getHeight());
-		glEnd();
+		batch.drawOutline(0.0, 0.0, entity->getWidth(), entity->getHeight(), Color(0xff, 0xff, 0xff, 0x7f));
 
 		Tile* tile = dynamic_cast<Tile*>(entity);
 		if( tile != nullptr )
 		{
-			glBegin(GL_LINES);
 			for( int x = 0; x < tile->width; ++x )
 			{
 				for( int y = 0; y < tile->height; ++y )
 				{
 					if( getCellEdgeState(tile->x + x, tile->y + y, EDGE_BOTTOM) )
 					{
-						glColor4ub(0xff, 0x00, 0x00, 0xff);
-						glVertex2i(x, y);
-						glVertex2i(x + 1, y);
+						batch.drawLine(x, y, x + 1, y, Color(0xff, 0x00, 0x00, 0xff));
 					}
 					if( getCellEdgeState(tile->x + x, tile->y + y, EDGE_LEFT) )
 					{
-						glColor4ub(0x00, 0x00, 0xff, 0xff);
-						glVertex2i(x, y);
-						glVertex2i(x, y + 1);
+						batch.drawLine(x, y, x, y + 1, Color(0x00, 0x00, 0xff, 0xff));
 					}
 					if( getCellEdgeState(tile->x + x, tile->y + y, EDGE_RIGHT) )
 					{
-						glColor4ub(0x00, 0x00, 0xff, 0xff);
-						glVertex2i(x + 1, y);
-						glVertex2i(x + 1, y + 1);
+						batch.drawLine(x + 1, y, x + 1, y + 1, Color(0x00, 0x00, 0xff, 0xff));
 					}
 					if( getCellEdgeState(tile->x + x, tile->y + y, EDGE_TOP) )
 					{
-						glColor4ub(0x00, 0xff, 0x00, 0xff);
-						glVertex2i(x, y + 1);
-						glVertex2i(x + 1, y + 1);
+						batch.drawLine(x, y + 1, x + 1, y + 1, Color(0x00, 0xff, 0x00, 0xff));
 					}
 				}
 			}
-			glColor4ub(0x00, 0x00, 0xff, 0xff);
 			if( tile->collisionBehavior == TILE_SLOPE_DOWN )
 			{
-				glVertex2i(0, tile->height);
-				glVertex2i(tile->width, 0);
+				batch.drawLine(0, tile->height, tile->width, 0, Color(0x00, 0x00, 0xff, 0xff));
 			}
 			else if( tile->collisionBehavior == TILE_SLOPE_UP )
 			{
-				glVertex2i(0, 0);
-				glVertex2i(tile->width, tile->height);
+				batch.drawLine(0, 0, tile->width, tile->height, Color(0x00, 0x00, 0xff, 0xff));
 			}
-			glEnd();
 		}
 
 		Sprite* sprite = dynamic_cast<Sprite*>(entity);
 		if( sprite != nullptr && (sprite->spriteCollisionsEnabled || sprite->tileCollisionsEnabled) )
 		{
-			double w = sprite->size.x;
-			double h = sprite->size.y;
-			glColor4ub(0xff, 0xff, 0xff, 0xff);
-			glBegin(GL_LINE_LOOP);
-			glVertex2d(0, 0);
-			glVertex2d(w, 0);
-			glVertex2d(w, h);
-			glVertex2d(0, h);
-			glEnd();
+			batch.drawOutline(0.0, 0.0, sprite->size.x, sprite->size.y, Color(0xff, 0xff, 0xff, 0xff));
 		}
 	} // debugMode
 
 	entity->onRender();
 
-	glPopMatrix();
+	batch.popTransform();
+	if( snapshot != nullptr )
+	{
+		snapshot->endMotion();
+	}
 }
 
 void World::renderFrame( Entity* entity, const Animation* animation, const Animation::Frame* frame, bool tileset )
@@ -1165,33 +1952,112 @@ void World::renderFrame( Entity* entity, const Animation* animation, const Anima
 			std::swap(bottom, top);
 		}
 
-		glEnable(GL_TEXTURE_2D);
-		glPushMatrix();
-		if( tileset )
-		{
-			glTranslatef( xOffset, yOffset, 0.0 );
-		}
-		else
+		double transX = xOffset;
+		double transY = yOffset;
+		if( !tileset )
 		{
-			double transX = entity->getWidth() / 2.0 - frame->width / 2.0 + xOffset;
-			double transY = yOffset;
+			transX = entity->getWidth() / 2.0 - frame->width / 2.0 + xOffset;
 			transX = std::floor( (double)UNIT_SIZE * transX ) / (double)UNIT_SIZE;
 			transY = std::floor( (double)UNIT_SIZE * transY ) / (double)UNIT_SIZE;
-			glTranslatef(transX, transY, 0.0);
 		}
-		glColor4f(entity->redMask, entity->greenMask, entity->blueMask, entity->alpha);
-		glBegin(GL_QUADS);
-			glTexCoord2d(left, bottom);
-			glVertex2d(0.0, 0.0);
-			glTexCoord2d(right, bottom);
-			glVertex2d(frame->width, 0.0);
-			glTexCoord2d(right, top);
-			glVertex2d(frame->width, frame->height);
-			glTexCoord2d(left, top);
-			glVertex2d(0.0, frame->height);
-		glEnd();
-		glPopMatrix();
+
+		Color color(
+			static_cast<ubyte>(entity->redMask * 255.0f),
+			static_cast<ubyte>(entity->greenMask * 255.0f),
+			static_cast<ubyte>(entity->blueMask * 255.0f),
+			static_cast<ubyte>(entity->alpha * 255.0f)
+		);
+		SPRITE_BATCH.drawQuad(RESOURCE_MANAGER.getTextureAtlas(frame->page), transX, transY, frame->width, frame->height, left, bottom, right, top, color);
+	}
+}
+
+void World::renderTileChunks( int layer, double viewX, double viewY, double viewWidth, double viewHeight, RenderSnapshot* snapshot )
+{
+	// Cached tiles are on whole cells, so they only need the pixel aligned view offset
+	double transX = -(viewX - viewWidth / 2.0);
+	double transY = -(viewY - viewHeight / 2.0);
+	if( snapshot != nullptr )
+	{
+		snapshot->beginMotion(RenderSnapshot::LEVEL_MOTION_ID, transX, transY);
+	}
+
+	SpriteBatch& batch = SPRITE_BATCH;
+	batch.pushTransform();
+	batch.translate( std::floor( (double)UNIT_SIZE * transX ) / (double)UNIT_SIZE, std::floor( (double)UNIT_SIZE * transY ) / (double)UNIT_SIZE );
+
+	// Each tile map covers the whole level with one quad, and only the part in view is drawn
+	for( auto tileMap = tileMaps.lower_bound(std::make_pair(layer, 0)); tileMap != tileMaps.end() && tileMap->first.first == layer; ++tileMap )
+	{
+		batch.pushTransform();
+		batch.translate(0.0, 0.0, layer);
+		batch.drawTileMap(tileMap->second, 0.0, 0.0, width, height, frameNumber);
+		batch.popTransform();
+	}
+
+	for( auto chunk : visibleTileChunks )
+	{
+		auto mesh = chunk->layers.find(layer);
+		if( mesh != chunk->layers.end() )
+		{
+			batch.drawMesh(mesh->second);
+		}
+	}
+	batch.popTransform();
+
+	if( snapshot != nullptr )
+	{
+		snapshot->endMotion();
+	}
+}
+
+void World::renderTileset( Tile* tile )
+{
+	SpriteBatch& batch = SPRITE_BATCH;
+	for( int x = 0; x < tile->width; x++ )
+	{
+		for( int y = 0; y < tile->height; y++ )
+		{
+			const Animation* animation = tile->getTilesetAnimation( x, y );
+			if( animation != nullptr )
+			{
+				batch.pushTransform();
+				batch.translate( x, y );
+				renderFrame( tile, animation, &animation->getFrame(frameNumber), true );
+				batch.popTransform();
+			}
+		}
+	}
+}
+
+bool World::scheduleSprite( Sprite* sprite, double& step )
+{
+	step = delta;
+	if( !activityViewSet || sprite->held || sprite->activityPolicy == ACTIVITY_ALWAYS )
+	{
+		return true;
+	}
+
+	// Measure how far the sprite is outside of the view horizontally
+	double distance = std::fabs(sprite->position.x + sprite->size.x / 2.0 - activityViewX) - activityViewWidth / 2.0;
+	if( distance > DORMANT_DISTANCE )
+	{
+		// Far away sprites sleep until the view comes near them again, unless they should despawn
+		if( sprite->activityPolicy == ACTIVITY_DESPAWN )
+		{
+			sprite->kill();
+		}
+		step = 0.0;
+		return false;
+	}
+	else if( distance > ACTIVE_DISTANCE && sprite->activityPolicy == ACTIVITY_DEFAULT )
+	{
+		// Sprites just outside of the view have their physics run less often,
+		// with a longer time step. Their own logic still runs every frame, so
+		// timers kept by the sprite don't slow down.
+		step = (frameNumber % REDUCED_UPDATE_INTERVAL != 0) ? 0.0 : delta * REDUCED_UPDATE_INTERVAL;
 	}
+
+	return true;
 }
 
 void World::setBackground( const std::string& name )
@@ -1205,6 +2071,7 @@ void World::setLevel( int levelId )
 	const Level* level = GAME_SESSION.episode->getLevel(levelId);
 	time = level->time * GAME_FPS;
 	timeFrozen = false;
+	frameNumber = 0;
 	loadLevel(level);
 }
 
@@ -1213,6 +2080,11 @@ void World::setPlayer( Player* player )
 	this->player = player;
 }
 
+void World::setSpriteBroadphase( SpriteBroadphase broadphase )
+{
+	spriteBroadphase = broadphase;
+}
+
 void World::setTile(int x, int y, Tile* tile)
 {
 	tile->world = this;
@@ -1246,6 +2118,15 @@ void World::setTile(int x, int y, Tile* tile)
 	{
 		eraseTile(tile);
 	}
+	else
+	{
+		updateCellEdges(x, y, x + tile->width - 1, y + tile->height - 1);
+		invalidateTileChunks(x - 1, y - 1, x + tile->width, y + tile->height);
+		if( tile->updateEnabled )
+		{
+			updatedTiles.push_back(tile);
+		}
+	}
 }
 
 void World::setTimeEnabled( bool enabled )
@@ -1253,6 +2134,119 @@ void World::setTimeEnabled( bool enabled )
 	timeFrozen = !enabled;
 }
 
+void World::sortSweepSprite( Sprite* sprite )
+{
+	compactSweepSprites();
+	sweepMaxWidth = std::max(sweepMaxWidth, sprite->occupiedCellsMax.x - sprite->occupiedCellsMin.x);
+
+	// Sprites only move a little between frames, so an insertion sort step is enough
+	int i = sprite->sweepIndex;
+	int left = sprite->occupiedCellsMin.x;
+	while( i > 0 && sweepSprites[i - 1]->occupiedCellsMin.x > left )
+	{
+		sweepSprites[i] = sweepSprites[i - 1];
+		sweepSprites[i]->sweepIndex = i;
+		i--;
+	}
+	while( i + 1 < static_cast<int>(sweepSprites.size()) && sweepSprites[i + 1]->occupiedCellsMin.x < left )
+	{
+		sweepSprites[i] = sweepSprites[i + 1];
+		sweepSprites[i]->sweepIndex = i;
+		i++;
+	}
+	sweepSprites[i] = sprite;
+	sprite->sweepIndex = i;
+}
+
+void World::spawnSprites( double viewX, double viewY, double viewWidth, double viewHeight )
+{
+	renderClampView(viewX, viewY, viewWidth, viewHeight, width, height);
+
+	// Remember the view for scheduling sprite updates
+	activityViewWidth = viewWidth;
+	activityViewX = viewX;
+	activityViewSet = true;
+
+	for( int x = std::floor(viewX - viewWidth / 2.0); x <= std::ceil(viewX + viewWidth / 2.0); ++x )
+	{
+		for( int y = std::floor(viewY - viewHeight / 2.0); y <= std::ceil(viewY + viewHeight / 2.0); ++y )
+		{
+			// If the cell has a sprite to spawn on it, add it to the world
+			Cell* cell = getCell(x, y);
+			if( cell != nullptr && cell->spawn != nullptr )
+			{
+				addSprite(cell->spawn);
+				cell->spawn = nullptr;
+			}
+		}
+	}
+}
+
+void World::testTileCollisionX( Sprite* sprite, const Vector2<double>& oldPosition, const TileCandidate& candidate, bool& stop )
+{
+	Vector2<double>& velocity = sprite->velocity;
+	Vector2<double>& position = sprite->position;
+	Vector2<double>& size = sprite->size;
+	Tile* tile = candidate.tile;
+	if( velocity.x > 0 &&
+		position.x + size.x > tile->x - std::fabs(tile->x) * DOUBLE_EPSILON &&
+		oldPosition.x + size.x <= tile->x + EPSILON * EPSILON )
+	{
+		if( getCellEdgeState(candidate.x, candidate.y, EDGE_LEFT) == true )
+		{
+			position.x = tile->x - size.x;
+			stop = true;
+		}
+		addCollision(tile);
+	}
+	else if( velocity.x < 0 &&
+		position.x - std::fabs(position.x) * DOUBLE_EPSILON < tile->x + tile->width &&
+		oldPosition.x + EPSILON * EPSILON >= tile->x + tile->width )
+	{
+		if( getCellEdgeState(candidate.x, candidate.y, EDGE_RIGHT) == true )
+		{
+			position.x = tile->x + tile->width;
+			stop = true;
+		}
+		addCollision(tile);
+	}
+}
+
+void World::testTileCollisionY( Sprite* sprite, const Vector2<double>& oldPosition, const TileCandidate& candidate, bool slope, double& newY, bool& stop )
+{
+	Vector2<double>& velocity = sprite->velocity;
+	Vector2<double>& position = sprite->position;
+	Vector2<double>& size = sprite->size;
+	Tile* tile = candidate.tile;
+	if( velocity.y > 0 &&
+		position.y + size.y > tile->y - std::fabs(tile->y) * DOUBLE_EPSILON &&
+		oldPosition.y + size.y <= tile->y + std::fabs(tile->y) * DOUBLE_EPSILON )
+	{
+		if( getCellEdgeState(candidate.x, candidate.y, EDGE_BOTTOM) == true )
+		{
+			//position.y = tile->y - size.y;
+			newY = tile->y - size.y;
+			stop = true;
+		}
+		addCollision(tile);
+	}
+	else if( velocity.y < 0 &&
+		position.y - std::fabs(position.y) * DOUBLE_EPSILON < tile->y + tile->height &&
+		oldPosition.y + std::fabs(oldPosition.y) * DOUBLE_EPSILON >= tile->y + tile->height )
+	{
+		if( getCellEdgeState(candidate.x, candidate.y, EDGE_TOP) == true )
+		{
+			// Override - this allows "sinking" into slopes from adjacent tiles
+			if( !slope )
+			{
+				newY = tile->y + tile->height;
+				stop = true;
+			}
+		}
+		addCollision(tile);
+	}
+}
+
 void World::unloadLevel()
 {
 	// Free all entities
@@ -1270,6 +2264,10 @@ void World::unloadLevel()
 	}
 	for( auto sprite : sprites )
 	{
+		if( sprite == nullptr )
+		{
+			continue;
+		}
 		///@todo audit onDestroy() methods for anything that should be done in the destructor instead. not sure why this call was here in the first place.
 		//sprite->onDestroy();
 		delete sprite;
@@ -1280,130 +2278,166 @@ void World::unloadLevel()
 	destroyDeadTiles();
 
 	// Clear sprites
+	deadSprites.clear();
+	removedSprites = 0;
+	removedSweepSprites = 0;
+	renderQueue.clear();
+	roamingSprites.clear();
 	sprites.clear();
+	sweepSprites.clear();
+	sweepMaxWidth = 0;
+	tileChunkColumns = 0;
+	tileChunkLayers.clear();
+	tileChunkRows = 0;
+	tileChunks.clear();
+	for( auto& tileMap : tileMaps )
+	{
+		tileMap.second->resize(0, 0);
+	}
+	updatedTiles.clear();
+	visibleTileChunks.clear();
+	visitedSprites.clear();
+	activityViewSet = false;
 }
 
 void World::update(double dt)
 {
 	delta = dt;
 	frameNumber++;
+	compactSprites();
 	if( time > 0 && !timeFrozen )
 	{
 		time--;
 	}
 
-	// Do movement and collision checking for all sprites
-	std::list<Sprite*> deadSprites;
-	for( auto sprite : sprites )
+	// Sprites are updated in two phases. First, across the thread pool,
+	// independent sprites update and integrate their motion, and the other
+	// sprites gather the tiles around them. Then, in list order, every other
+	// sprite updates its motion, moves and collides, and the updates are
+	// finished. Neither phase depends on the number of threads, so the
+	// results don't either.
+	// Dormant sprites are skipped without being visited.
+	findVisitedSprites();
+	int visitedCount = visitedSprites.size();
+	integrateSpriteMotions(visitedCount);
+
+	// Sprites added during the update are appended and updated in the same
+	// frame, and sprites removed before their turn leave an empty slot.
+	deadSprites.clear();
+	std::size_t addedIndex = sprites.size();
+	for( std::size_t v = 0; ; ++v )
 	{
-		updateSprite(sprite);
-
-		if( sprite->dead )
+		if( v == visitedSprites.size() )
 		{
-			deadSprites.push_back(sprite);
+			if( addedIndex == sprites.size() )
+			{
+				break;
+			}
+			visitedSprites.push_back(addedIndex++);
 		}
-	}
-	for( auto sprite : deadSprites )
-	{
-		sprite->onDestroy();
-		destroySprite(sprite);
-	}
-	destroyDeadTiles();
-}
 
-void World::updateSprite(Sprite* sprite)
-{
-	// Save old kinematic quantities to compare them if the Sprite changes them
-	Vector2<double> oldPosition = sprite->position;
-	bool tileCollisionsEnabled = sprite->tileCollisionsEnabled;
-	bool spriteCollisionsEnabled = sprite->spriteCollisionsEnabled;
-
-	// Motion update
-	if( sprite->motionEnabled )
-	{
-		// Have the sprite update its motion (acceleration, forces, etc.)
-		sprite->onPreUpdate();
-		Vector2<double> acceleration = sprite->acceleration;
-		if( sprite->gravityEnabled )
+		Sprite* sprite = sprites[visitedSprites[v]];
+		if( sprite == nullptr )
 		{
-			acceleration += Vector2<double>(0, Sprite::DEFAULT_GRAVITY);
+			continue;
 		}
 
-		// Update velocity
-		sprite->velocity += (acceleration * delta);
-
-		// Cap velocity
-		if( sprite->maximumSpeed.x != 0 && std::fabs(sprite->velocity.x) > sprite->maximumSpeed.x )
+		const SpriteMotion* motion = ((int)v < visitedCount) ? &spriteMotions[v] : nullptr;
+		if( motion != nullptr && motion->independent )
 		{
-			sprite->velocity.x = sign(sprite->velocity.x) * sprite->maximumSpeed.x;
-		}
-		else if( std::fabs(sprite->velocity.x) > 1.0 / delta )
-		{
-			sprite->velocity.x = sign(sprite->velocity.x) / delta;
+			// Independent sprites have already moved and have no collisions
+			if( motion->step > 0.0 )
+			{
+				if( collideSprite(sprite, sprite->position, false, false, nullptr) )
+				{
+					finishSpriteUpdate(sprite);
+				}
+			}
+			else if( motion->updated )
+			{
+				finishSpriteUpdate(sprite);
+			}
 		}
-		if( sprite->maximumSpeed.y != 0 && std::fabs(sprite->velocity.y) > sprite->maximumSpeed.y )
+		else
 		{
-			sprite->velocity.y = sign(sprite->velocity.y) * sprite->maximumSpeed.y;
+			double step;
+			if( scheduleSprite(sprite, step) )
+			{
+				updateSprite(sprite, step, motion);
+			}
 		}
-		else if( std::fabs(sprite->velocity.y) > 1.0 / delta )
+
+		if( sprite->dead && sprite->worldIndex != -1 )
 		{
-			sprite->velocity.y = sign(sprite->velocity.y) / delta;
+			deadSprites.push_back(sprite);
 		}
-
-		// Update position
-		sprite->position += sprite->velocity * delta;
 	}
-
-	// Now, do collision testing
-	if( !sprite->held && (spriteCollisionsEnabled || tileCollisionsEnabled) )
+	for( auto sprite : deadSprites )
 	{
-		// Do x axis testing
-		bool stopX = doSpriteCollisionXAxisTest(sprite, oldPosition, tileCollisionsEnabled, spriteCollisionsEnabled);
-
-		// Do y axis testing
-		bool stopY = doSpriteCollisionYAxisTest(sprite, oldPosition, tileCollisionsEnabled, spriteCollisionsEnabled);
+		sprite->onDestroy();
+		destroySprite(sprite);
+	}
+	deadSprites.clear();
 
-		// Stop if we need to
-		if( stopX )
-		{
-			sprite->velocity.x = 0;
-		}
-		if( stopY )
+	// Update tiles that are in view
+	if( activityViewSet )
+	{
+		for( std::size_t i = 0; i < updatedTiles.size(); ++i )
 		{
-			sprite->velocity.y = 0;
+			Tile* tile = updatedTiles[i];
+			if( std::fabs(tile->x + tile->width / 2.0 - activityViewX) < (activityViewWidth + tile->width) / 2.0 )
+			{
+				tile->onUpdate();
+			}
 		}
 	}
+	destroyDeadTiles();
+}
 
-	// Check if the sprite is out of bounds
-	if( sprite->deathBoundaryEnabled &&
-		(sprite->position.x < -1 * BOUNDARY_SIZE || sprite->position.x > width + BOUNDARY_SIZE ||
-		sprite->position.y < -1 * BOUNDARY_SIZE || sprite->position.y > height + BOUNDARY_SIZE) )
-	{
-		// Kill it
-		sprite->kill();
-		return;
-	}
-	// Invisible side boundaries for the player
-	else if( dynamic_cast<Player*>(sprite) != nullptr )
+void World::updateCellEdges( int left, int bottom, int right, int top )
+{
+	// Every change to the tiles in the grid comes through here, so tile candidates gathered before it are stale
+	tileVersion++;
+
+	// Edges are shared with neighboring cells, so their masks change too
+	for( int x = std::max(left - 1, 0); x <= std::min(right + 1, width - 1); ++x )
 	{
-		if( sprite->getLeft() < 0 )
-		{
-			sprite->position.x = 0;
-			sprite->velocity.x = 0;
-		}
-		else if( sprite->getRight() > width )
+		for( int y = std::max(bottom - 1, 0); y <= std::min(top + 1, height - 1); ++y )
 		{
-			sprite->position.x = width - sprite->size.x;
-			sprite->velocity.x = 0;
+			Cell* cell = getCell(x, y);
+			cell->edges = 0;
+			for( Edge edge : {EDGE_BOTTOM, EDGE_LEFT, EDGE_RIGHT, EDGE_TOP} )
+			{
+				if( computeCellEdgeState(x, y, edge) )
+				{
+					cell->edges |= (1 << edge);
+				}
+			}
+			if( cell->tile != nullptr && cell->tile->isSlope() )
+			{
+				cell->edges |= CELL_SLOPE;
+			}
 		}
 	}
+}
 
-	// Remove the sprite from the grid
-	eraseSprite(sprite);
+void World::updateSprite( Sprite* sprite, double step, const SpriteMotion* motion )
+{
+	if( moveSprite(sprite, step, motion) )
+	{
+		finishSpriteUpdate(sprite);
+	}
+}
 
-	// Re-add the sprite to the grid
-	insertSprite(sprite);
+void World::visitSweepSprites( int left, int right )
+{
+	compactSweepSprites();
 
-	// Post update (after movement)
-	sprite->onPostUpdate();
+	// No sprite that starts left of this can reach the range, since none are wider than sweepMaxWidth
+	auto it = std::lower_bound(sweepSprites.begin(), sweepSprites.end(), left - sweepMaxWidth,
+		[](const Sprite* sprite, int x){ return sprite->occupiedCellsMin.x < x; });
+	for( ; it != sweepSprites.end() && (*it)->occupiedCellsMin.x <= right; ++it )
+	{
+		visitedSprites.push_back((*it)->worldIndex);
+	}
 }
@@ -2,12 +2,13 @@
 #define WORLD_HPP
 
 #include <limits>
-#include <list>
+#include <map>
 #include <set>
 #include <vector>
 
 #include "Animation.hpp"
 #include "Enums.hpp"
+#include "SpriteBatch.hpp"
 #include "Vector2.hpp"
 
 class Background;
@@ -16,9 +17,21 @@ class Episode;
 class Level;
 class Music;
 class Player;
+class RenderSnapshot;
 class Random;
 class Sprite;
+class ThreadPool;
 class Tile;
+class TileMap;
+
+/**
+ * The method used to find sprites that may collide with a moving sprite.
+ */
+enum SpriteBroadphase
+{
+	BROADPHASE_GRID, /**< Scan the sprites in every cell that the moving sprite covers. */
+	BROADPHASE_SWEEP /**< Scan a list of sprites kept sorted along the x axis. */
+};
 
 /**
  * The status type of the world.
@@ -46,6 +59,8 @@ struct WorldStatus
  */
 class World
 {
+	friend class Sprite;
+
 public:
 	/**
 	 * Create a new World.
@@ -95,6 +110,14 @@ public:
 	 */
 	void freezeTime();
 
+	/**
+	 * Get the number of times that the buffers used by collision testing
+	 * had to allocate memory. This stops increasing once the buffers are
+	 * large enough, so steady-state frames do no heap allocation when
+	 * testing collisions.
+	 */
+	int getCollisionAllocationCount() const;
+
 	/**
 	 * Get the delta (change in time) between each frame.
 	 */
@@ -121,22 +144,35 @@ public:
 	Random& getRandom();
 
 	/**
-	 * Get a set of all sprites located on a certain tile.
+	 * Get the number of sprite pairs that have been tested for intersection
+	 * while testing collisions.
+	 */
+	int getSpritePairTestCount() const;
+
+	/**
+	 * Get all sprites located on a certain tile, in the order they were
+	 * added to it.
 	 *
 	 * @param x the x coordinate.
 	 * @param y the y coordinate.
 	 */
-	const std::set<Sprite*>* getSprites( int x, int y ) const;
+	const std::vector<Sprite*>* getSprites( int x, int y ) const;
 
 	/**
-	 * Get a set of all sprites in a bounding box.
+	 * Get all sprites in a bounding box, in the order they are found.
 	 *
 	 * @param left the left coordinate.
 	 * @param bottom the bottom coordinate.
 	 * @param width the width of the box.
 	 * @param height the height of the box.
 	 */
-	std::set<Sprite*> getSpritesInBox( double left, double bottom, double width, double height );
+	std::vector<Sprite*> getSpritesInBox( double left, double bottom, double width, double height );
+
+	/**
+	 * Get a hash of the current state of the World that affects gameplay.
+	 * Replays compare these to detect when a simulation diverges.
+	 */
+	unsigned int getStateHash() const;
 
 	/**
 	 * Get the status of the world.
@@ -152,14 +188,14 @@ public:
 	const Tile* getTile( int x, int y ) const;
 
 	/**
-	 * Get a set of all tiles in a bounding box.
+	 * Get all tiles in a bounding box, in the order they are found.
 	 *
 	 * @param left the left coordinate.
 	 * @param bottom the bottom coordinate.
 	 * @param width the width of the box.
 	 * @param height the height of the box.
 	 */
-	std::set<Tile*> getTilesInBox( double left, double bottom, double width, double height );
+	std::vector<Tile*> getTilesInBox( double left, double bottom, double width, double height );
 
 	/**
 	 * Get the time that is left to complete the level.
@@ -171,6 +207,14 @@ public:
 	 */
 	int getWidth() const;
 
+	/**
+	 * Check if the calling thread is testing a sprite for collisions. The
+	 * event handlers of the sprites and tiles that collide are not part of
+	 * the testing. This lets an allocation hook count the heap allocations
+	 * that collision testing makes.
+	 */
+	static bool isResolvingCollisions();
+
 	/**
 	 * Check if a point in the world is underwater.
 	 */
@@ -193,8 +237,10 @@ public:
 	 * @param viewY the center y coordinate.
 	 * @param viewWidth the width to display.
 	 * @param viewHeight the height to display.
+	 * @param snapshot a snapshot that the geometry is being recorded into, if
+	 * any, so that each entity is recorded as a motion.
 	 */
-	void render(double viewX, double viewY, double viewWidth, double viewHeight);
+	void render(double viewX, double viewY, double viewWidth, double viewHeight, RenderSnapshot* snapshot = nullptr);
 
 	/**
 	 * Set the Background used during rendering.
@@ -216,6 +262,11 @@ public:
 	 */
 	void setPlayer( Player* player );
 
+	/**
+	 * Set the method used to find sprites that may collide with a moving sprite.
+	 */
+	void setSpriteBroadphase( SpriteBroadphase broadphase );
+
 	/**
 	 * Set a tile at a position in the World.
 	 *
@@ -226,6 +277,19 @@ public:
 	 */
 	void setTile(int x, int y, Tile* tile);
 
+	/**
+	 * Spawn the sprites placed by the Level on cells within a view. This is
+	 * done automatically by render(), so it is only needed when the World is
+	 * updated without being rendered. The view is also used to schedule
+	 * sprite updates by their ActivityPolicy on following frames.
+	 *
+	 * @param viewX the center x coordinate.
+	 * @param viewY the center y coordinate.
+	 * @param viewWidth the width of the view.
+	 * @param viewHeight the height of the view.
+	 */
+	void spawnSprites( double viewX, double viewY, double viewWidth, double viewHeight );
+
 	/**
 	 * Set whether the time should be enabled (not paused).
 	 */
@@ -244,34 +308,135 @@ private:
 
 	struct Cell
 	{
-		std::set<Sprite*> sprites;
+		std::vector<Sprite*> sprites; /**< Sprites on the Cell, in the order they were added. */
 		Tile* tile;
 		Sprite* spawn; /**< The sprite spawned when the Cell is first rendered. */
 		bool underwater; /**< Whether the cell is underwater or not. */
+		unsigned char edges; /**< Solid edges of the cell (bit 1 << Edge) and whether the tile is a slope (CELL_SLOPE). */
 
 		Cell();
 		~Cell();
 	};
 
+	/**
+	 * A tile found in a cell near a sprite before its collisions are tested.
+	 */
+	struct TileCandidate
+	{
+		Tile* tile;
+		int x; /**< The x coordinate of the cell. */
+		int y; /**< The y coordinate of the cell. */
+	};
+
+	/**
+	 * The part of a sprite's update that is done in parallel, for each
+	 * sprite in the list when the update started.
+	 */
+	struct SpriteMotion
+	{
+		bool independent; /**< Whether the sprite is scheduled and moves in parallel with the others. */
+		double step; /**< The time step an independent sprite moved by, or 0 if it didn't move this frame. */
+		std::vector<TileCandidate> tileCandidates; /**< The tiles in the cells around the sprite, by row from the bottom and then by column. */
+		Vector2<int> tileCellsMax; /**< The last cell that tile candidates were gathered from. */
+		Vector2<int> tileCellsMin; /**< The first cell that tile candidates were gathered from. */
+		unsigned int tileVersion; /**< The tile version when the candidates were gathered. */
+		bool updated; /**< Whether an independent sprite's callbacks run this frame, even if it doesn't move. */
+	};
+
+	/**
+	 * Cached geometry for the tiles whose origin is in a square block of
+	 * cells. Only tiles that look the same every frame are cached.
+	 */
+	struct TileChunk
+	{
+		int bottom; /**< The bottom cell covered by the geometry. */
+		bool dirty; /**< Whether the geometry has to be rebuilt before it is drawn. */
+		std::map<int, SpriteBatch::Mesh> layers; /**< Geometry for each layer. */
+		int left; /**< The left cell covered by the geometry. */
+		int right; /**< The right cell covered by the geometry. */
+		int top; /**< The top cell covered by the geometry. */
+
+		TileChunk();
+	};
+
+	double activityViewWidth; /**< The width of the view that sprite activity is measured from. */
+	double activityViewX; /**< The center x coordinate of the view that sprite activity is measured from. */
+	bool activityViewSet; /**< Whether a view has been set since the level was loaded. */
 	const Background* background;
 	const Music* backgroundMusic;
 	std::vector<Cell> cells;
+	int collisionAllocations; /**< The number of times the collision buffers had to allocate memory. */
+	std::vector<Sprite*> collisionSprites; /**< Sprites collided with during the current collision test. */
+	std::vector<Tile*> collisionTiles; /**< Tiles collided with during the current collision test. */
+	std::vector<Sprite*> deadSprites; /**< Sprites that died during the current update. */
 	std::set<Tile*> deadTiles;
 	double delta;
 	int frameNumber;
 	int height;
 	Player* player;
 	Random* random;
-	std::list<Sprite*> sprites;
+	int removedSprites; /**< The number of empty slots left in the sprite list by removed sprites. */
+	int removedSweepSprites; /**< The number of empty slots left in the sweep list by removed sprites. */
+	int renderCount; /**< The number of render passes so far, used to stamp queued entities. */
+	std::map<int, std::vector<Entity*>> renderQueue; /**< Entities to render during the current pass, bucketed by layer in the order they were found. */
+	std::vector<Sprite*> roamingSprites; /**< Sprites that are visited every frame wherever they are, since they always update or despawn when far away. */
+	SpriteBroadphase spriteBroadphase;
+	int spritePairTests; /**< The number of sprite pairs tested for intersection. */
+	std::vector<SpriteMotion> spriteMotions; /**< The motion of each visited sprite during the current update. It never shrinks, so the tile candidate buffers are reused. */
+	std::vector<Sprite*> sprites; /**< All sprites, in the order they were added. Removed sprites leave empty slots until the list is compacted. */
+	std::vector<Sprite*> sweepCandidates; /**< Sprites found by the last sweep query. */
+	int sweepMaxWidth; /**< The widest cell range of any sprite in the sweep list. */
+	std::vector<Sprite*> sweepSprites; /**< All sprites, sorted by the left of their cell range. */
 	WorldStatus status;
 	int time;
+	ThreadPool* threadPool; /**< Runs the parallel part of the update, if more than one thread is used. */
+	int tileChunkColumns;
+	std::set<int> tileChunkLayers; /**< Every layer that has cached tile geometry. */
+	int tileChunkRows;
+	std::vector<TileChunk> tileChunks;
+	std::map< std::pair<int, int>, TileMap* > tileMaps; /**< A tile map for each layer and atlas page with tiles drawn by the tile map shader. */
 	bool timeFrozen;
+	std::vector<Tile*> updatedTiles; /**< Tiles with updates enabled, which are updated while in view. */
+	unsigned int tileVersion; /**< Changed whenever a tile is added to or removed from the grid. */
+	std::vector<TileChunk*> visibleTileChunks; /**< Tile chunks whose geometry is in the view being rendered. */
+	std::vector<int> visitedSprites; /**< The list indices of the sprites visited by the current update, in list order. */
 	int width;
 
+	/**
+	 * Add a sprite to the list of sprites collided with during the current collision test.
+	 */
+	void addCollision( Sprite* sprite );
+
+	/**
+	 * Add a tile to the list of tiles collided with during the current collision test.
+	 */
+	void addCollision( Tile* tile );
+
+	/**
+	 * Remove the empty slots left in the sprite list by removed sprites,
+	 * keeping the remaining sprites in order.
+	 */
+	void compactSprites();
+
+	/**
+	 * Remove the empty slots left in the sweep list by removed sprites.
+	 */
+	void compactSweepSprites();
+
 	void destroyDeadTiles();
 
-	bool doSpriteCollisionXAxisTest( Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled );
-	bool doSpriteCollisionYAxisTest( Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled );
+	/**
+	 * Test a moved sprite for collisions and respond to them, then check if
+	 * it left the world.
+	 *
+	 * @param motion the motion of the sprite with its tile candidates, or
+	 * nullptr to find the tiles in the grid.
+	 * @return false if the sprite was killed for leaving the world.
+	 */
+	bool collideSprite( Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled, const SpriteMotion* motion );
+
+	bool doSpriteCollisionXAxisTest( Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled, const SpriteMotion* motion );
+	bool doSpriteCollisionYAxisTest( Sprite* sprite, const Vector2<double>& oldPosition, bool tileCollisionsEnabled, bool spriteCollisionsEnabled, const SpriteMotion* motion );
 
 	/**
 	 * Remove a sprite from Cell(s) it is in.
@@ -289,10 +454,52 @@ private:
 	Cell* getCell(int x, int y);
 	const Cell* getCell( int x, int y ) const;
 
+	/**
+	 * Compute the edge state of a cell from the tiles on either side of the edge.
+	 */
+	bool computeCellEdgeState( int x, int y, Edge edge ) const;
+
 	/**
 	 * Get the edge state of a cell.
 	 */
-	bool getCellEdgeState(int x, int y, Edge edge);
+	bool getCellEdgeState(int x, int y, Edge edge) const;
+
+	/**
+	 * Find the sprites whose cells overlap a range of cells inside the world,
+	 * using the sweep list. The results are stored in sweepCandidates.
+	 */
+	void findSweepSprites( const Vector2<int>& cellsMin, const Vector2<int>& cellsMax );
+
+	/**
+	 * Rebuild the cached geometry of a tile chunk.
+	 */
+	void buildTileChunk( int chunkX, int chunkY );
+
+	/**
+	 * Find the sprites to visit on the current update: the ones near the
+	 * view, the roaming ones, and the ones near roaming sprites that always
+	 * update. The other sprites are dormant, so nothing would happen to them.
+	 * The results are stored in visitedSprites.
+	 */
+	void findVisitedSprites();
+
+	/**
+	 * Finish updating a sprite after it has moved: move it in the grid and
+	 * call its post update handler.
+	 */
+	void finishSpriteUpdate( Sprite* sprite );
+
+	/**
+	 * Find the tiles in the cells that a sprite may collide with when it
+	 * moves: the cells it covers, and a margin on every side. This only
+	 * reads the grid, so it can run in parallel for many sprites.
+	 */
+	void gatherTileCandidates( const Sprite* sprite, SpriteMotion& motion ) const;
+
+	/**
+	 * Get the range of cells that a sprite covers at its current position.
+	 */
+	void getSpriteCells( const Sprite* sprite, Vector2<int>& cellsMin, Vector2<int>& cellsMax ) const;
 
 	/**
 	 * Handles the response to a collision between two sprites.
@@ -305,34 +512,158 @@ private:
 	void handleCollision( Sprite* sprite, Tile* tile, Edge edge );
 
 	/**
-	 * Insert a sprite into the appropriate Cell(s).
+	 * Add a sprite to the roaming sprites if its ActivityPolicy keeps it
+	 * from going dormant.
+	 */
+	void insertRoamingSprite( Sprite* sprite );
+
+	/**
+	 * Insert a sprite into the appropriate Cell(s). The sprite must not
+	 * be in any Cell already.
 	 */
 	void insertSprite(Sprite* sprite);
 
+	/**
+	 * Mark the tile chunks that overlap a range of cells as needing to be rebuilt.
+	 */
+	void invalidateTileChunks( int left, int bottom, int right, int top );
+
+	/**
+	 * Update the velocity and position of a sprite by a time step, from its
+	 * acceleration and gravity.
+	 */
+	static void integrateSprite( Sprite* sprite, double step );
+
+	/**
+	 * Schedule and move every independent sprite, and gather the tile
+	 * candidates of the others, across the thread pool if there is one.
+	 *
+	 * @param visitedCount the number of visited sprites with a motion.
+	 */
+	void integrateSpriteMotions( int visitedCount );
+
+	/**
+	 * Check if a tile looks the same on every frame, so it can be drawn from
+	 * cached geometry. Tiles that are offset or tinted aren't cached, since
+	 * changing those wouldn't rebuild the geometry.
+	 */
+	bool isTileCacheable( Tile* tile ) const;
+
+	/**
+	 * Check if a tile can be drawn by the tile map shader: it looks the same
+	 * on every frame, or only plays its animation, and every cell shows a
+	 * whole frame. The tile must also be the only one in its cells.
+	 */
+	bool isTileMappable( Tile* tile ) const;
+
 	/**
 	 * Load the contents of a Level into the World.
 	 */
 	void loadLevel( const Level* level );
 
+	/**
+	 * Insert a sprite into the sweep list.
+	 */
+	void insertSweepSprite( Sprite* sprite );
+
+	/**
+	 * Do the motion and collision part of a sprite update. The sprite only
+	 * updates its motion, without moving, if the time step is 0.
+	 *
+	 * @return false if the sprite was killed for leaving the world.
+	 */
+	bool moveSprite( Sprite* sprite, double step, const SpriteMotion* motion );
+
+	/**
+	 * Add an entity to the render queue, unless it is already queued for the
+	 * current render pass.
+	 */
+	void queueEntity( Entity* entity );
+
+	/**
+	 * Remove a sprite from the roaming sprites, if it is one.
+	 */
+	void removeRoamingSprite( Sprite* sprite );
+
+	/**
+	 * Remove a sprite from the sweep list.
+	 */
+	void removeSweepSprite( Sprite* sprite );
+
 	/**
 	 * Render an Entity given the current camera view.
 	 */
-	void renderEntity(Entity* entity, double viewX, double viewY, double viewWidth, double viewHeight);
+	void renderEntity(Entity* entity, double viewX, double viewY, double viewWidth, double viewHeight, RenderSnapshot* snapshot);
 
 	/**
 	 * Render a frame of an animation for an entity.
 	 */
 	void renderFrame( Entity* entity, const Animation* animation, const Animation::Frame* frame, bool tileset );
 
+	/**
+	 * Render the tile map and the cached geometry of every visible tile chunk
+	 * on a layer.
+	 */
+	void renderTileChunks( int layer, double viewX, double viewY, double viewWidth, double viewHeight, RenderSnapshot* snapshot );
+
+	/**
+	 * Render the tileset of a tile, relative to the tile's position.
+	 */
+	void renderTileset( Tile* tile );
+
+	/**
+	 * Decide whether a sprite is updated on the current frame, depending on
+	 * its ActivityPolicy and distance from the view. Sprites that should
+	 * despawn are killed. Sprites updated at a reduced rate still have their
+	 * callbacks run every frame, but only move on some frames, by a longer
+	 * time step.
+	 *
+	 * @param step set to the time step to move the sprite by, or 0 if it doesn't move this frame.
+	 * @return false if the sprite should not be updated at all.
+	 */
+	bool scheduleSprite( Sprite* sprite, double& step );
+
+	/**
+	 * Move a sprite within the sweep list after its cell range changed, to
+	 * keep the list sorted.
+	 */
+	void sortSweepSprite( Sprite* sprite );
+
+	/**
+	 * Test a tile that a sprite may collide with while moving along the x
+	 * axis, stopping the sprite at the tile's edge if it is solid.
+	 */
+	void testTileCollisionX( Sprite* sprite, const Vector2<double>& oldPosition, const TileCandidate& candidate, bool& stop );
+
+	/**
+	 * Test a tile that a sprite may collide with while moving along the y
+	 * axis. The new y coordinate is delayed, since slopes take priority.
+	 */
+	void testTileCollisionY( Sprite* sprite, const Vector2<double>& oldPosition, const TileCandidate& candidate, bool slope, double& newY, bool& stop );
+
 	/**
 	 * Unload the contents of the current Level out of the World.
 	 */
 	void unloadLevel();
 
 	/**
-	 * Update a sprite by one frame.
+	 * Recompute the edge masks of cells in a rectangle of cells, and all cells adjacent to it.
+	 */
+	void updateCellEdges( int left, int bottom, int right, int top );
+
+	/**
+	 * Update a sprite by a time step.
+	 *
+	 * @param motion the motion of the sprite with its tile candidates, or
+	 * nullptr to find the tiles in the grid.
+	 */
+	void updateSprite( Sprite* sprite, double step, const SpriteMotion* motion );
+
+	/**
+	 * Visit the sprites in the sweep list whose cells may be in a range of
+	 * columns, by adding them to visitedSprites.
 	 */
-	void updateSprite( Sprite* sprite );
+	void visitSweepSprites( int left, int right );
 };
 
 #endif // WORLD_HPP